@@ -35,6 +35,7 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
   // We allocate a consecutive memory space for the buffer pool.
   pages_ = new Page[pool_size_];
   replacer_ = new LRUReplacer(pool_size);
+  loading_.resize(pool_size_, false);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -43,77 +44,80 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    stop_prefetching_ = true;
+  }
+  prefetch_cv_.notify_one();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
   delete[] pages_;
   delete replacer_;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   // Make sure you call DiskManager::WritePage!
+  std::lock_guard<std::mutex> guard(latch_);
   auto frame = page_table_.find(page_id);
   if (frame == page_table_.end()) return false;
   frame_id_t frame_id = frame->second;
 
-  pages_[frame_id].WLatch();
   if (pages_[frame_id].IsDirty()) {
     disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
     pages_[frame_id].SetDirty(false);
   }
-  pages_[frame_id].WUnlatch();
 
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   // You can do it!
+  std::lock_guard<std::mutex> guard(latch_);
   for (Page *page = pages_; page < pages_ + pool_size_; page++) {
-    page->WLatch();
-    if (page->IsDirty()) {
+    if (page->GetPageId() != INVALID_PAGE_ID && page->IsDirty()) {
       disk_manager_->WritePage(page->GetPageId(), page->GetData());
       page->SetDirty(false);
     }
-    page->WUnlatch();
   }
 }
 
+auto BufferPoolManagerInstance::FindVictimFrame(frame_id_t *frame_id) -> bool {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) return false;
+
+  Page *victim = &pages_[*frame_id];
+  if (victim->IsDirty()) {
+    disk_manager_->WritePage(victim->GetPageId(), victim->GetData());
+    victim->SetDirty(false);
+  }
+  page_table_.erase(victim->GetPageId());
+  return true;
+}
+
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
+  std::lock_guard<std::mutex> guard(latch_);
 
   frame_id_t id;
-
-  latch_.lock();
-
-  if (free_list_.size() > 0) {
-    id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (replacer_->Victim(&id) == false) {
-      latch_.unlock();
-      return nullptr;
-    }
-    pages_[id].WLatch();
-    if (pages_[id].IsDirty()) {
-      disk_manager_->WritePage(pages_[id].GetPageId(), pages_[id].GetData());
-      pages_[id].SetDirty(false);
-    }
-    pages_[id].WUnlatch();
-    page_table_.erase(pages_[id].GetPageId());
-  }
+  if (!FindVictimFrame(&id)) return nullptr;
 
   *page_id = AllocatePage();
   page_table_[*page_id] = id;
+  replacer_->Pin(id);
 
-  latch_.unlock();
-
-  pages_[id].WLatch();
   pages_[id].SetPageId(*page_id);
   pages_[id].SetPinCount(1);
   pages_[id].SetDirty(true);
   pages_[id].ResetData();
-  pages_[id].WUnlatch();
 
   return &pages_[id];
 }
@@ -126,53 +130,31 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  //
+  // Pin counts and the page table are guarded by latch_ alone. The page's own rwlatch protects its contents and
+  // may be held by the caller (e.g. a table iterator re-fetching the page it is positioned on), so it must never
+  // be taken here. A page the prefetch thread is still reading in is pinned first, and then waited for.
+  std::unique_lock<std::mutex> guard(latch_);
 
   auto frame = page_table_.find(page_id);
-
   if (frame != page_table_.end()) {
     frame_id_t frame_id = frame->second;
-
-    latch_.lock();
     replacer_->Pin(frame_id);
-    latch_.unlock();
-    pages_[frame_id].WLatch();
     pages_[frame_id].SetPinCount(pages_[frame_id].GetPinCount() + 1);
-    pages_[frame_id].WUnlatch();
-
+    loaded_.wait(guard, [&] { return !loading_[frame_id]; });
     return &pages_[frame_id];
   }
 
   frame_id_t id;
+  if (!FindVictimFrame(&id)) return nullptr;
 
-  latch_.lock();
-  if (free_list_.size() > 0) {
-    id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (replacer_->Victim(&id) == false) {
-      latch_.unlock();
-      return nullptr;
-    }
-    pages_[id].WLatch();
-    if (pages_[id].IsDirty()) {
-      disk_manager_->WritePage(pages_[id].GetPageId(), pages_[id].GetData());
-      pages_[id].SetDirty(true);
-    }
-    pages_[id].WUnlatch();
-    page_table_.erase(pages_[id].GetPageId());
-  }
   page_table_[page_id] = id;
-  latch_.unlock();
-
-  char *data = new char[PAGE_SIZE];
-  disk_manager_->ReadPage(page_id, data);
+  replacer_->Pin(id);
 
-  pages_[id].WLatch();
   pages_[id].SetPageId(page_id);
   pages_[id].SetPinCount(1);
   pages_[id].SetDirty(false);
-  pages_[id].SetData(data);
-  pages_[id].WUnlatch();
+  disk_manager_->ReadPage(page_id, pages_[id].GetData());
 
   return &pages_[id];
 }
@@ -183,56 +165,92 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  std::lock_guard<std::mutex> guard(latch_);
 
   auto frame = page_table_.find(page_id);
   if (frame == page_table_.end()) return true;
   frame_id_t frame_id = frame->second;
 
-  pages_[frame_id].WLatch();
-  if (pages_[frame_id].GetPinCount() != 0) {
-    pages_[frame_id].WUnlatch();
-    return false;
-  }
+  if (pages_[frame_id].GetPinCount() != 0) return false;
 
-  latch_.lock();
-  DeallocatePage(pages_[frame_id].GetPageId());
+  DeallocatePage(page_id);
+  replacer_->Pin(frame_id);
   free_list_.push_back(frame_id);
   page_table_.erase(frame);
-  latch_.unlock();
 
   pages_[frame_id].SetPageId(INVALID_PAGE_ID);
   pages_[frame_id].SetPinCount(0);
   pages_[frame_id].SetDirty(false);
   pages_[frame_id].ResetData();
 
-  pages_[frame_id].WUnlatch();
   return true;
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+
   auto frame = page_table_.find(page_id);
   if (frame == page_table_.end()) return false;
   frame_id_t frame_id = frame->second;
 
-  pages_[frame_id].WLatch();
-  if (pages_[frame_id].GetPinCount() <= 0) {
-    pages_[frame_id].WUnlatch();
-    return false;
-  }
+  if (pages_[frame_id].GetPinCount() <= 0) return false;
 
   pages_[frame_id].SetPinCount(pages_[frame_id].GetPinCount() - 1);
   if (is_dirty) pages_[frame_id].SetDirty(true);
 
-  if (pages_[frame_id].GetPinCount() == 0) {
-    latch_.lock();
-    replacer_->Unpin(frame_id);
-    latch_.unlock();
-  }
-  pages_[frame_id].WUnlatch();
+  if (pages_[frame_id].GetPinCount() == 0) replacer_->Unpin(frame_id);
 
   return true;
 }
 
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id) {
+  std::scoped_lock lock(prefetch_latch_);
+  if (prefetch_queue_.size() >= pool_size_) return;
+  if (!prefetch_thread_.joinable()) {
+    prefetch_thread_ = std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+  }
+  prefetch_queue_.push_back(page_id);
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return stop_prefetching_ || !prefetch_queue_.empty(); });
+    if (stop_prefetching_) return;
+    page_id_t page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    lock.unlock();
+    ReadInPage(page_id);
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::ReadInPage(page_id_t page_id) {
+  frame_id_t id;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (page_table_.count(page_id) > 0 || !FindVictimFrame(&id)) return;
+
+    page_table_[page_id] = id;
+    replacer_->Pin(id);
+    pages_[id].SetPageId(page_id);
+    pages_[id].SetPinCount(1);
+    pages_[id].SetDirty(false);
+    loading_[id] = true;
+  }
+
+  disk_manager_->ReadPage(page_id, pages_[id].GetData());
+
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    loading_[id] = false;
+    pages_[id].SetPinCount(pages_[id].GetPinCount() - 1);
+    if (pages_[id].GetPinCount() == 0) replacer_->Unpin(id);
+  }
+  loaded_.notify_all();
+}
+
 auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
   const page_id_t next_page_id = next_page_id_;
   next_page_id_ += num_instances_;
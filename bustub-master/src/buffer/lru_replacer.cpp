@@ -11,7 +11,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_replacer.h"
-#include <algorithm>
 
 namespace bustub {
 
@@ -23,22 +22,20 @@ auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool {
   if (frames.empty()) return false;
   *frame_id = frames.front();
   frames.pop_front();
+  positions_.erase(*frame_id);
   return true;
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  for (auto i = frames.begin(); i != frames.end(); i++) {
-    if ((frame_id_t)*i == frame_id) {
-      frames.erase(i);
-      return;
-    }
-  }
+  auto i = positions_.find(frame_id);
+  if (i == positions_.end()) return;
+  frames.erase(i->second);
+  positions_.erase(i);
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-  auto i = std::find(frames.begin(), frames.end(), frame_id);
-  if (i != frames.end()) return;
-  frames.push_back(frame_id);
+  if (positions_.count(frame_id) != 0) return;
+  positions_[frame_id] = frames.insert(frames.end(), frame_id);
 }
 
 auto LRUReplacer::Size() -> size_t { return frames.size(); }
@@ -28,7 +28,11 @@ ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_
 }
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
-ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : bpInstances) {
+    delete instance;
+  }
+}
 
 auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
   // Get size of all BufferPoolManagerInstances
@@ -93,4 +97,10 @@ void ParallelBufferPoolManager::FlushAllPgsImp() {
   }
 }
 
+void ParallelBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  // Prefetch page_id into the responsible BufferPoolManagerInstance
+  BufferPoolManager *instance = GetBufferPoolManager(page_id);
+  instance->PrefetchPage(page_id);
+}
+
 }  // namespace bustub
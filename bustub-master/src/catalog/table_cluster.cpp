@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_cluster.cpp
+//
+// Identification: src/catalog/table_cluster.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_cluster.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "catalog/catalog.h"
+
+namespace bustub {
+
+namespace {
+
+/** A row of the old heap tagged with its index key values. */
+struct SortEntry {
+  std::vector<Value> key_;
+  RID rid_;
+};
+
+/** Order keys column by column; NULLs sort first. */
+auto KeyLess(const SortEntry &lhs, const SortEntry &rhs) -> bool {
+  for (size_t i = 0; i < lhs.key_.size(); i++) {
+    const Value &l = lhs.key_[i];
+    const Value &r = rhs.key_[i];
+    if (l.IsNull() || r.IsNull()) {
+      if (l.IsNull() != r.IsNull()) {
+        return l.IsNull();
+      }
+      continue;
+    }
+    if (l.CompareLessThan(r) == CmpBool::CmpTrue) {
+      return true;
+    }
+    if (r.CompareLessThan(l) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+TableClusterer::TableClusterer(TableInfo *table_info, IndexInfo *cluster_index, std::vector<IndexInfo *> indexes,
+                               Transaction *txn)
+    : table_info_(table_info),
+      cluster_index_(cluster_index),
+      indexes_(std::move(indexes)),
+      txn_(txn),
+      old_heap_(table_info->table_.get()) {
+  auto *heap = table_info->table_.get();
+  new_heap_ = std::make_unique<TableHeap>(heap->GetBufferPoolManager(), heap->GetLockManager(),
+                                          heap->GetLogManager(), txn);
+}
+
+TableClusterer::~TableClusterer() {
+  if (!finished_) {
+    old_heap_->StopChangeCapture();
+  }
+}
+
+void TableClusterer::CopyInOrder() {
+  // Capture first: a write that the scan below misses is then replayed by CatchUp().
+  old_heap_->StartChangeCapture();
+
+  const auto &schema = table_info_->schema_;
+  const auto &key_attrs = cluster_index_->index_->GetKeyAttrs();
+  std::vector<SortEntry> entries;
+  for (auto tuple = old_heap_->Begin(txn_); tuple != old_heap_->End(); ++tuple) {
+    SortEntry entry;
+    entry.key_.reserve(key_attrs.size());
+    for (auto attr : key_attrs) {
+      entry.key_.push_back(tuple->GetValue(&schema, attr));
+    }
+    entry.rid_ = tuple->GetRid();
+    entries.push_back(std::move(entry));
+  }
+  // Only the keys and RIDs are held in memory; the tuples are read again in key order below.
+  std::stable_sort(entries.begin(), entries.end(), KeyLess);
+
+  Tuple tuple;
+  for (const auto &entry : entries) {
+    // A row deleted since the scan has a captured change and is dealt with by the catch-up.
+    if (!old_heap_->GetTuple(entry.rid_, &tuple, txn_)) {
+      continue;
+    }
+    RID new_rid;
+    [[maybe_unused]] bool inserted = new_heap_->InsertTuple(tuple, &new_rid, txn_);
+    BUSTUB_ASSERT(inserted, "Couldn't copy a tuple into the clustered heap.");
+    moved_[entry.rid_] = new_rid;
+  }
+}
+
+auto TableClusterer::CatchUp() -> size_t {
+  auto changes = old_heap_->DrainCapturedChanges();
+  for (const auto &rid : changes) {
+    ApplyChange(rid);
+  }
+  return changes.size();
+}
+
+void TableClusterer::ApplyChange(const RID &old_rid) {
+  Tuple tuple;
+  bool exists = old_heap_->GetTuple(old_rid, &tuple, txn_);
+  auto moved = moved_.find(old_rid);
+  if (moved == moved_.end()) {
+    if (exists) {
+      RID new_rid;
+      [[maybe_unused]] bool inserted = new_heap_->InsertTuple(tuple, &new_rid, txn_);
+      BUSTUB_ASSERT(inserted, "Couldn't copy a tuple into the clustered heap.");
+      moved_[old_rid] = new_rid;
+    }
+    return;
+  }
+  if (!exists) {
+    new_heap_->MarkDelete(moved->second, txn_);
+    moved_.erase(moved);
+    return;
+  }
+  // The row may have changed in place or been replaced by another row that reused the slot; copy it either way.
+  if (!new_heap_->UpdateTuple(tuple, moved->second, txn_)) {
+    new_heap_->MarkDelete(moved->second, txn_);
+    [[maybe_unused]] bool inserted = new_heap_->InsertTuple(tuple, &moved->second, txn_);
+    BUSTUB_ASSERT(inserted, "Couldn't copy a tuple into the clustered heap.");
+  }
+}
+
+auto TableClusterer::Finish() -> std::unique_ptr<TableHeap> {
+  old_heap_->BlockWriters();
+  CatchUp();
+  old_heap_->StopChangeCapture();
+
+  // Index entries were maintained against the old RIDs all along; the keys are unchanged, only the RIDs move.
+  std::unordered_map<RID, RID> origin;
+  origin.reserve(moved_.size());
+  for (const auto &[old_rid, new_rid] : moved_) {
+    origin.emplace(new_rid, old_rid);
+  }
+  const auto &schema = table_info_->schema_;
+  table_info_->heap_latch_.WLock();
+  for (auto tuple = new_heap_->Begin(txn_); tuple != new_heap_->End(); ++tuple) {
+    auto old_rid = origin.find(tuple->GetRid());
+    BUSTUB_ASSERT(old_rid != origin.end(), "Every row of the clustered heap comes from the old heap.");
+    for (auto *index_info : indexes_) {
+      auto *index = index_info->index_.get();
+      auto key = tuple->KeyFromTuple(schema, index_info->key_schema_, index->GetKeyAttrs());
+      index->DeleteEntry(key, old_rid->second, txn_);
+      index->InsertEntry(key, tuple->GetRid(), txn_);
+    }
+  }
+
+  table_info_->table_.swap(new_heap_);
+  table_info_->heap_latch_.WUnlock();
+  old_heap_->Retire();
+  old_heap_->UnblockWriters();
+  finished_ = true;
+  return std::move(new_heap_);
+}
+
+auto TableClusterer::Run(const ClusterOptions &options) -> std::unique_ptr<TableHeap> {
+  CopyInOrder();
+  for (uint32_t round = 0; round < options.max_catch_up_rounds_; round++) {
+    if (CatchUp() <= options.final_catch_up_threshold_) {
+      break;
+    }
+  }
+  return Finish();
+}
+
+}  // namespace bustub
@@ -0,0 +1,311 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_stats.cpp
+//
+// Identification: src/catalog/table_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_stats.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "common/util/hash_util.h"
+#include "common/util/hyperloglog.h"
+
+namespace bustub {
+
+namespace {
+
+/** Per-column summary of one page range, merged after all workers finish. */
+struct PartialColumnStats {
+  uint64_t null_count_{0};
+  uint64_t value_count_{0};
+  HyperLogLog sketch_{};
+  /** Reservoir sample of the non-NULL values. */
+  std::vector<Value> sample_;
+};
+
+/** Summary of one page range. */
+struct PartialStats {
+  uint64_t row_count_{0};
+  std::vector<PartialColumnStats> columns_;
+};
+
+auto IsNumeric(TypeId type) -> bool {
+  switch (type) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+auto ToDouble(const Value &value) -> double {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return static_cast<double>(value.GetAs<int64_t>());
+    case TypeId::DECIMAL:
+      return value.GetAs<double>();
+    case TypeId::TIMESTAMP:
+      return static_cast<double>(value.GetAs<uint64_t>());
+    default:
+      UNREACHABLE("Not a numeric type.");
+  }
+}
+
+/**
+ * @return a hash of value for the distinct-count sketch. Integers are passed through unchanged since the sketch
+ * re-mixes them bijectively; HashUtil::HashValue folds nearby integers onto the same hash and would undercount.
+ */
+auto SketchHash(const Value &value) -> uint64_t {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return static_cast<uint64_t>(value.GetAs<int8_t>());
+    case TypeId::SMALLINT:
+      return static_cast<uint64_t>(value.GetAs<int16_t>());
+    case TypeId::INTEGER:
+      return static_cast<uint64_t>(value.GetAs<int32_t>());
+    case TypeId::BIGINT:
+      return static_cast<uint64_t>(value.GetAs<int64_t>());
+    case TypeId::TIMESTAMP:
+      return value.GetAs<uint64_t>();
+    default:
+      return HashUtil::HashValue(&value);
+  }
+}
+
+auto LessThan(const Value &lhs, const Value &rhs) -> bool { return lhs.CompareLessThan(rhs) == CmpBool::CmpTrue; }
+
+/**
+ * Summarize the tuples stored in pages [begin, end).
+ */
+void AnalyzePageRange(TableHeap *heap, const Schema &schema, const std::vector<page_id_t> &page_ids, size_t begin,
+                      size_t end, uint32_t reservoir_size, Transaction *txn, PartialStats *out) {
+  auto *bpm = heap->GetBufferPoolManager();
+  std::mt19937_64 rng(begin);
+  const uint32_t column_count = schema.GetColumnCount();
+  out->columns_.resize(column_count);
+
+  Tuple tuple;
+  for (size_t i = begin; i < end; i++) {
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_ids[i]));
+    if (page == nullptr) {
+      continue;
+    }
+    page->RLatch();
+    RID rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      if (!page->GetTuple(rid, &tuple, txn, heap->GetLockManager())) {
+        continue;
+      }
+      out->row_count_++;
+      for (uint32_t col = 0; col < column_count; col++) {
+        auto &stats = out->columns_[col];
+        Value value = tuple.GetValue(&schema, col);
+        if (value.IsNull()) {
+          stats.null_count_++;
+          continue;
+        }
+        stats.value_count_++;
+        stats.sketch_.AddHash(SketchHash(value));
+        if (stats.sample_.size() < reservoir_size) {
+          stats.sample_.push_back(value.Copy());
+        } else {
+          auto slot = std::uniform_int_distribution<uint64_t>(0, stats.value_count_ - 1)(rng);
+          if (slot < reservoir_size) {
+            stats.sample_[slot] = value.Copy();
+          }
+        }
+      }
+    }
+    page->RUnlatch();
+    bpm->UnpinPage(page_ids[i], false);
+  }
+}
+
+/** @return the bucket boundaries of an equi-depth histogram over values, which are sorted in place */
+auto BuildHistogram(std::vector<Value> *values, uint32_t buckets) -> std::vector<Value> {
+  std::vector<Value> bounds;
+  if (values->empty() || buckets == 0) {
+    return bounds;
+  }
+  std::sort(values->begin(), values->end(), LessThan);
+  const size_t n = values->size();
+  buckets = static_cast<uint32_t>(std::min<size_t>(buckets, n));
+  bounds.reserve(buckets + 1);
+  for (uint32_t i = 0; i <= buckets; i++) {
+    size_t pos = std::min(n - 1, i * (n - 1) / buckets);
+    bounds.push_back((*values)[pos]);
+  }
+  return bounds;
+}
+
+}  // namespace
+
+auto ColumnStats::EstimateEqualSelectivity(const Value &value) const -> double {
+  if (value.IsNull()) {
+    return null_fraction_;
+  }
+  if (distinct_count_ == 0 || histogram_bounds_.empty() || LessThan(value, histogram_bounds_.front()) ||
+      LessThan(histogram_bounds_.back(), value)) {
+    return 0;
+  }
+  return (1.0 - null_fraction_) / static_cast<double>(distinct_count_);
+}
+
+auto ColumnStats::EstimateLessThanSelectivity(const Value &value) const -> double {
+  if (value.IsNull() || histogram_bounds_.empty() || !LessThan(histogram_bounds_.front(), value)) {
+    return 0;
+  }
+  const double non_null = 1.0 - null_fraction_;
+  if (!LessThan(value, histogram_bounds_.back())) {
+    return non_null;
+  }
+  // Locate the bucket [bounds[b], bounds[b + 1]) holding value; every bucket holds 1 / buckets of the rows.
+  auto upper = std::upper_bound(histogram_bounds_.begin(), histogram_bounds_.end(), value, LessThan);
+  auto b = static_cast<size_t>(upper - histogram_bounds_.begin()) - 1;
+  const auto buckets = static_cast<double>(histogram_bounds_.size() - 1);
+  double within = 0.5;
+  if (IsNumeric(type_)) {
+    double lo = ToDouble(histogram_bounds_[b]);
+    double hi = ToDouble(histogram_bounds_[b + 1]);
+    within = hi > lo ? (ToDouble(value) - lo) / (hi - lo) : 0;
+  }
+  return non_null * (static_cast<double>(b) + within) / buckets;
+}
+
+auto TableStats::Analyze(TableHeap *heap, const Schema &schema, const AnalyzeOptions &options, Transaction *txn)
+    -> std::unique_ptr<TableStats> {
+  // Read the counters first: rows inserted while we scan are then counted at most twice in the estimate, never lost.
+  auto stats = std::unique_ptr<TableStats>(new TableStats());
+  stats->insert_count_ = heap->GetInsertCount();
+  stats->delete_count_ = heap->GetDeleteCount();
+
+  // Pick the pages to read: all of them, or an evenly spaced subset.
+  auto page_ids = heap->GetPageIds();
+  stats->page_count_ = page_ids.size();
+  if (options.sample_pages_ != 0 && options.sample_pages_ < page_ids.size()) {
+    std::vector<page_id_t> sampled;
+    sampled.reserve(options.sample_pages_);
+    for (uint32_t i = 0; i < options.sample_pages_; i++) {
+      sampled.push_back(page_ids[i * page_ids.size() / options.sample_pages_]);
+    }
+    page_ids = std::move(sampled);
+  }
+  stats->sampled_page_count_ = page_ids.size();
+
+  // Hand each worker a contiguous range of the chosen pages and a transaction of its own: a Transaction's lock sets
+  // are not thread-safe. Every reservoir is full size so that the merge below can weight them by row count.
+  size_t num_workers = options.num_workers_ != 0 ? options.num_workers_ : std::thread::hardware_concurrency();
+  num_workers = std::max<size_t>(1, std::min(num_workers, page_ids.size()));
+  std::vector<PartialStats> partials(num_workers);
+  std::vector<std::unique_ptr<Transaction>> worker_txns;
+  for (size_t w = 0; txn != nullptr && w < num_workers; w++) {
+    worker_txns.push_back(std::make_unique<Transaction>(txn->GetTransactionId(), txn->GetIsolationLevel()));
+  }
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t w = 0; w < num_workers; w++) {
+    size_t begin = w * page_ids.size() / num_workers;
+    size_t end = (w + 1) * page_ids.size() / num_workers;
+    workers.emplace_back(AnalyzePageRange, heap, std::cref(schema), std::cref(page_ids), begin, end,
+                         options.histogram_sample_size_, txn != nullptr ? worker_txns[w].get() : nullptr,
+                         &partials[w]);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  for (auto &worker_txn : worker_txns) {
+    txn->GetSharedLockSet()->insert(worker_txn->GetSharedLockSet()->begin(), worker_txn->GetSharedLockSet()->end());
+    if (worker_txn->GetState() == TransactionState::ABORTED) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+  }
+
+  // Merge the partial summaries.
+  uint64_t sampled_rows = 0;
+  for (const auto &partial : partials) {
+    sampled_rows += partial.row_count_;
+  }
+  const double scale = page_ids.empty() ? 0 : static_cast<double>(stats->page_count_) / page_ids.size();
+  stats->row_count_ = static_cast<uint64_t>(sampled_rows * scale);
+
+  const uint32_t column_count = schema.GetColumnCount();
+  stats->column_stats_.reserve(column_count);
+  for (uint32_t col = 0; col < column_count; col++) {
+    uint64_t null_count = 0;
+    uint64_t value_count = 0;
+    HyperLogLog sketch;
+    for (auto &partial : partials) {
+      if (partial.columns_.empty()) {
+        continue;
+      }
+      auto &column = partial.columns_[col];
+      null_count += column.null_count_;
+      value_count += column.value_count_;
+      sketch.Merge(column.sketch_);
+    }
+    // Each reservoir is a uniform sample of the values its worker saw, so a random subset of it sized in proportion
+    // to that worker's share of the values keeps the merged sample uniform over the whole table.
+    std::vector<Value> sample;
+    for (size_t w = 0; w < num_workers && value_count != 0; w++) {
+      if (partials[w].columns_.empty()) {
+        continue;
+      }
+      auto &column = partials[w].columns_[col];
+      auto take = std::min<size_t>(column.sample_.size(),
+                                   options.histogram_sample_size_ * column.value_count_ / value_count);
+      std::mt19937_64 rng(w);
+      std::shuffle(column.sample_.begin(), column.sample_.end(), rng);
+      std::move(column.sample_.begin(), column.sample_.begin() + take, std::back_inserter(sample));
+    }
+
+    double null_fraction = sampled_rows == 0 ? 0 : static_cast<double>(null_count) / sampled_rows;
+    auto distinct_count = std::min(sketch.Estimate(), value_count);
+    // A sample only sees a fraction of the distinct values. If nearly every sampled value was distinct, assume the
+    // column is unique-ish and scale with the table; otherwise the sample most likely saw every value already.
+    if (scale > 1 && distinct_count * 10 >= value_count * 9) {
+      distinct_count = static_cast<uint64_t>(distinct_count * scale);
+    }
+    stats->column_stats_.emplace_back(schema.GetColumn(col).GetType(), null_fraction, distinct_count,
+                                      BuildHistogram(&sample, options.histogram_buckets_));
+  }
+  return stats;
+}
+
+auto TableStats::GetEstimatedRowCount(const TableHeap *heap) const -> uint64_t {
+  // Deletes may be rolled back after the snapshot, so the delta can be negative.
+  auto inserted = static_cast<int64_t>(heap->GetInsertCount() - insert_count_);
+  auto deleted = static_cast<int64_t>(heap->GetDeleteCount() - delete_count_);
+  auto estimate = static_cast<int64_t>(row_count_) + inserted - deleted;
+  return estimate > 0 ? static_cast<uint64_t>(estimate) : 0;
+}
+
+auto TableStats::IsStale(const TableHeap *heap, double threshold) const -> bool {
+  auto inserted = static_cast<int64_t>(heap->GetInsertCount() - insert_count_);
+  auto deleted = static_cast<int64_t>(heap->GetDeleteCount() - delete_count_);
+  auto modified = inserted + std::max<int64_t>(deleted, 0);
+  return static_cast<double>(modified) > threshold * static_cast<double>(std::max<uint64_t>(row_count_, 1));
+}
+
+}  // namespace bustub
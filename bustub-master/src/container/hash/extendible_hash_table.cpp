@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -26,7 +30,31 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                      const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // start with a single bucket of local depth 0 behind a directory of global depth 0
+  Page *page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate the hash table directory page.");
+  }
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  NewBucketPage(&bucket_page_id);
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  dir_page->UpdateBucketCount(0, 1);
+  directory_cache_[0] = std::make_unique<std::atomic<page_id_t>[]>(DIRECTORY_ARRAY_SIZE);
+  CachedBucket(0).store(bucket_page_id, std::memory_order_relaxed);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  // the directory page keeps this pin for as long as the table is used
+  page->SetDirty(true);
+  directory_page_ = page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_TYPE::~ExtendibleHashTable() {
+  if (directory_page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  }
 }
 
 /*****************************************************************************
@@ -46,43 +74,535 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+inline auto HASH_TABLE_TYPE::HashToDirectoryIndex(uint64_t hash, HashTableDirectoryPage *dir_page) -> uint32_t {
+  return static_cast<uint32_t>(hash) & dir_page->GetGlobalDepthMask();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+inline auto HASH_TABLE_TYPE::HashToTag(uint64_t hash) -> uint8_t {
+  return static_cast<uint8_t>(hash >> 56);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return LookupBucket(dir_page, KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch the hash table directory page.");
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+/*
+ * The head resolves what is left of the global depth above the levels below it, between 1 and DIRECTORY_LEVEL_DEPTH
+ * bits.
+ */
+static_assert((1U << DIRECTORY_LEVEL_DEPTH) == DIRECTORY_ARRAY_SIZE);
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+inline auto HASH_TABLE_TYPE::DirectoryLevels(HashTableDirectoryPage *dir_page) -> uint32_t {
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  return global_depth <= DIRECTORY_LEVEL_DEPTH ? 0 : (global_depth - 1) / DIRECTORY_LEVEL_DEPTH;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchDirectoryTreePage(page_id_t page_id) -> HashTableDirectoryPage * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a hash table directory page.");
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::NewDirectoryTreePage(page_id_t *page_id) -> HashTableDirectoryPage * {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a hash table directory page.");
+  }
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  dir_page->SetPageId(*page_id);
+  return dir_page;
+}
+
+/*
+ * The head picks the page one level down by the top bits of the index, every inner page by the next
+ * DIRECTORY_LEVEL_DEPTH bits, and the leaf holds the entry at the lowest DIRECTORY_LEVEL_DEPTH bits. No page latches
+ * are taken: the directory only changes under the table latch held exclusively.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchDirectoryLeaf(HashTableDirectoryPage *dir_page, uint32_t directory_idx)
+    -> HashTableDirectoryPage * {
+  uint32_t levels = DirectoryLevels(dir_page);
+  if (levels == 0) {
+    return dir_page;
+  }
+  page_id_t page_id = dir_page->GetBucketPageId(directory_idx >> (levels * DIRECTORY_LEVEL_DEPTH));
+  for (uint32_t level = levels - 1; level > 0; level--) {
+    HashTableDirectoryPage *inner_page = FetchDirectoryTreePage(page_id);
+    page_id_t child_page_id =
+        inner_page->GetBucketPageId((directory_idx >> (level * DIRECTORY_LEVEL_DEPTH)) & (DIRECTORY_ARRAY_SIZE - 1));
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child_page_id;
+  }
+  return FetchDirectoryTreePage(page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ReleaseDirectoryLeaf(HashTableDirectoryPage *dir_page, HashTableDirectoryPage *leaf_page,
+                                           bool is_dirty) {
+  if (leaf_page != dir_page) {
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), is_dirty);
+  } else if (is_dirty) {
+    directory_page_->SetDirty(true);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::LookupBucket(HashTableDirectoryPage *dir_page, uint32_t directory_idx, uint32_t *local_depth)
+    -> page_id_t {
+  HashTableDirectoryPage *leaf_page = FetchDirectoryLeaf(dir_page, directory_idx);
+  uint32_t slot = directory_idx & (DIRECTORY_ARRAY_SIZE - 1);
+  page_id_t bucket_page_id = leaf_page->GetBucketPageId(slot);
+  if (local_depth != nullptr) {
+    *local_depth = leaf_page->GetLocalDepth(slot);
+  }
+  ReleaseDirectoryLeaf(dir_page, leaf_page, false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::LookupCachedBucket(HashTableDirectoryPage *dir_page, uint32_t directory_idx) -> page_id_t {
+  if (dir_page->GetGlobalDepth() > DIRECTORY_CACHE_DEPTH) {
+    return LookupBucket(dir_page, directory_idx);
+  }
+  return CachedBucket(directory_idx).load(std::memory_order_relaxed);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CacheBucket(uint64_t directory_idx, page_id_t bucket_page_id) {
+  if (cached_depth_.load(std::memory_order_relaxed) <= DIRECTORY_CACHE_DEPTH) {
+    CachedBucket(static_cast<uint32_t>(directory_idx)).store(bucket_page_id, std::memory_order_relaxed);
+  }
+}
+
+/*
+ * Chunks are never freed while the table lives, so that a lookup that read a stale depth still reads allocated
+ * memory; the release store of the depth publishes the chunks below it.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ResizeDirectoryCache(HashTableDirectoryPage *dir_page, uint32_t old_depth) {
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  if (global_depth <= DIRECTORY_CACHE_DEPTH) {
+    uint64_t size = uint64_t{1} << global_depth;
+    for (size_t chunk = 0; chunk * DIRECTORY_ARRAY_SIZE < size; chunk++) {
+      if (directory_cache_[chunk] == nullptr) {
+        directory_cache_[chunk] = std::make_unique<std::atomic<page_id_t>[]>(DIRECTORY_ARRAY_SIZE);
+      }
+    }
+    if (old_depth > DIRECTORY_CACHE_DEPTH) {
+      ForEachEntry(dir_page, 0, 0, false, [&](HashTableDirectoryPage *leaf_page, uint32_t slot, uint64_t idx) {
+        CachedBucket(static_cast<uint32_t>(idx)).store(leaf_page->GetBucketPageId(slot), std::memory_order_relaxed);
+      });
+    } else {
+      for (uint32_t idx = 1U << old_depth; idx < size; idx++) {
+        CachedBucket(idx).store(CachedBucket(idx - (1U << old_depth)).load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+      }
+    }
+  }
+  cached_depth_.store(global_depth, std::memory_order_release);
+}
+
+/*
+ * The release fence keeps the stores of the split or merge from becoming visible before the odd version: a lookup
+ * that sees any of them sees the odd version too when it validates.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::BeginDirectoryChange() {
+  directory_version_.store(directory_version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::EndDirectoryChange() {
+  directory_version_.store(directory_version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ForEachEntry(HashTableDirectoryPage *dir_page, uint32_t base, uint32_t local_depth,
+                                   bool is_dirty,
+                                   const std::function<void(HashTableDirectoryPage *, uint32_t, uint64_t)> &fn) {
+  uint64_t size = uint64_t{1} << dir_page->GetGlobalDepth();
+  uint64_t stride = uint64_t{1} << local_depth;
+  for (uint64_t idx = base; idx < size;) {
+    HashTableDirectoryPage *leaf_page = FetchDirectoryLeaf(dir_page, idx);
+    uint64_t leaf_end = std::min(size, (idx | (DIRECTORY_ARRAY_SIZE - 1)) + 1);
+    for (; idx < leaf_end; idx += stride) {
+      fn(leaf_page, idx & (DIRECTORY_ARRAY_SIZE - 1), idx);
+    }
+    ReleaseDirectoryLeaf(dir_page, leaf_page, is_dirty);
+  }
+}
+
+/*
+ * A full head moves its entries down into a new page first, which becomes the head's only entry; the head then gets
+ * a copy of each of its subtrees, so that the two halves can split apart.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::GrowDirectory(HashTableDirectoryPage *dir_page) {
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  if (global_depth < DIRECTORY_LEVEL_DEPTH) {
+    dir_page->IncrGlobalDepth();
+    ResizeDirectoryCache(dir_page, global_depth);
+    return;
+  }
+  uint32_t levels = DirectoryLevels(dir_page);
+  uint32_t head_depth = global_depth - levels * DIRECTORY_LEVEL_DEPTH;
+  if (head_depth == DIRECTORY_LEVEL_DEPTH) {
+    page_id_t child_page_id;
+    NewDirectoryTreePage(&child_page_id)->CopyEntriesFrom(dir_page);
+    buffer_pool_manager_->UnpinPage(child_page_id, true);
+    dir_page->SetBucketPageId(0, child_page_id);
+    levels++;
+    head_depth = 0;
+  }
+  for (uint32_t slot = 0; slot < (1U << head_depth); slot++) {
+    dir_page->SetBucketPageId(slot + (1U << head_depth), CopyDirectoryTree(dir_page->GetBucketPageId(slot), levels));
+  }
+  dir_page->SetGlobalDepth(global_depth + 1);
+  ResizeDirectoryCache(dir_page, global_depth);
+}
+
+/*
+ * Once the head is down to a single subtree, the root of that subtree takes the place of the head's entries.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ShrinkDirectory(HashTableDirectoryPage *dir_page) {
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  uint32_t levels = DirectoryLevels(dir_page);
+  if (levels == 0) {
+    dir_page->DecrGlobalDepth();
+    ResizeDirectoryCache(dir_page, global_depth);
+    return;
+  }
+  uint32_t head_depth = global_depth - levels * DIRECTORY_LEVEL_DEPTH;
+  for (uint32_t slot = 1U << (head_depth - 1); slot < (1U << head_depth); slot++) {
+    DeleteDirectoryTree(dir_page->GetBucketPageId(slot), levels);
+  }
+  if (head_depth == 1) {
+    page_id_t child_page_id = dir_page->GetBucketPageId(0);
+    dir_page->CopyEntriesFrom(FetchDirectoryTreePage(child_page_id));
+    buffer_pool_manager_->UnpinPage(child_page_id, false);
+    if (!buffer_pool_manager_->DeletePage(child_page_id)) {
+      dropped_pages_.push_back(child_page_id);
+    }
+  }
+  dir_page->SetGlobalDepth(global_depth - 1);
+  ResizeDirectoryCache(dir_page, global_depth);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::CopyDirectoryTree(page_id_t page_id, uint32_t levels) -> page_id_t {
+  page_id_t copy_page_id;
+  HashTableDirectoryPage *copy_page = NewDirectoryTreePage(&copy_page_id);
+  copy_page->CopyEntriesFrom(FetchDirectoryTreePage(page_id));
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  if (levels > 1) {
+    for (uint32_t slot = 0; slot < DIRECTORY_ARRAY_SIZE; slot++) {
+      copy_page->SetBucketPageId(slot, CopyDirectoryTree(copy_page->GetBucketPageId(slot), levels - 1));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(copy_page_id, true);
+  return copy_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteDirectoryTree(page_id_t page_id, uint32_t levels) {
+  if (levels > 1) {
+    HashTableDirectoryPage *inner_page = FetchDirectoryTreePage(page_id);
+    std::vector<page_id_t> child_page_ids(DIRECTORY_ARRAY_SIZE);
+    for (uint32_t slot = 0; slot < DIRECTORY_ARRAY_SIZE; slot++) {
+      child_page_ids[slot] = inner_page->GetBucketPageId(slot);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    for (page_id_t child_page_id : child_page_ids) {
+      DeleteDirectoryTree(child_page_id, levels - 1);
+    }
+  }
+  if (!buffer_pool_manager_->DeletePage(page_id)) {
+    dropped_pages_.push_back(page_id);
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a hash table bucket page.");
+  }
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::NewBucketPage(page_id_t *bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
+  Page *page = buffer_pool_manager_->NewPage(bucket_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a hash table bucket page.");
+  }
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+}
+
+/*
+ * The bucket lives at the start of its page's data, which is where the page object itself starts.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::BucketToPage(HASH_TABLE_BUCKET_TYPE *bucket_page) -> Page * {
+  return reinterpret_cast<Page *>(bucket_page);
 }
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
+/*
+ * The bucket is latched before the version is validated: a split or merge that begins after that cannot change the
+ * bucket before the latch is released, since splits latch the buckets they write and merges do not delete a bucket
+ * that is pinned. A bucket that was dropped before it was fetched is read back from disk and given up on, as the
+ * merge that dropped it made the version odd before it took the buffer pool latch.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::OptimisticGetValue(const KeyType &key, uint64_t hash, std::vector<ValueType> *result,
+                                         bool *found) -> bool {
+  uint64_t version = directory_version_.load(std::memory_order_acquire);
+  uint32_t global_depth = cached_depth_.load(std::memory_order_acquire);
+  if ((version & 1) != 0 || global_depth > DIRECTORY_CACHE_DEPTH) {
+    return false;
+  }
+  uint32_t directory_idx = static_cast<uint32_t>(hash & ((uint64_t{1} << global_depth) - 1));
+  page_id_t bucket_page_id = CachedBucket(directory_idx).load(std::memory_order_relaxed);
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+  Page *page = BucketToPage(bucket_page);
+  page->RLatch();
+  std::atomic_thread_fence(std::memory_order_acquire);
+  bool valid = directory_version_.load(std::memory_order_relaxed) == version;
+  if (valid) {
+    *found = bucket_page->GetValue(key, comparator_, result, HashToTag(hash));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  return valid;
+}
+
+/*
+ * Tries without the table latch first, and takes it shared only if a split or merge got in the way.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  bool found;
+  if (OptimisticGetValue(key, hash, result, &found)) {
+    return found;
+  }
+  table_latch_.RLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  page_id_t bucket_page_id = LookupCachedBucket(dir_page, HashToDirectoryIndex(hash, dir_page));
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+  Page *page = BucketToPage(bucket_page);
+  page->RLatch();
+  found = bucket_page->GetValue(key, comparator_, result, HashToTag(hash));
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*
+ * All keys are hashed in one batch, before the table latch is taken, and sorted by bucket, so that each bucket is
+ * fetched and latched once for all of its keys.
+ * The buckets are then probed in groups of BATCH_GROUP_SIZE: every bucket of a group is fetched and its tags
+ * prefetched before the first one is probed, so that the cache misses of the group overlap.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                                std::vector<std::vector<ValueType>> *results) {
+  results->assign(keys.size(), std::vector<ValueType>{});
+  // (bucket page, key index) of every key, and the first of them for each bucket, closed by a sentinel
+  std::vector<std::pair<page_id_t, size_t>> probes(keys.size());
+  std::vector<uint8_t> tags(keys.size());
+  std::vector<size_t> runs;
+  std::vector<uint64_t> hashes(keys.size());
+  hash_fn_.GetHashes(keys.data(), keys.size(), hashes.data());
+  table_latch_.RLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  for (size_t i = 0; i < keys.size(); i++) {
+    tags[i] = HashToTag(hashes[i]);
+    probes[i] = {LookupCachedBucket(dir_page, HashToDirectoryIndex(hashes[i], dir_page)), i};
+  }
+  std::sort(probes.begin(), probes.end());
+  for (size_t i = 0; i < probes.size(); i++) {
+    if (i == 0 || probes[i].first != probes[i - 1].first) {
+      runs.push_back(i);
+    }
+  }
+  runs.push_back(probes.size());
+
+  std::array<HASH_TABLE_BUCKET_TYPE *, BATCH_GROUP_SIZE> group;
+  for (size_t first = 0; first + 1 < runs.size(); first += BATCH_GROUP_SIZE) {
+    size_t size = std::min(BATCH_GROUP_SIZE, runs.size() - 1 - first);
+    for (size_t r = 0; r < size; r++) {
+      group[r] = FetchBucketPage(probes[runs[first + r]].first);
+      group[r]->PrefetchMetadata();
+    }
+    for (size_t r = 0; r < size; r++) {
+      Page *page = BucketToPage(group[r]);
+      page->RLatch();
+      for (size_t p = runs[first + r]; p < runs[first + r + 1]; p++) {
+        size_t i = probes[p].second;
+        group[r]->GetValue(keys[i], comparator_, &(*results)[i], tags[i]);
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+  }
+  table_latch_.RUnlock();
+}
+
+/*
+ * Every bucket is read at the first directory entry that points to it, the one whose index is below 2^local depth.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ForEachKey(const std::function<void(const KeyType &)> &fn) {
+  table_latch_.RLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  std::vector<page_id_t> bucket_page_ids;
+  ForEachEntry(dir_page, 0, 0, false, [&](HashTableDirectoryPage *leaf_page, uint32_t slot, uint64_t idx) {
+    if (idx < (uint64_t{1} << leaf_page->GetLocalDepth(slot))) {
+      bucket_page_ids.push_back(leaf_page->GetBucketPageId(slot));
+    }
+  });
+  for (page_id_t bucket_page_id : bucket_page_ids) {
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    Page *page = BucketToPage(bucket_page);
+    page->RLatch();
+    for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE; bucket_idx++) {
+      if (bucket_page->IsReadable(bucket_idx)) {
+        fn(bucket_page->KeyAt(bucket_idx));
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+  table_latch_.RUnlock();
 }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
+/*
+ * The common case only latches the target bucket, under the shared table latch: the directory cannot change while
+ * it is held, so it is read without a latch of its own. Only a full bucket escalates to SplitInsert.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  table_latch_.RLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  page_id_t bucket_page_id = LookupCachedBucket(dir_page, HashToDirectoryIndex(hash, dir_page));
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+  Page *page = BucketToPage(bucket_page);
+  page->WLatch();
+  bool full = bucket_page->IsFull();
+  bool inserted = !full && bucket_page->Insert(key, value, comparator_, HashToTag(hash));
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  table_latch_.RUnlock();
+  if (!full) {
+    return inserted;
+  }
+  return SplitInsert(transaction, key, value);
 }
 
+/*
+ * Holds the table latch exclusively, and latches buckets only while it writes them, for the lookups that go without
+ * the table latch. The bucket was seen full without that latch, so it is looked up again: another thread may have
+ * split or emptied it meanwhile. A bucket splits until the key's bucket has room, doubling the directory when the
+ * bucket is as deep as it; the insert fails once the directory cannot grow any further.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  table_latch_.WLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = HashToDirectoryIndex(hash, dir_page);
+    uint32_t local_depth;
+    page_id_t bucket_page_id = LookupBucket(dir_page, bucket_idx, &local_depth);
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    if (!bucket_page->IsFull()) {
+      Page *page = BucketToPage(bucket_page);
+      page->WLatch();
+      inserted = bucket_page->Insert(key, value, comparator_, HashToTag(hash));
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+    std::vector<ValueType> values;
+    bucket_page->GetValue(key, comparator_, &values, HashToTag(hash));
+    if (std::find(values.begin(), values.end(), value) != values.end() || local_depth == DIRECTORY_MAX_DEPTH) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+
+    BeginDirectoryChange();
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      GrowDirectory(dir_page);
+    }
+    uint32_t high_bit = 1U << local_depth;
+    page_id_t image_page_id;
+    HASH_TABLE_BUCKET_TYPE *image_page = NewBucketPage(&image_page_id);
+    ForEachEntry(dir_page, bucket_idx & (high_bit - 1), local_depth, true,
+                 [&](HashTableDirectoryPage *leaf_page, uint32_t slot, uint64_t idx) {
+                   leaf_page->IncrLocalDepth(slot);
+                   if ((idx & high_bit) != 0) {
+                     leaf_page->SetBucketPageId(slot, image_page_id);
+                     CacheBucket(idx, image_page_id);
+                   }
+                 });
+    dir_page->UpdateBucketCount(local_depth, -1);
+    dir_page->UpdateBucketCount(local_depth + 1, 2);
+    directory_page_->SetDirty(true);
+
+    // rebuild the bucket rather than leave tombstones behind for every pair that moves; lookups that found the image
+    // through the directory give up on it without reading it, since the version is odd
+    std::vector<std::tuple<KeyType, ValueType, uint8_t>> pairs;
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE; slot++) {
+      if (bucket_page->IsReadable(slot)) {
+        pairs.emplace_back(bucket_page->KeyAt(slot), bucket_page->ValueAt(slot), bucket_page->TagAt(slot));
+      }
+    }
+    Page *page = BucketToPage(bucket_page);
+    page->WLatch();
+    page->ResetData();
+    for (const auto &[pair_key, pair_value, tag] : pairs) {
+      auto *target = (Hash(pair_key) & high_bit) != 0 ? image_page : bucket_page;
+      target->Insert(pair_key, pair_value, comparator_, tag);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    EndDirectoryChange();
+  }
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,14 +610,136 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  table_latch_.RLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  page_id_t bucket_page_id = LookupCachedBucket(dir_page, HashToDirectoryIndex(hash, dir_page));
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+  Page *page = BucketToPage(bucket_page);
+  page->WLatch();
+  bool removed = bucket_page->Remove(key, value, comparator_, HashToTag(hash));
+  bool empty = removed && bucket_page->IsEmpty();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  table_latch_.RUnlock();
+  if (empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
+/*
+ * Holds the table latch exclusively. The bucket was seen empty without that latch, so the conditions are checked
+ * again. Merging goes on one level up as long as one of the two halves is empty, so that a bucket left empty next to
+ * a deeper split image merges too, once that image has merged back; the directory shrinks as far as the remaining
+ * local depths allow.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  DeleteDroppedPages();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  auto is_empty = [this](page_id_t bucket_page_id) {
+    bool empty = FetchBucketPage(bucket_page_id)->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    return empty;
+  };
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth;
+    page_id_t bucket_page_id = LookupBucket(dir_page, bucket_idx, &local_depth);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_depth;
+    page_id_t image_page_id = LookupBucket(dir_page, bucket_idx ^ (1U << (local_depth - 1)), &image_depth);
+    if (image_depth != local_depth) {
+      break;
+    }
+    page_id_t drop_page_id;
+    page_id_t keep_page_id;
+    if (is_empty(bucket_page_id)) {
+      drop_page_id = bucket_page_id;
+      keep_page_id = image_page_id;
+    } else if (is_empty(image_page_id)) {
+      drop_page_id = image_page_id;
+      keep_page_id = bucket_page_id;
+    } else {
+      break;
+    }
+
+    BeginDirectoryChange();
+    uint32_t low_bits = bucket_idx & ((1U << (local_depth - 1)) - 1);
+    ForEachEntry(dir_page, low_bits, local_depth - 1, true,
+                 [&](HashTableDirectoryPage *leaf_page, uint32_t slot, uint64_t idx) {
+                   leaf_page->SetBucketPageId(slot, keep_page_id);
+                   leaf_page->DecrLocalDepth(slot);
+                   CacheBucket(idx, keep_page_id);
+                 });
+    dir_page->UpdateBucketCount(local_depth, -2);
+    dir_page->UpdateBucketCount(local_depth - 1, 1);
+    // only lookups without the table latch can have the bucket pinned; a later merge deletes it once they are done
+    if (!buffer_pool_manager_->DeletePage(drop_page_id)) {
+      dropped_pages_.push_back(drop_page_id);
+    }
+    while (dir_page->GetGlobalDepth() > 0 && dir_page->GetBucketCount(dir_page->GetGlobalDepth()) == 0) {
+      ShrinkDirectory(dir_page);
+    }
+    directory_page_->SetDirty(true);
+    EndDirectoryChange();
+  }
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteDroppedPages() {
+  dropped_pages_.erase(std::remove_if(dropped_pages_.begin(), dropped_pages_.end(),
+                                      [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); }),
+                       dropped_pages_.end());
+}
+
+/*****************************************************************************
+ * DESTROY
+ *****************************************************************************/
+/*
+ * The buckets go first, found through the directory pages, which go next; the pinned head goes last. Pages that
+ * lookups still pin are collected in dropped_pages_ and handed to the caller.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Destroy(std::vector<page_id_t> *pinned_page_ids) {
+  table_latch_.WLock();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(directory_page_->GetData());
+  std::vector<page_id_t> bucket_page_ids;
+  ForEachEntry(dir_page, 0, 0, false, [&](HashTableDirectoryPage *leaf_page, uint32_t slot, uint64_t idx) {
+    if (idx < (uint64_t{1} << leaf_page->GetLocalDepth(slot))) {
+      bucket_page_ids.push_back(leaf_page->GetBucketPageId(slot));
+    }
+  });
+  for (page_id_t bucket_page_id : bucket_page_ids) {
+    if (!buffer_pool_manager_->DeletePage(bucket_page_id)) {
+      dropped_pages_.push_back(bucket_page_id);
+    }
+  }
+  DeleteDroppedPages();
+  uint32_t levels = DirectoryLevels(dir_page);
+  if (levels > 0) {
+    uint32_t head_depth = dir_page->GetGlobalDepth() - levels * DIRECTORY_LEVEL_DEPTH;
+    for (uint32_t slot = 0; slot < (1U << head_depth); slot++) {
+      DeleteDirectoryTree(dir_page->GetBucketPageId(slot), levels);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  if (!buffer_pool_manager_->DeletePage(directory_page_id_)) {
+    dropped_pages_.push_back(directory_page_id_);
+  }
+  pinned_page_ids->insert(pinned_page_ids->end(), dropped_pages_.begin(), dropped_pages_.end());
+  dropped_pages_.clear();
+  directory_page_ = nullptr;
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -124,6 +766,57 @@ void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RUnlock();
 }
 
+/*****************************************************************************
+ * VERIFY DIRECTORY TREE
+ *****************************************************************************/
+/*
+ * A head page that indexes lower directory pages holds no buckets of its own, so the page-level check only applies
+ * to a single-page directory.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::VerifyDirectoryTree() {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  if (DirectoryLevels(dir_page) == 0) {
+    dir_page->VerifyIntegrity();
+  }
+  VerifyDirectory(dir_page);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::VerifyDirectory(HashTableDirectoryPage *dir_page) {
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  std::unordered_map<page_id_t, uint64_t> page_id_to_count;
+  std::unordered_map<page_id_t, uint32_t> page_id_to_ld;
+  ForEachEntry(dir_page, 0, 0, false, [&](HashTableDirectoryPage *leaf_page, uint32_t slot, uint64_t idx) {
+    page_id_t page_id = leaf_page->GetBucketPageId(slot);
+    uint32_t local_depth = leaf_page->GetLocalDepth(slot);
+    assert(local_depth <= global_depth);
+    ++page_id_to_count[page_id];
+    auto [it, inserted] = page_id_to_ld.emplace(page_id, local_depth);
+    if (!inserted && it->second != local_depth) {
+      LOG_WARN("Verify Integrity: local depth %u at index %lu, %u before, for page_id: %d", local_depth, idx,
+               it->second, page_id);
+      assert(it->second == local_depth);
+    }
+  });
+
+  std::vector<uint32_t> bucket_counts(DIRECTORY_MAX_DEPTH + 1);
+  for (const auto &[page_id, count] : page_id_to_count) {
+    uint32_t local_depth = page_id_to_ld[page_id];
+    if (count != uint64_t{1} << (global_depth - local_depth)) {
+      LOG_WARN("Verify Integrity: %lu entries of local depth %u for page_id: %d", count, local_depth, page_id);
+      assert(count == uint64_t{1} << (global_depth - local_depth));
+    }
+    bucket_counts[local_depth]++;
+  }
+  for (uint32_t local_depth = 0; local_depth <= DIRECTORY_MAX_DEPTH; local_depth++) {
+    assert(bucket_counts[local_depth] == dir_page->GetBucketCount(local_depth));
+  }
+}
+
 /*****************************************************************************
  * TEMPLATE DEFINITIONS - DO NOT TOUCH
  *****************************************************************************/
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <initializer_list>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -17,6 +19,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "container/hash/linear_probe_hash_table.h"
 
@@ -26,21 +29,83 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  size_t num_blocks = (num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE;
+  generation_ = NewGeneration(std::max<size_t>(num_blocks, 1));
+  header_page_id_ = generation_->header_pages_.front()->GetPageId();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_TYPE::~LinearProbeHashTable() {
+  for (Generation *generation : {generation_.get(), new_generation_.get()}) {
+    if (generation == nullptr) {
+      continue;
+    }
+    for (HashTableHeaderPage *header_page : generation->header_pages_) {
+      buffer_pool_manager_->UnpinPage(header_page->GetPageId(), false);
+    }
+  }
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
+/*
+ * A pair that moves between the generations meanwhile may be seen in both, but is returned once.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  size_t num_found = result->size();
+  auto collect = [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    if (block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0) {
+      ValueType value = block_page->ValueAt(offset);
+      if (std::find(result->begin() + num_found, result->end(), value) == result->end()) {
+        result->push_back(value);
+      }
+    }
+    return false;
+  };
+  table_latch_.RLock();
+  Probe(generation_.get(), hash, false, collect);
+  if (new_generation_ != nullptr) {
+    Probe(new_generation_.get(), hash, false, collect);
+  }
+  table_latch_.RUnlock();
+  return result->size() > num_found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  auto is_pair = [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    return block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0 &&
+           block_page->ValueAt(offset) == value;
+  };
+  table_latch_.RLock();
+  bool inserted;
+  {
+    std::scoped_lock lock(KeyLatch(hash));
+    bool exists = Probe(generation_.get(), hash, false, is_pair) ||
+                  (new_generation_ != nullptr && Probe(new_generation_.get(), hash, false, is_pair));
+    inserted = !exists &&
+               InsertInto(new_generation_ != nullptr ? new_generation_.get() : generation_.get(), hash, key, value);
+    if (inserted) {
+      num_occupied_++;
+      num_pairs_++;
+    }
+  }
+  bool finish = new_generation_ != nullptr && MigrateBlock();
+  bool resize = new_generation_ == nullptr && num_occupied_ * 2 > generation_->GetSize();
+  table_latch_.RUnlock();
+  if (finish) {
+    FinishResize();
+  } else if (resize) {
+    MaybeResize();
+  }
+  return inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +113,260 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  table_latch_.RLock();
+  bool removed;
+  {
+    std::scoped_lock lock(KeyLatch(hash));
+    removed = RemoveFrom(generation_.get(), hash, key, value) ||
+              (new_generation_ != nullptr && RemoveFrom(new_generation_.get(), hash, key, value));
+    if (removed) {
+      num_pairs_--;
+    }
+  }
+  bool finish = new_generation_ != nullptr && MigrateBlock();
+  table_latch_.RUnlock();
+  if (finish) {
+    FinishResize();
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  if (new_generation_ == nullptr) {
+    StartResize(2 * initial_size);
+  }
+  table_latch_.WUnlock();
+}
+
+/*
+ * A table whose slots are mostly tombstones is rebuilt at the same size instead of twice as large.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MaybeResize() {
+  table_latch_.WLock();
+  size_t size = generation_->GetSize();
+  if (new_generation_ == nullptr && num_occupied_ * 2 > size) {
+    StartResize(num_pairs_ * 4 <= size ? size : 2 * size);
+  }
+  table_latch_.WUnlock();
+}
+
+/*
+ * Allocating the new blocks is all a resize does up front. A generation that would be more than half full from the
+ * start is not worth it, as when Resize() asks for fewer slots than the pairs need.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::StartResize(size_t num_slots) {
+  size_t num_blocks = std::max<size_t>((num_slots + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1);
+  if (num_blocks * BLOCK_ARRAY_SIZE < 2 * num_pairs_) {
+    return;
+  }
+  new_generation_ = NewGeneration(num_blocks);
+  next_block_ = 0;
+  moved_blocks_ = 0;
+  num_occupied_ = 0;
+}
+
+/*
+ * Every pair moves under the latch of its key, so that an insert or remove of the key finds it in one of the
+ * generations. Nothing is inserted into the old generation any more, so its slots only ever turn into tombstones.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::MigrateBlock() -> bool {
+  size_t num_blocks = generation_->NumBlocks();
+  size_t block_idx = next_block_++;
+  if (block_idx >= num_blocks) {
+    return false;
+  }
+  page_id_t block_page_id = generation_->GetBlockPageId(block_idx);
+  HASH_TABLE_BLOCK_TYPE *block_page = FetchBlockPage(block_page_id);
+  bool is_dirty = false;
+  for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+    if (!block_page->IsReadable(offset)) {
+      continue;
+    }
+    KeyType key = block_page->KeyAt(offset);
+    uint64_t hash = hash_fn_.GetHash(key);
+    std::scoped_lock lock(KeyLatch(hash));
+    if (block_page->IsReadable(offset)) {
+      [[maybe_unused]] bool moved = InsertInto(new_generation_.get(), hash, key, block_page->ValueAt(offset));
+      BUSTUB_ASSERT(moved, "The new generation must have room for every pair.");
+      num_occupied_++;
+      block_page->Remove(offset);
+      is_dirty = true;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+  return ++moved_blocks_ == num_blocks;
+}
+
+/*
+ * Holding the table latch exclusively makes sure no operation is still probing the old generation.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FinishResize() {
+  table_latch_.WLock();
+  std::unique_ptr<Generation> old_generation = std::move(generation_);
+  generation_ = std::move(new_generation_);
+  header_page_id_ = generation_->header_pages_.front()->GetPageId();
+  table_latch_.WUnlock();
+  DeleteGeneration(old_generation.get());
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  table_latch_.RLock();
+  size_t size = (new_generation_ != nullptr ? new_generation_ : generation_)->GetSize();
+  table_latch_.RUnlock();
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::IsResizing() -> bool {
+  table_latch_.RLock();
+  bool resizing = new_generation_ != nullptr;
+  table_latch_.RUnlock();
+  return resizing;
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::NewGeneration(size_t num_blocks) -> std::unique_ptr<Generation> {
+  auto generation = std::make_unique<Generation>();
+  size_t num_header_pages = (num_blocks + HEADER_ARRAY_SIZE - 1) / HEADER_ARRAY_SIZE;
+  for (size_t i = 0; i < num_header_pages; i++) {
+    page_id_t header_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&header_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a hash table header page.");
+    }
+    // the header page keeps this pin for as long as the generation is used
+    page->SetDirty(true);
+    auto *header_page = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+    header_page->SetPageId(header_page_id);
+    header_page->SetNextPageId(INVALID_PAGE_ID);
+    header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+    if (!generation->header_pages_.empty()) {
+      generation->header_pages_.back()->SetNextPageId(header_page_id);
+    }
+    generation->header_pages_.push_back(header_page);
+  }
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a hash table block page.");
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    generation->header_pages_[i / HEADER_ARRAY_SIZE]->AddBlockPageId(block_page_id);
+  }
+  return generation;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteGeneration(Generation *generation) {
+  for (size_t i = 0; i < generation->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(generation->GetBlockPageId(i));
+  }
+  for (HashTableHeaderPage *header_page : generation->header_pages_) {
+    page_id_t header_page_id = header_page->GetPageId();
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+    buffer_pool_manager_->DeletePage(header_page_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE * {
+  Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a hash table block page.");
+  }
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+}
+
+/*
+ * A block stays pinned while the probe goes through its slots.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::Probe(Generation *generation, uint64_t hash, bool is_dirty,
+                            const std::function<bool(HASH_TABLE_BLOCK_TYPE *, slot_offset_t)> &fn) -> bool {
+  size_t size = generation->GetSize();
+  size_t slot = hash % size;
+  for (size_t probed = 0; probed < size;) {
+    size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = generation->GetBlockPageId(block_idx);
+    HASH_TABLE_BLOCK_TYPE *block_page = FetchBlockPage(block_page_id);
+    for (slot_offset_t offset = slot % BLOCK_ARRAY_SIZE; offset < BLOCK_ARRAY_SIZE && probed < size;
+         offset++, probed++) {
+      if (!block_page->IsOccupied(offset)) {
+        buffer_pool_manager_->UnpinPage(block_page_id, false);
+        return false;
+      }
+      if (fn(block_page, offset)) {
+        buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+        return true;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, false);
+    slot = (block_idx + 1) * BLOCK_ARRAY_SIZE % size;
+  }
+  return false;
+}
+
+/*
+ * A slot that another insert claims first is skipped like any other occupied slot.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertInto(Generation *generation, uint64_t hash, const KeyType &key,
+                                 const ValueType &value) -> bool {
+  size_t size = generation->GetSize();
+  size_t slot = hash % size;
+  for (size_t probed = 0; probed < size;) {
+    size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = generation->GetBlockPageId(block_idx);
+    HASH_TABLE_BLOCK_TYPE *block_page = FetchBlockPage(block_page_id);
+    for (slot_offset_t offset = slot % BLOCK_ARRAY_SIZE; offset < BLOCK_ARRAY_SIZE && probed < size;
+         offset++, probed++) {
+      if (!block_page->IsOccupied(offset) && block_page->Insert(offset, key, value)) {
+        buffer_pool_manager_->UnpinPage(block_page_id, true);
+        return true;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, false);
+    slot = (block_idx + 1) * BLOCK_ARRAY_SIZE % size;
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::RemoveFrom(Generation *generation, uint64_t hash, const KeyType &key,
+                                 const ValueType &value) -> bool {
+  return Probe(generation, hash, true, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    if (block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0 &&
+        block_page->ValueAt(offset) == value) {
+      block_page->Remove(offset);
+      return true;
+    }
+    return false;
+  });
+}
+
+/*
+ * The latch is picked by bits of the hash above those that pick the slot in any table of realistic size.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+inline auto HASH_TABLE_TYPE::KeyLatch(uint64_t hash) -> std::mutex & {
+  return key_latches_[(hash >> 48) % KEY_LATCH_COUNT];
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
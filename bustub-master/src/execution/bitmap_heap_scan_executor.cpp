@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_heap_scan_executor.cpp
+//
+// Identification: src/execution/bitmap_heap_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/bitmap_heap_scan_executor.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+namespace bustub {
+
+BitmapHeapScanExecutor::BitmapHeapScanExecutor(ExecutorContext *exec_ctx, const BitmapHeapScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void BitmapHeapScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto *index_info = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info->table_name_);
+
+  rids_.clear();
+  table_info_->heap_latch_.RLock();
+  for (const auto &key : plan_->GetKeys()) {
+    index_info->index_->ScanKey(key, &rids_, exec_ctx_->GetTransaction());
+  }
+  heap_ = table_info_->table_.get();
+  table_info_->heap_latch_.RUnlock();
+  cursor_ = 0;
+  page_tuples_.clear();
+  bitmap_scan_ = rids_.size() >= plan_->GetBitmapThreshold();
+
+  if (bitmap_scan_) {
+    std::sort(rids_.begin(), rids_.end(), [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); });
+    rids_.erase(std::unique(rids_.begin(), rids_.end()), rids_.end());
+  } else {
+    // Keep the index order, but drop the repeats that overlapping keys may produce.
+    std::unordered_set<RID> seen;
+    auto repeated = [&seen](const RID &rid) { return !seen.insert(rid).second; };
+    rids_.erase(std::remove_if(rids_.begin(), rids_.end(), repeated), rids_.end());
+  }
+}
+
+void BitmapHeapScanExecutor::FetchNextPage() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  auto *txn = exec_ctx_->GetTransaction();
+  const page_id_t page_id = rids_[cursor_].GetPageId();
+  size_t end = cursor_;
+  while (end < rids_.size() && rids_[end].GetPageId() == page_id) {
+    end++;
+  }
+  // Lock the rows before latching the page: a writer holding one of the row locks may be waiting for the latch.
+  // GetTuple() then finds the locks held and does not wait under the latch. A refused lock aborts the transaction
+  // rather than dropping the row from the result.
+  if (enable_logging) {
+    for (size_t i = cursor_; i < end; i++) {
+      const RID &rid = rids_[i];
+      if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) &&
+          !exec_ctx_->GetLockManager()->LockShared(txn, rid)) {
+        txn->SetState(TransactionState::ABORTED);
+        throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+      }
+    }
+  }
+  auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+  page->RLatch();
+  for (size_t i = cursor_; i < end; i++) {
+    Tuple tuple;
+    if (page->GetTuple(rids_[i], &tuple, txn, exec_ctx_->GetLockManager())) {
+      page_tuples_.push_back(std::move(tuple));
+    }
+  }
+  page->RUnlatch();
+  cursor_ = end;
+  bpm->UnpinPage(page_id, false);
+}
+
+auto BitmapHeapScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto *predicate = plan_->GetPredicate();
+  const auto *schema = &table_info_->schema_;
+  while (true) {
+    Tuple row;
+    if (bitmap_scan_) {
+      while (page_tuples_.empty() && cursor_ < rids_.size()) {
+        FetchNextPage();
+      }
+      if (page_tuples_.empty()) {
+        return false;
+      }
+      row = std::move(page_tuples_.front());
+      page_tuples_.pop_front();
+    } else {
+      if (cursor_ == rids_.size()) {
+        return false;
+      }
+      if (!heap_->GetTuple(rids_[cursor_++], &row, exec_ctx_->GetTransaction())) {
+        continue;
+      }
+    }
+    if (predicate != nullptr && !predicate->Evaluate(&row, schema).GetAs<bool>()) {
+      continue;
+    }
+
+    const auto *output_schema = GetOutputSchema();
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&row, schema));
+    }
+    *tuple = Tuple(values, output_schema);
+    *rid = row.GetRid();
+    return true;
+  }
+}
+
+}  // namespace bustub
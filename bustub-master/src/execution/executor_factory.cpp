@@ -17,14 +17,17 @@
 
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/bitmap_heap_scan_executor.h"
 #include "execution/executors/delete_executor.h"
 #include "execution/executors/distinct_executor.h"
 #include "execution/executors/hash_join_executor.h"
+#include "execution/executors/index_only_scan_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/limit_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/partition_scan_executor.h"
 #include "execution/executors/seq_scan_executor.h"
 #include "execution/executors/update_executor.h"
 #include "storage/index/generic_key.h"
@@ -44,6 +47,21 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan));
     }
 
+    // Create a new bitmap heap scan executor
+    case PlanType::BitmapHeapScan: {
+      return std::make_unique<BitmapHeapScanExecutor>(exec_ctx, dynamic_cast<const BitmapHeapScanPlanNode *>(plan));
+    }
+
+    // Create a new index-only scan executor
+    case PlanType::IndexOnlyScan: {
+      return std::make_unique<IndexOnlyScanExecutor>(exec_ctx, dynamic_cast<const IndexOnlyScanPlanNode *>(plan));
+    }
+
+    // Create a new partition scan executor
+    case PlanType::PartitionScan: {
+      return std::make_unique<PartitionScanExecutor>(exec_ctx, dynamic_cast<const PartitionScanPlanNode *>(plan));
+    }
+
     // Create a new insert executor
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan);
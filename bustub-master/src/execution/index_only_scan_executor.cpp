@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.cpp
+//
+// Identification: src/execution/index_only_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/index_only_scan_executor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexOnlyScanExecutor::Init() {
+  index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
+  auto *txn = exec_ctx_->GetTransaction();
+  entries_.clear();
+  table_info_->heap_latch_.RLock();
+  if (plan_->GetKeys().empty()) {
+    index_info_->index_->ScanEntries(nullptr, &entries_, txn);
+  }
+  for (const auto &key : plan_->GetKeys()) {
+    index_info_->index_->ScanEntries(&key, &entries_, txn);
+  }
+  table_info_->heap_latch_.RUnlock();
+  cursor_ = 0;
+}
+
+auto IndexOnlyScanExecutor::IsStillIndexed(const Tuple &entry, const RID &rid) -> bool {
+  std::vector<std::pair<Tuple, RID>> current;
+  table_info_->heap_latch_.RLock();
+  index_info_->index_->ScanEntries(&entry, &current, exec_ctx_->GetTransaction());
+  table_info_->heap_latch_.RUnlock();
+  return std::any_of(current.begin(), current.end(), [&entry, &rid](const std::pair<Tuple, RID> &other) {
+    return other.second == rid && other.first.GetLength() == entry.GetLength() &&
+           memcmp(other.first.GetData(), entry.GetData(), entry.GetLength()) == 0;
+  });
+}
+
+auto IndexOnlyScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto *predicate = plan_->GetPredicate();
+  const auto *schema = &index_info_->key_schema_;
+  auto *txn = exec_ctx_->GetTransaction();
+  while (cursor_ < entries_.size()) {
+    const auto &[entry, entry_rid] = entries_[cursor_++];
+    // The same lock TablePage::GetTuple takes before it hands out a tuple. The entry was read before the lock was
+    // taken, so a writer may have deleted or changed the tuple in between: the entry must still be in the index.
+    if (enable_logging && !txn->IsSharedLocked(entry_rid) && !txn->IsExclusiveLocked(entry_rid)) {
+      if (!exec_ctx_->GetLockManager()->LockShared(txn, entry_rid)) {
+        // Skipping the row would return a wrong result; the transaction cannot go on without the lock.
+        txn->SetState(TransactionState::ABORTED);
+        throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+      }
+      if (!IsStillIndexed(entry, entry_rid)) {
+        continue;
+      }
+    }
+    if (predicate != nullptr && !predicate->Evaluate(&entry, schema).GetAs<bool>()) {
+      continue;
+    }
+
+    const auto *output_schema = GetOutputSchema();
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&entry, schema));
+    }
+    *tuple = Tuple(values, output_schema);
+    *rid = entry_rid;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partition_scan_executor.cpp
+//
+// Identification: src/execution/partition_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/partition_scan_executor.h"
+
+#include <memory>
+#include <vector>
+
+namespace bustub {
+
+PartitionScanExecutor::PartitionScanExecutor(ExecutorContext *exec_ctx, const PartitionScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void PartitionScanExecutor::Init() {
+  partitions_ = exec_ctx_->GetCatalog()->GetPartitions(plan_->GetTableName(), plan_->GetLower(), plan_->GetUpper());
+  partition_ = 0;
+  iter_.reset();
+}
+
+auto PartitionScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto *predicate = plan_->GetPredicate();
+  while (partition_ < partitions_.size()) {
+    auto *table = partitions_[partition_];
+    if (iter_ == nullptr) {
+      iter_ = std::make_unique<TableIterator>(table->table_->Begin(exec_ctx_->GetTransaction()));
+    }
+    if (*iter_ == table->table_->End()) {
+      iter_.reset();
+      partition_++;
+      continue;
+    }
+    Tuple row = **iter_;
+    ++*iter_;
+    const auto *schema = &table->schema_;
+    if (predicate != nullptr && !predicate->Evaluate(&row, schema).GetAs<bool>()) {
+      continue;
+    }
+
+    const auto *output_schema = GetOutputSchema();
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&row, schema));
+    }
+    *tuple = Tuple(values, output_schema);
+    *rid = row.GetRid();
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
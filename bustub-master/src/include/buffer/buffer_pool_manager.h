@@ -84,6 +84,13 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Hint that a page will be fetched soon: it is read into the buffer pool in the background, unpinned, so that the
+   * FetchPage that follows finds it there. The hint may be dropped, and the page evicted again before it is used.
+   * @param page_id id of the page to prefetch
+   */
+  void PrefetchPage(page_id_t page_id) { PrefetchPgImp(page_id); }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
@@ -141,5 +148,11 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Start reading a page into the buffer pool without waiting for it. Ignoring the hint is always correct.
+   * @param page_id id of the page to prefetch
+   */
+  virtual void PrefetchPgImp(page_id_t page_id) {}
 };
 }  // namespace bustub
@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/lru_replacer.h"
@@ -100,6 +104,31 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Queue a page for the prefetch thread, starting it on first use. The hint is dropped while the queue holds as many
+   * pages as the pool.
+   * @param page_id id of the page to prefetch
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+  /** Body of the prefetch thread: read in queued pages until the instance is destroyed. */
+  void PrefetchLoop();
+
+  /**
+   * Read a page into a free or victim frame unless it is in the pool already, and leave it unpinned. The frame is
+   * pinned and marked loading while the disk read runs outside of latch_; a FetchPage for the page meanwhile waits.
+   * @param page_id id of the page to read in
+   */
+  void ReadInPage(page_id_t page_id);
+
+  /**
+   * Pick a frame to hold a new page, preferring the free list over the replacer. A dirty victim is written back and
+   * removed from the page table. Must be called with latch_ held.
+   * @param[out] frame_id the frame that was freed up
+   * @return false if every frame is pinned, true otherwise
+   */
+  auto FindVictimFrame(frame_id_t *frame_id) -> bool;
+
   /**
    * Allocate a page on disk.∂
    * @return the id of the allocated page
@@ -142,7 +171,22 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** Protects page_table_, free_list_, the replacer and the pin count / dirty flag / page id of every frame. */
   std::mutex latch_;
+  /** Whether the page of each frame is still being read in by the prefetch thread; guarded by latch_. */
+  std::vector<bool> loading_;
+  /** Signalled whenever a prefetched page has been read in. */
+  std::condition_variable loaded_;
+
+  /** Pages waiting to be prefetched. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Set when the instance is destroyed, to stop the prefetch thread. */
+  bool stop_prefetching_ = false;
+  /** Protects prefetch_queue_, stop_prefetching_ and starting the prefetch thread. */
+  std::mutex prefetch_latch_;
+  /** Signalled when a page is queued or the prefetch thread should stop. */
+  std::condition_variable prefetch_cv_;
+  /** Reads queued pages in the background; started by the first prefetch. */
+  std::thread prefetch_thread_;
 };
 }  // namespace bustub
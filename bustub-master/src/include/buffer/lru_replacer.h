@@ -14,6 +14,7 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
@@ -47,5 +48,7 @@ class LRUReplacer : public Replacer {
  private:
   // TODO(student): implement me!
   std::list<frame_id_t> frames;
+  /** Position of every frame in frames, so that Pin() does not scan the list. */
+  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> positions_;
 };
 }  // namespace bustub
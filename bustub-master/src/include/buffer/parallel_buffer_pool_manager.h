@@ -87,6 +87,12 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Start reading a page into the buffer pool without waiting for it.
+   * @param page_id id of the page to prefetch
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
  private:
   std::vector<BufferPoolManager *> bpInstances;
   size_t pool_size;
@@ -12,17 +12,33 @@
 
 #pragma once
 
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "catalog/table_cluster.h"
+#include "catalog/table_stats.h"
+#include "common/rwlatch.h"
+#include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/adaptive_radix_tree_index.h"
+#include "storage/index/b_link_tree_index.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/bw_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/lsm_tree_index.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -51,10 +67,29 @@ struct TableInfo {
   Schema schema_;
   /** The table name */
   const std::string name_;
-  /** An owning pointer to the table heap */
+  /** An owning pointer to the table heap; replaced by CLUSTER under heap_latch_ */
   std::unique_ptr<TableHeap> table_;
   /** The table OID */
   const table_oid_t oid_;
+  /**
+   * Pairs table_ with the RIDs in the indexes of the table. CLUSTER holds it exclusively while it repoints the
+   * indexes and swaps in the rewritten heap. A reader that looks up RIDs in an index holds it shared until it has
+   * also read table_, and then resolves the RIDs against that heap, which stays readable after a swap.
+   */
+  ReaderWriterLatch heap_latch_;
+
+  /** @return the current table heap */
+  auto GetHeap() -> TableHeap * {
+    heap_latch_.RLock();
+    TableHeap *heap = table_.get();
+    heap_latch_.RUnlock();
+    return heap;
+  }
+  /**
+   * Statistics from the last ANALYZE, nullptr if the table was never analyzed. The pointer is replaced wholesale,
+   * so access it with std::atomic_load / std::atomic_store (or through the Catalog).
+   */
+  std::shared_ptr<const TableStats> stats_;
 };
 
 /**
@@ -92,6 +127,105 @@ struct IndexInfo {
   const size_t key_size_;
 };
 
+/** How the rows of a partitioned table are spread over its partitions. */
+enum class PartitionType { Range, Hash };
+
+/**
+ * The data structure behind an index. AdaptiveRadixTree and BwTree indexes live in memory, see
+ * AdaptiveRadixTreeIndex and BwTreeIndex; LsmTree indexes keep their list of runs in memory, see LsmTreeIndex.
+ */
+enum class IndexType { ExtendibleHash, BPlusTree, BLinkTree, AdaptiveRadixTree, LsmTree, BwTree };
+
+/**
+ * One child table of a partitioned table.
+ */
+struct PartitionInfo {
+  /** The child table holding the rows of this partition */
+  TableInfo *table_;
+  /** Range partitions only: the partition holds the keys in [lower_, upper_) */
+  Value lower_;
+  Value upper_;
+};
+
+/**
+ * The PartitionedTableInfo class maintains metadata about a table whose rows are routed to child tables by range or
+ * hash on one key column. Every child is a regular table of the catalog with its own heap and indexes.
+ */
+struct PartitionedTableInfo {
+  PartitionedTableInfo(Schema schema, std::string name, PartitionType type, uint32_t key_column)
+      : schema_{std::move(schema)}, name_{std::move(name)}, type_{type}, key_column_{key_column} {}
+
+  /**
+   * Find the partition a tuple belongs to.
+   * @param tuple A tuple in the schema of the table
+   * @return The child table for the tuple, or `nullptr` if no partition covers its key (range partitioning only;
+   * a NULL key is never covered)
+   */
+  auto Route(const Tuple &tuple) const -> TableInfo * {
+    Value key = tuple.GetValue(&schema_, key_column_);
+    if (type_ == PartitionType::Hash) {
+      return partitions_[HashPartition(key)].table_;
+    }
+    if (key.IsNull()) {
+      return nullptr;
+    }
+    for (const auto &partition : partitions_) {
+      if (key.CompareGreaterThanEquals(partition.lower_) == CmpBool::CmpTrue &&
+          key.CompareLessThan(partition.upper_) == CmpBool::CmpTrue) {
+        return partition.table_;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Prune the partitions to those that may hold keys in [lower, upper].
+   * @param lower The smallest key of interest, `nullptr` if unbounded
+   * @param upper The largest key of interest, `nullptr` if unbounded
+   * @return The child tables to scan, in partition order
+   */
+  auto Prune(const Value *lower, const Value *upper) const -> std::vector<TableInfo *> {
+    std::vector<TableInfo *> tables;
+    if (type_ == PartitionType::Hash && lower != nullptr && upper != nullptr &&
+        lower->CompareEquals(*upper) == CmpBool::CmpTrue) {
+      // A point lookup hashes to exactly one partition.
+      tables.push_back(partitions_[HashPartition(*lower)].table_);
+      return tables;
+    }
+    for (const auto &partition : partitions_) {
+      if (type_ == PartitionType::Range &&
+          ((lower != nullptr && lower->CompareGreaterThanEquals(partition.upper_) == CmpBool::CmpTrue) ||
+           (upper != nullptr && upper->CompareLessThan(partition.lower_) == CmpBool::CmpTrue))) {
+        continue;
+      }
+      tables.push_back(partition.table_);
+    }
+    return tables;
+  }
+
+  /** @return The position of the hash partition holding key */
+  auto HashPartition(const Value &key) const -> size_t {
+    // HashUtil::HashValue keeps consecutive integers in a few residues, so mix it before taking the modulus.
+    hash_t hash = key.IsNull() ? 0 : HashUtil::MixHash(HashUtil::HashValue(&key));
+    return hash % partitions_.size();
+  }
+
+  /** The table schema */
+  Schema schema_;
+  /** The table name */
+  const std::string name_;
+  /** Range or hash partitioning */
+  const PartitionType type_;
+  /** The column the rows are routed on */
+  const uint32_t key_column_;
+  /** The partitions; range partitions are ordered by key and may leave gaps where partitions were dropped */
+  std::vector<PartitionInfo> partitions_;
+  /** Used to name the child tables, which are never reused */
+  uint32_t next_partition_id_{0};
+  /** Recreates each index of the table on a given child table, so that new partitions get every index */
+  std::vector<std::function<IndexInfo *(Transaction *, const std::string &)>> index_builders_;
+};
+
 /**
  * The Catalog is a non-persistent catalog that is designed for
  * use by executors within the DBMS execution engine. It handles
@@ -105,6 +239,9 @@ class Catalog {
   /** Indicates that an operation returning a `IndexInfo*` failed */
   static constexpr IndexInfo *NULL_INDEX_INFO{nullptr};
 
+  /** The fewest table pages per worker thread when an index is built; smaller tables are scanned by fewer threads. */
+  static constexpr size_t MIN_BUILD_PAGES_PER_WORKER = 8;
+
   /**
    * Construct a new Catalog instance.
    * @param bpm The buffer pool manager backing tables created by this catalog
@@ -176,6 +313,262 @@ class Catalog {
     return (meta->second).get();
   }
 
+  /**
+   * Collect statistics for a table (ANALYZE) and publish them in its TableInfo. Runs concurrently with writers.
+   * @param txn The transaction performing the scan
+   * @param table_name The name of the table
+   * @param options The sampling options
+   * @return The new statistics, or nullptr if the table does not exist
+   */
+  auto AnalyzeTable(Transaction *txn, const std::string &table_name, const AnalyzeOptions &options = {})
+      -> std::shared_ptr<const TableStats> {
+    auto *table_info = GetTable(table_name);
+    if (table_info == NULL_TABLE_INFO) {
+      return nullptr;
+    }
+    std::shared_ptr<const TableStats> stats =
+        TableStats::Analyze(table_info->GetHeap(), table_info->schema_, options, txn);
+    std::atomic_store(&table_info->stats_, stats);
+    return stats;
+  }
+
+  /**
+   * Get the statistics of a table, re-analyzing it first if it was never analyzed or if more than
+   * `stale_threshold` of its rows changed since the last run. Row counts in between are kept current from the
+   * table's insert/delete counters (see TableStats::GetEstimatedRowCount), so re-analysis is rare. It samples
+   * at most AnalyzeOptions::sample_pages_ pages, so its cost does not grow with the table.
+   * @param txn The transaction performing the scan, if one is needed
+   * @param table_name The name of the table
+   * @param stale_threshold The fraction of modified rows that triggers a new ANALYZE
+   * @return The statistics, or nullptr if the table does not exist
+   */
+  auto GetTableStats(Transaction *txn, const std::string &table_name, double stale_threshold = 0.2)
+      -> std::shared_ptr<const TableStats> {
+    auto *table_info = GetTable(table_name);
+    if (table_info == NULL_TABLE_INFO) {
+      return nullptr;
+    }
+    auto stats = std::atomic_load(&table_info->stats_);
+    if (stats == nullptr || stats->IsStale(table_info->GetHeap(), stale_threshold)) {
+      return AnalyzeTable(txn, table_name);
+    }
+    return stats;
+  }
+
+  /**
+   * Create a table whose rows are split by key range over child tables. Partition i holds the keys in
+   * [bounds[i], bounds[i + 1]); more partitions can be added with AddRangePartition().
+   * @param txn The transaction in which the table is being created
+   * @param table_name The name of the new table
+   * @param schema The schema of the new table
+   * @param key_column The index of the column the rows are routed on
+   * @param bounds The ascending partition bounds, at least two
+   * @return A (non-owning) pointer to the metadata for the table, or `nullptr` if the name is taken
+   */
+  auto CreateRangePartitionedTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                                   uint32_t key_column, const std::vector<Value> &bounds) -> PartitionedTableInfo * {
+    BUSTUB_ASSERT(bounds.size() >= 2, "A range partitioned table needs at least one partition.");
+    auto *meta = NewPartitionedTable(table_name, schema, PartitionType::Range, key_column);
+    if (meta == nullptr) {
+      return nullptr;
+    }
+    for (size_t i = 0; i + 1 < bounds.size(); i++) {
+      AddPartition(txn, meta, bounds[i], bounds[i + 1]);
+    }
+    return meta;
+  }
+
+  /**
+   * Create a table whose rows are spread by the hash of a key column over a fixed number of child tables.
+   * @param txn The transaction in which the table is being created
+   * @param table_name The name of the new table
+   * @param schema The schema of the new table
+   * @param key_column The index of the column the rows are routed on
+   * @param num_partitions The number of partitions
+   * @return A (non-owning) pointer to the metadata for the table, or `nullptr` if the name is taken
+   */
+  auto CreateHashPartitionedTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                                  uint32_t key_column, uint32_t num_partitions) -> PartitionedTableInfo * {
+    BUSTUB_ASSERT(num_partitions > 0, "A hash partitioned table needs at least one partition.");
+    auto *meta = NewPartitionedTable(table_name, schema, PartitionType::Hash, key_column);
+    if (meta == nullptr) {
+      return nullptr;
+    }
+    for (uint32_t i = 0; i < num_partitions; i++) {
+      AddPartition(txn, meta, Value{}, Value{});
+    }
+    return meta;
+  }
+
+  /**
+   * Query partitioned table metadata by name.
+   * @param table_name The name of the partitioned table
+   * @return A (non-owning) pointer to the metadata for the table, or `nullptr` if there is no such table
+   */
+  auto GetPartitionedTable(const std::string &table_name) -> PartitionedTableInfo * {
+    auto meta = partitioned_tables_.find(table_name);
+    return meta == partitioned_tables_.end() ? nullptr : meta->second.get();
+  }
+
+  /**
+   * Append a partition holding the keys from the current upper end of a range partitioned table up to `upper`.
+   * The new partition gets every index of the table.
+   * @param txn The transaction in which the partition is being created
+   * @param table_name The name of the partitioned table
+   * @param upper The exclusive upper bound of the new partition
+   * @return The child table of the new partition, or `nullptr` if the table is not range partitioned or `upper` does
+   * not lie above the current upper end
+   */
+  auto AddRangePartition(Transaction *txn, const std::string &table_name, const Value &upper) -> TableInfo * {
+    auto *meta = GetPartitionedTable(table_name);
+    if (meta == nullptr || meta->type_ != PartitionType::Range || meta->partitions_.empty()) {
+      return nullptr;
+    }
+    Value lower = meta->partitions_.back().upper_;
+    if (upper.CompareGreaterThan(lower) != CmpBool::CmpTrue) {
+      return nullptr;
+    }
+    return AddPartition(txn, meta, lower, upper);
+  }
+
+  /**
+   * Drop a partition of a range partitioned table with all of its rows and indexes. The child table and its indexes
+   * are only unlinked from the catalog, which takes no time proportional to their size; their pages are freed by a
+   * later ReclaimDroppedPages() call.
+   * @param table_name The name of the partitioned table
+   * @param position The position of the partition in key order
+   * @return `true` if the partition was dropped
+   */
+  auto DropPartition(const std::string &table_name, size_t position) -> bool {
+    auto *meta = GetPartitionedTable(table_name);
+    if (meta == nullptr || meta->type_ != PartitionType::Range || position >= meta->partitions_.size()) {
+      return false;
+    }
+    auto *child = meta->partitions_[position].table_;
+    meta->partitions_.erase(meta->partitions_.begin() + position);
+    DropChildTable(child);
+    return true;
+  }
+
+  /**
+   * Free the pages of the partitions dropped so far, index pages first; pages in the buffer pool are discarded without
+   * being written back. Call it once the scans that may have been reading those partitions are done. Pages that are
+   * still pinned are kept for the next call.
+   * @return The number of pages still waiting to be freed
+   */
+  auto ReclaimDroppedPages() -> size_t {
+    std::vector<std::unique_ptr<TableInfo>> tables;
+    std::vector<std::unique_ptr<IndexInfo>> indexes;
+    std::vector<page_id_t> page_ids;
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      tables.swap(dropped_tables_);
+      indexes.swap(dropped_indexes_);
+      page_ids.swap(pinned_page_ids_);
+    }
+    for (auto &index_info : indexes) {
+      index_info->index_->Destroy(&page_ids);
+    }
+    for (auto &table_info : tables) {
+      auto heap_page_ids = table_info->table_->GetPageIds();
+      page_ids.insert(page_ids.end(), heap_page_ids.begin(), heap_page_ids.end());
+    }
+    page_ids.erase(std::remove_if(page_ids.begin(), page_ids.end(),
+                                  [this](page_id_t page_id) { return bpm_->DeletePage(page_id); }),
+                   page_ids.end());
+    std::lock_guard<std::mutex> guard(latch_);
+    pinned_page_ids_.insert(pinned_page_ids_.end(), page_ids.begin(), page_ids.end());
+    return pinned_page_ids_.size();
+  }
+
+  /**
+   * Create an index on every partition of a partitioned table, including the partitions added later.
+   * The parameters are the ones of CreateIndex(), except that the schema is the one of the partitioned table.
+   * @return The index on each partition, in partition order, or an empty vector if the table does not exist
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  auto CreatePartitionedIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                              const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
+                              HashFunction<KeyType> hash_function) -> std::vector<IndexInfo *> {
+    std::vector<IndexInfo *> indexes;
+    auto *meta = GetPartitionedTable(table_name);
+    if (meta == nullptr) {
+      return indexes;
+    }
+    auto builder = [this, index_name, key_schema, key_attrs, keysize, hash_function](
+                       Transaction *txn, const std::string &child_name) -> IndexInfo * {
+      auto *child = GetTable(child_name);
+      return CreateIndex<KeyType, ValueType, KeyComparator>(txn, index_name, child_name, child->schema_, key_schema,
+                                                            key_attrs, keysize, hash_function);
+    };
+    for (const auto &partition : meta->partitions_) {
+      indexes.push_back(builder(txn, partition.table_->name_));
+    }
+    meta->index_builders_.emplace_back(std::move(builder));
+    return indexes;
+  }
+
+  /**
+   * Get the partitions of a partitioned table that may hold keys in [lower, upper] (partition pruning).
+   * @param table_name The name of the partitioned table
+   * @param lower The smallest key of interest, `nullptr` if unbounded
+   * @param upper The largest key of interest, `nullptr` if unbounded
+   * @return The child tables to scan, in partition order
+   */
+  auto GetPartitions(const std::string &table_name, const Value *lower = nullptr, const Value *upper = nullptr)
+      -> std::vector<TableInfo *> {
+    auto *meta = GetPartitionedTable(table_name);
+    return meta == nullptr ? std::vector<TableInfo *>{} : meta->Prune(lower, upper);
+  }
+
+  /**
+   * Get the index `index_name` of the partitions that may hold keys in [lower, upper].
+   * @param index_name The name of the index, as passed to CreatePartitionedIndex()
+   * @param table_name The name of the partitioned table
+   * @param lower The smallest key of interest, `nullptr` if unbounded
+   * @param upper The largest key of interest, `nullptr` if unbounded
+   * @return The per-partition indexes to probe, in partition order
+   */
+  auto GetPartitionIndexes(const std::string &index_name, const std::string &table_name,
+                           const Value *lower = nullptr, const Value *upper = nullptr) -> std::vector<IndexInfo *> {
+    std::vector<IndexInfo *> indexes;
+    for (auto *child : GetPartitions(table_name, lower, upper)) {
+      auto *index = GetIndex(index_name, child->name_);
+      if (index != NULL_INDEX_INFO) {
+        indexes.push_back(index);
+      }
+    }
+    return indexes;
+  }
+
+  /**
+   * Rewrite a table in the key order of one of its indexes (CLUSTER) and repoint all of its indexes. Runs online
+   * except for a short final phase that blocks writers; see TableClusterer for the details and preconditions.
+   * @param txn The transaction performing the rewrite
+   * @param table_name The name of the table
+   * @param index_name The name of the index whose order the table should take
+   * @param options The catch-up knobs
+   * @return `true` if the table was rewritten, `false` if the table or index does not exist
+   */
+  auto ClusterTable(Transaction *txn, const std::string &table_name, const std::string &index_name,
+                    const ClusterOptions &options = {}) -> bool {
+    auto *table_info = GetTable(table_name);
+    auto *index_info = GetIndex(index_name, table_name);
+    if (table_info == NULL_TABLE_INFO || index_info == NULL_INDEX_INFO) {
+      return false;
+    }
+    TableClusterer clusterer(table_info, index_info, GetTableIndexes(table_name), txn);
+    // Scans that started before the swap may still be reading the old heap, so it is kept rather than freed.
+    std::unique_ptr<TableHeap> old_heap = clusterer.Run(options);
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      retired_tables_.push_back(std::move(old_heap));
+    }
+    // The statistics describe the old heap's counters; the next GetTableStats() call re-analyzes.
+    std::atomic_store(&table_info->stats_, std::shared_ptr<const TableStats>{});
+    return true;
+  }
+
   /**
    * Create a new index, populate existing data of the table and return its metadata.
    * @param txn The transaction in which the table is being created
@@ -186,12 +579,18 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The data structure of the index
+   * @param build_options How the index is built from the existing rows
+   * @param include_attrs Columns to store in the index entries besides the key (a covering index); only B+ tree
+   * indexes whose key columns and included columns can be normalized (see GenericKey) support them
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::ExtendibleHash,
+                   const BulkLoadOptions &build_options = {}, const std::vector<uint32_t> &include_attrs = {})
+      -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -208,20 +607,111 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, include_attrs);
 
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
+    // The entries of a covering index hold the included columns behind the key columns.
+    const Schema entry_schema = include_attrs.empty() ? key_schema : *meta->GetKeySchema();
+    const std::vector<uint32_t> entry_attrs = meta->GetKeyAttrs();
+    if (!include_attrs.empty() &&
+        (index_type != IndexType::BPlusTree || !KeyComparator(meta->GetKeySchema()).IsNormalized())) {
+      return NULL_INDEX_INFO;
+    }
 
-    // Populate the index with all tuples in table heap
+    // Construct the index, take ownership of metadata, and populate it with all tuples in table heap. Worker threads
+    // scan ranges of the table's pages; the catalog itself is only updated once the index is complete.
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    auto page_ids = heap->GetPageIds();
+    size_t num_workers =
+        build_options.num_workers_ != 0 ? build_options.num_workers_ : std::thread::hardware_concurrency();
+    num_workers = std::max<size_t>(1, std::min(num_workers, page_ids.size() / MIN_BUILD_PAGES_PER_WORKER));
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::BPlusTree) {
+      // Sort the keys first and build the tree bottom-up rather than inserting the rows one by one. Each worker sorts
+      // its rows into runs of its own, which are merged on the way into BulkLoad().
+      auto tree = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                      GetIndexHeaderPage());
+      KeyComparator comparator(tree->GetKeySchema());
+      ExternalSort<KeyType, ValueType, KeyComparator> sorter(bpm_, comparator, build_options.sort_buffer_pages_);
+      std::vector<std::unique_ptr<ExternalSort<KeyType, ValueType, KeyComparator>>> worker_sorters;
+      for (size_t w = 0; num_workers > 1 && w < num_workers; w++) {
+        worker_sorters.push_back(std::make_unique<ExternalSort<KeyType, ValueType, KeyComparator>>(
+            bpm_, comparator, build_options.sort_buffer_pages_ / num_workers));
+      }
+      ScanPageRanges(
+          heap, page_ids, num_workers, txn,
+          [&](size_t worker, Transaction *worker_txn, Tuple *tuple, const RID &rid) {
+            KeyType key;
+            key.SetFromKey(tuple->KeyFromTuple(schema, entry_schema, entry_attrs), tree->GetKeySchema(),
+                           comparator.IsNormalized());
+            (num_workers > 1 ? worker_sorters[worker].get() : &sorter)->Add(key, rid);
+          },
+          [&](size_t worker) {
+            if (num_workers > 1) {
+              worker_sorters[worker]->Flush();
+            }
+          });
+      for (auto &worker_sorter : worker_sorters) {
+        sorter.AdoptRuns(worker_sorter.get());
+      }
+      sorter.Sort();
+      tree->BulkLoad(&sorter, build_options.fill_factor_);
+      index = std::move(tree);
+    } else {
+      if (index_type == IndexType::BLinkTree) {
+        index = std::make_unique<BLinkTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                    GetIndexHeaderPage());
+      } else if (index_type == IndexType::AdaptiveRadixTree) {
+        index = std::make_unique<AdaptiveRadixTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta));
+      } else if (index_type == IndexType::LsmTree) {
+        index = std::make_unique<LsmTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      } else if (index_type == IndexType::BwTree) {
+        index = std::make_unique<BwTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      } else {
+        index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                              hash_function);
+      }
+      auto insert = [&](size_t worker, Transaction *worker_txn, Tuple *tuple, const RID &rid) {
+        index->InsertEntry(tuple->KeyFromTuple(schema, entry_schema, entry_attrs), rid, worker_txn);
+      };
+      if (index_type != IndexType::ExtendibleHash || num_workers == 1) {
+        // All but the hash table take concurrent inserts as they come.
+        ScanPageRanges(heap, page_ids, num_workers, txn, insert);
+      } else {
+        // The workers partition their entries by the low bits of the hash, which pick the directory entry, and then
+        // insert one partition each at a time: the partitions fill disjoint buckets once the directory is deep
+        // enough, so the inserting threads rarely wait on the same bucket.
+        size_t num_partitions = 1;
+        while (num_partitions < num_workers) {
+          num_partitions *= 2;
+        }
+        std::vector<std::vector<std::vector<std::pair<Tuple, RID>>>> partitions(
+            num_workers, std::vector<std::vector<std::pair<Tuple, RID>>>(num_partitions));
+        const bool normalized = KeyComparator(index->GetKeySchema()).IsNormalized();
+        ScanPageRanges(heap, page_ids, num_workers, txn,
+                       [&](size_t worker, Transaction *worker_txn, Tuple *tuple, const RID &rid) {
+                         Tuple entry = tuple->KeyFromTuple(schema, entry_schema, entry_attrs);
+                         KeyType key;
+                         key.SetFromKey(entry, index->GetKeySchema(), normalized);
+                         size_t partition = hash_function.GetHash(key) & (num_partitions - 1);
+                         partitions[worker][partition].emplace_back(std::move(entry), rid);
+                       });
+        RunWorkers(num_workers, txn, [&](size_t worker, Transaction *worker_txn) {
+          for (size_t partition = worker; partition < num_partitions; partition += num_workers) {
+            for (auto &worker_partitions : partitions) {
+              for (const auto &[entry, rid] : worker_partitions[partition]) {
+                index->InsertEntry(entry, rid, worker_txn);
+              }
+              worker_partitions[partition].clear();
+              worker_partitions[partition].shrink_to_fit();
+            }
+          }
+        });
+      }
+    }
+
+    if (build_options.bloom_filter_bits_per_key_ != 0) {
+      index->EnableBloomFilter(bpm_, build_options.bloom_filter_bits_per_key_);
     }
 
     // Get the next OID for the new index
@@ -229,7 +719,7 @@ class Catalog {
 
     // Construct index information; IndexInfo takes ownership of the Index itself
     auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+        std::make_unique<IndexInfo>(entry_schema, index_name, std::move(index), index_oid, table_name, keysize);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -323,6 +813,146 @@ class Catalog {
   }
 
  private:
+  /** The page recording the roots of the tree indexes, allocated on first use. */
+  auto GetIndexHeaderPage() -> page_id_t {
+    if (index_header_page_id_ == INVALID_PAGE_ID) {
+      auto *page = static_cast<HeaderPage *>(bpm_->NewPage(&index_header_page_id_));
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate the index header page.");
+      }
+      page->Init();
+      bpm_->UnpinPage(index_header_page_id_, true);
+    }
+    return index_header_page_id_;
+  }
+
+  /**
+   * Call fn(worker, worker_txn, tuple, rid) for every tuple on the given pages of the heap, from num_workers threads
+   * that each scan a contiguous range of the pages, and then finish(worker) on each thread once its range is done. The
+   * tuples are read, and their locks taken, on behalf of worker_txn; see RunWorkers(). A single worker runs on the
+   * calling thread.
+   */
+  static void ScanPageRanges(TableHeap *heap, const std::vector<page_id_t> &page_ids, size_t num_workers,
+                             Transaction *txn,
+                             const std::function<void(size_t, Transaction *, Tuple *, const RID &)> &fn,
+                             const std::function<void(size_t)> &finish = nullptr) {
+    auto scan = [&](size_t worker, Transaction *worker_txn) {
+      auto *bpm = heap->GetBufferPoolManager();
+      Tuple tuple;
+      for (size_t i = worker * page_ids.size() / num_workers; i < (worker + 1) * page_ids.size() / num_workers; i++) {
+        auto *page = static_cast<TablePage *>(bpm->FetchPage(page_ids[i]));
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a table page.");
+        }
+        page->RLatch();
+        RID rid;
+        for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+          if (page->GetTuple(rid, &tuple, worker_txn, heap->GetLockManager())) {
+            fn(worker, worker_txn, &tuple, rid);
+          }
+        }
+        page->RUnlatch();
+        bpm->UnpinPage(page_ids[i], false);
+      }
+      if (finish) {
+        finish(worker);
+      }
+    };
+    RunWorkers(num_workers, txn, scan);
+  }
+
+  /**
+   * Call fn(worker, worker_txn) for every worker below num_workers, each on a thread of its own (a single worker runs
+   * on the calling thread, with txn itself), and wait for all of them. The first exception thrown by a worker is
+   * rethrown.
+   *
+   * A transaction is not safe to share between threads, so each thread works for a transaction of its own with the
+   * id of txn, which the lock manager takes for txn. Once all are done, the locks they took move into the lock sets
+   * of txn, to be released when txn ends, and txn is aborted if any of them was.
+   */
+  static void RunWorkers(size_t num_workers, Transaction *txn, const std::function<void(size_t, Transaction *)> &fn) {
+    if (num_workers == 1) {
+      fn(0, txn);
+      return;
+    }
+    std::vector<std::unique_ptr<Transaction>> worker_txns;
+    for (size_t w = 0; txn != nullptr && w < num_workers; w++) {
+      worker_txns.push_back(std::make_unique<Transaction>(txn->GetTransactionId(), txn->GetIsolationLevel()));
+    }
+    std::vector<std::exception_ptr> errors(num_workers);
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < num_workers; w++) {
+      workers.emplace_back([&, w] {
+        try {
+          fn(w, txn != nullptr ? worker_txns[w].get() : nullptr);
+        } catch (...) {
+          errors[w] = std::current_exception();
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (auto &worker_txn : worker_txns) {
+      txn->GetSharedLockSet()->insert(worker_txn->GetSharedLockSet()->begin(), worker_txn->GetSharedLockSet()->end());
+      txn->GetExclusiveLockSet()->insert(worker_txn->GetExclusiveLockSet()->begin(),
+                                         worker_txn->GetExclusiveLockSet()->end());
+      if (worker_txn->GetState() == TransactionState::ABORTED) {
+        txn->SetState(TransactionState::ABORTED);
+      }
+    }
+    for (auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  /** Register an empty partitioned table, or return `nullptr` if the name is taken. */
+  auto NewPartitionedTable(const std::string &table_name, const Schema &schema, PartitionType type,
+                           uint32_t key_column) -> PartitionedTableInfo * {
+    if (table_names_.count(table_name) != 0 || partitioned_tables_.count(table_name) != 0) {
+      return nullptr;
+    }
+    auto meta = std::make_unique<PartitionedTableInfo>(schema, table_name, type, key_column);
+    auto *tmp = meta.get();
+    partitioned_tables_.emplace(table_name, std::move(meta));
+    return tmp;
+  }
+
+  /** Create the child table of a new last partition, with every index of the partitioned table. */
+  auto AddPartition(Transaction *txn, PartitionedTableInfo *meta, const Value &lower, const Value &upper)
+      -> TableInfo * {
+    auto child_name = meta->name_ + "$" + std::to_string(meta->next_partition_id_++);
+    auto *child = CreateTable(txn, child_name, meta->schema_);
+    BUSTUB_ASSERT(child != NULL_TABLE_INFO, "Partition names are never reused.");
+    meta->partitions_.push_back(PartitionInfo{child, lower, upper});
+    for (const auto &builder : meta->index_builders_) {
+      builder(txn, child_name);
+    }
+    return child;
+  }
+
+  /** Move a partition's child table and its indexes out of the catalog, to have their pages freed later. */
+  void DropChildTable(TableInfo *child) {
+    std::vector<std::unique_ptr<IndexInfo>> indexes;
+    auto table_indexes = index_names_.find(child->name_);
+    for (const auto &index : table_indexes->second) {
+      auto index_info = indexes_.find(index.second);
+      indexes.push_back(std::move(index_info->second));
+      indexes_.erase(index_info);
+    }
+    index_names_.erase(table_indexes);
+    auto table_info = tables_.find(child->oid_);
+    std::unique_ptr<TableInfo> table = std::move(table_info->second);
+    tables_.erase(table_info);
+    table_names_.erase(child->name_);
+
+    std::lock_guard<std::mutex> guard(latch_);
+    std::move(indexes.begin(), indexes.end(), std::back_inserter(dropped_indexes_));
+    dropped_tables_.push_back(std::move(table));
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -352,6 +982,24 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** Map partitioned table name -> partitioned table metadata. The child tables live in `tables_`. */
+  std::unordered_map<std::string, std::unique_ptr<PartitionedTableInfo>> partitioned_tables_;
+
+  /** Guards `retired_tables_` and the dropped partitions below. */
+  std::mutex latch_;
+
+  /** Heaps replaced by ClusterTable(), kept alive for the scans that may still be reading them. */
+  std::vector<std::unique_ptr<TableHeap>> retired_tables_;
+
+  /** Child tables and indexes of dropped partitions whose pages ReclaimDroppedPages() has not freed yet. */
+  std::vector<std::unique_ptr<TableInfo>> dropped_tables_;
+  std::vector<std::unique_ptr<IndexInfo>> dropped_indexes_;
+  /** Pages of dropped partitions that were still pinned when ReclaimDroppedPages() tried to free them. */
+  std::vector<page_id_t> pinned_page_ids_;
+
+  /** The header page of the B+ tree indexes; page 0 may well be a table page. */
+  page_id_t index_header_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_cluster.h
+//
+// Identification: src/include/catalog/table_cluster.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+struct TableInfo;
+struct IndexInfo;
+
+/**
+ * Knobs for the online phase of CLUSTER.
+ */
+struct ClusterOptions {
+  /** Once a catch-up round applies at most this many changes, the rest is applied with writers blocked. */
+  size_t final_catch_up_threshold_{64};
+  /** Upper bound on the number of online catch-up rounds, so a table under heavy write load still finishes. */
+  uint32_t max_catch_up_rounds_{8};
+};
+
+/**
+ * TableClusterer rewrites a table heap in the order of one of its indexes (CLUSTER), so that range scans on the
+ * index key read the heap mostly sequentially.
+ *
+ * The rewrite runs online:
+ *  1. CopyInOrder() starts capturing the RIDs written in the old heap, sorts the live tuples by index key and
+ *     inserts them into a fresh heap, remembering where each old RID went.
+ *  2. CatchUp() replays the captured changes into the new heap. It is repeated while writers keep the table busy.
+ *  3. Finish() blocks writers of the old heap, replays the last changes, repoints every index of the table from the
+ *     old RIDs to the new ones and swaps TableInfo::table_. The last two happen under TableInfo::heap_latch_, so
+ *     that index readers see either the old RIDs and heap or the new ones. The old heap is retired: it stays
+ *     readable for scans that are still running, but every later write to it aborts.
+ *
+ * Rows changed during the rewrite are appended to the new heap, so they are not in index order. Transactions that
+ * wrote to the table must have committed or aborted before Finish(); their write sets still refer to the old heap.
+ */
+class TableClusterer {
+ public:
+  /**
+   * @param table_info the table to rewrite
+   * @param cluster_index the index whose key order the table takes
+   * @param indexes every index of the table, including cluster_index; their RIDs are repointed by Finish()
+   * @param txn the transaction performing the rewrite
+   */
+  TableClusterer(TableInfo *table_info, IndexInfo *cluster_index, std::vector<IndexInfo *> indexes,
+                 Transaction *txn);
+
+  ~TableClusterer();
+
+  DISALLOW_COPY_AND_MOVE(TableClusterer);
+
+  /** Copy the current contents of the table into a fresh heap in index key order. */
+  void CopyInOrder();
+
+  /**
+   * Apply the changes made to the old heap since the last call.
+   * @return the number of changes applied
+   */
+  auto CatchUp() -> size_t;
+
+  /**
+   * Apply the last changes with writers blocked, repoint the indexes and swap the heaps.
+   * @return the retired heap, which the caller must keep alive while scans may still be running on it
+   */
+  auto Finish() -> std::unique_ptr<TableHeap>;
+
+  /**
+   * Run all three phases.
+   * @param options the catch-up knobs
+   * @return the retired heap
+   */
+  auto Run(const ClusterOptions &options) -> std::unique_ptr<TableHeap>;
+
+ private:
+  /** Bring the copy of the row at old_rid in line with the old heap. */
+  void ApplyChange(const RID &old_rid);
+
+  TableInfo *table_info_;
+  IndexInfo *cluster_index_;
+  std::vector<IndexInfo *> indexes_;
+  Transaction *txn_;
+  TableHeap *old_heap_;
+  std::unique_ptr<TableHeap> new_heap_;
+  /** Old RID -> RID of its copy in the new heap, for every live row copied so far. */
+  std::unordered_map<RID, RID> moved_;
+  bool finished_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_stats.h
+//
+// Identification: src/include/catalog/table_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/table_heap.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Knobs for a single ANALYZE run.
+ */
+struct AnalyzeOptions {
+  /**
+   * Number of pages to sample, spread evenly over the table. 0 means scan every page. The default bounds the cost of
+   * the re-analysis that Catalog::GetTableStats() runs on the query path, whatever the size of the table.
+   */
+  uint32_t sample_pages_{256};
+  /** Number of equi-depth histogram buckets per column. */
+  uint32_t histogram_buckets_{32};
+  /** Upper bound on the number of values per column kept to build a histogram. */
+  uint32_t histogram_sample_size_{30000};
+  /** Number of worker threads; each one summarizes a contiguous range of the sampled pages. 0 means one per core. */
+  uint32_t num_workers_{0};
+};
+
+/**
+ * ColumnStats summarizes the value distribution of a single column.
+ */
+class ColumnStats {
+ public:
+  ColumnStats(TypeId type, double null_fraction, uint64_t distinct_count, std::vector<Value> histogram_bounds)
+      : type_(type),
+        null_fraction_(null_fraction),
+        distinct_count_(distinct_count),
+        histogram_bounds_(std::move(histogram_bounds)) {}
+
+  /** @return the type of the column */
+  auto GetType() const -> TypeId { return type_; }
+
+  /** @return the fraction of rows whose value is NULL */
+  auto GetNullFraction() const -> double { return null_fraction_; }
+
+  /** @return the estimated number of distinct non-NULL values */
+  auto GetDistinctCount() const -> uint64_t { return distinct_count_; }
+
+  /**
+   * @return the equi-depth histogram bounds: bucket i covers [bounds[i], bounds[i + 1]] and holds about the same
+   * number of rows as every other bucket. Empty if the column had no non-NULL values.
+   */
+  auto GetHistogramBounds() const -> const std::vector<Value> & { return histogram_bounds_; }
+
+  /** @return the estimated fraction of rows equal to value */
+  auto EstimateEqualSelectivity(const Value &value) const -> double;
+
+  /** @return the estimated fraction of rows strictly less than value */
+  auto EstimateLessThanSelectivity(const Value &value) const -> double;
+
+ private:
+  TypeId type_;
+  double null_fraction_;
+  uint64_t distinct_count_;
+  std::vector<Value> histogram_bounds_;
+};
+
+/**
+ * TableStats holds the result of an ANALYZE run over a TableHeap: row and page counts plus one ColumnStats per
+ * column. The row count is kept current between runs from the heap's insert/delete counters, so a fresh ANALYZE is
+ * only needed once the distribution itself may have drifted (see IsStale()).
+ */
+class TableStats {
+ public:
+  /**
+   * Build statistics for a table by sampling its pages in parallel. Safe to run while the table is being modified;
+   * each page is read under its read latch.
+   * @param heap the table to analyze
+   * @param schema the schema of the table
+   * @param options sampling knobs
+   * @param txn the transaction performing the read
+   * @return the collected statistics
+   */
+  static auto Analyze(TableHeap *heap, const Schema &schema, const AnalyzeOptions &options, Transaction *txn)
+      -> std::unique_ptr<TableStats>;
+
+  /** @return the number of rows at analyze time adjusted by the inserts and deletes made since then */
+  auto GetEstimatedRowCount(const TableHeap *heap) const -> uint64_t;
+
+  /**
+   * @param heap the table these statistics describe
+   * @param threshold fraction of the analyzed row count that may change before the statistics go stale
+   * @return true if more than threshold of the table was modified since the statistics were collected
+   */
+  auto IsStale(const TableHeap *heap, double threshold) const -> bool;
+
+  /** @return the estimated number of rows at analyze time */
+  auto GetRowCount() const -> uint64_t { return row_count_; }
+
+  /** @return the number of pages in the table at analyze time */
+  auto GetPageCount() const -> uint64_t { return page_count_; }
+
+  /** @return the number of pages actually read */
+  auto GetSampledPageCount() const -> uint64_t { return sampled_page_count_; }
+
+  /** @return the statistics of column col_idx */
+  auto GetColumnStats(uint32_t col_idx) const -> const ColumnStats & { return column_stats_[col_idx]; }
+
+ private:
+  TableStats() = default;
+
+  uint64_t row_count_{0};
+  uint64_t page_count_{0};
+  uint64_t sampled_page_count_{0};
+  /** Heap counters at analyze time; GetEstimatedRowCount() applies the delta since then. */
+  uint64_t insert_count_{0};
+  uint64_t delete_count_{0};
+  std::vector<ColumnStats> column_stats_;
+};
+
+}  // namespace bustub
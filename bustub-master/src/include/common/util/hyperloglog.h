@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hyperloglog.h
+//
+// Identification: src/include/common/util/hyperloglog.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+/**
+ * HyperLogLog estimates the number of distinct hashes it has seen using 2^precision one-byte registers.
+ * The standard error is about 1.04 / sqrt(2^precision), i.e. ~1.6% for the default precision of 12 (4KB).
+ * Sketches with the same precision can be merged, which lets page ranges be summarized independently.
+ */
+class HyperLogLog {
+ public:
+  /** Smallest and largest supported register-index widths. */
+  static constexpr uint32_t MIN_PRECISION = 4;
+  static constexpr uint32_t MAX_PRECISION = 16;
+
+  /**
+   * Create an empty sketch.
+   * @param precision number of hash bits used to pick a register
+   */
+  explicit HyperLogLog(uint32_t precision = 12) : precision_(precision), registers_(1U << precision, 0) {
+    BUSTUB_ASSERT(precision >= MIN_PRECISION && precision <= MAX_PRECISION, "Unsupported HyperLogLog precision.");
+  }
+
+  /**
+   * Add a hash to the sketch. The hash is re-mixed first, so weak hashes such as HashUtil::HashValue are fine.
+   * @param hash the hash of the element
+   */
+  void AddHash(uint64_t hash) {
+    hash = HashUtil::MixHash(hash);
+    auto index = static_cast<uint32_t>(hash >> (64 - precision_));
+    // Rank of the first set bit in the remaining bits; the sentinel bit bounds it by 64 - precision + 1.
+    uint64_t rest = (hash << precision_) | (1ULL << (precision_ - 1));
+    auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+  }
+
+  /**
+   * Fold another sketch into this one.
+   * @param other a sketch with the same precision
+   */
+  void Merge(const HyperLogLog &other) {
+    BUSTUB_ASSERT(precision_ == other.precision_, "Cannot merge sketches of different precision.");
+    for (size_t i = 0; i < registers_.size(); i++) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  /** @return the estimated number of distinct hashes added so far */
+  auto Estimate() const -> uint64_t {
+    const auto m = static_cast<double>(registers_.size());
+    double sum = 0;
+    uint32_t zeros = 0;
+    for (auto reg : registers_) {
+      sum += std::ldexp(1.0, -static_cast<int>(reg));
+      zeros += reg == 0 ? 1 : 0;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // Small-range correction: fall back to linear counting while many registers are still empty.
+    if (estimate <= 2.5 * m && zeros != 0) {
+      estimate = m * std::log(m / zeros);
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+  }
+
+  /** @return the register-index width of this sketch */
+  auto GetPrecision() const -> uint32_t { return precision_; }
+
+ private:
+  uint32_t precision_;
+  std::vector<uint8_t> registers_;
+};
+
+}  // namespace bustub
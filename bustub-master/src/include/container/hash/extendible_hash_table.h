@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <queue>
 #include <string>
 #include <vector>
@@ -30,12 +33,38 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Lookups, inserts and removes take the table latch shared and latch only their bucket page, so operations on
+ * different buckets run in parallel. The directory changes only under the table latch held exclusively, by splits
+ * and merges; an operation that finds it needs one gives up its latches and takes the exclusive latch, then checks
+ * again whether the split or merge is still due. The directory page itself stays pinned, so that operations need
+ * only fetch their bucket.
+ *
+ * Beyond DIRECTORY_ARRAY_SIZE entries the directory becomes a radix tree of directory pages under that pinned head.
+ * Every page below the head resolves DIRECTORY_LEVEL_DEPTH bits of the directory index, the lowest bits in the
+ * leaves, and the head the 1 to DIRECTORY_LEVEL_DEPTH bits left on top; a lookup thus fetches one directory leaf up
+ * to a global depth of 2 * DIRECTORY_LEVEL_DEPTH, one more page for every further DIRECTORY_LEVEL_DEPTH bits. Doubling
+ * the directory copies the subtrees below the head into its new upper half, pushing the head's entries down into a
+ * new page first when the head is full; shrinking it drops that half again and pulls a lone subtree up into the head.
+ * Splits and merges update only the 2^(GD - LD) entries of the bucket, and the head counts the buckets of every local
+ * depth, so that no operation needs to go through the whole directory.
+ *
+ * Up to a global depth of DIRECTORY_CACHE_DEPTH, the bucket page_ids of the directory are also kept in memory, in
+ * chunks of DIRECTORY_ARRAY_SIZE entries that mirror the directory leaves, so that lookups, inserts and removes fetch
+ * their bucket and no directory page. Splits and merges update that copy along with the pages, and bump
+ * directory_version_ to an odd value before they change anything and to the next even value once they are done.
+ * GetValue reads the copy without the table latch: it latches the bucket it found and only probes it if the version
+ * is still the even one it started from, and otherwise falls back to the table latch. Splits therefore latch the
+ * buckets they write. A bucket that a merge drops while such a lookup still has it pinned cannot be deleted yet; it
+ * is kept in dropped_pages_ and deleted by a later merge; so is a directory page that is still pinned when the
+ * directory shrinks. Destroy() hands the ones left over to its caller.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
  public:
   /**
-   * Creates a new ExtendibleHashTable.
+   * Creates a new ExtendibleHashTable. The table keeps its directory page pinned and unpins it when it is destroyed,
+   * so the buffer pool manager has to outlive the table.
    *
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
@@ -44,6 +73,9 @@ class ExtendibleHashTable {
   explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
 
+  /** Releases the pin on the directory page, unless Destroy() already deleted it. */
+  ~ExtendibleHashTable();
+
   /**
    * Inserts a key-value pair into the hash table.
    *
@@ -74,6 +106,30 @@ class ExtendibleHashTable {
    */
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
+  /**
+   * Performs a batch of point queries on the hash table, sharing the bucket fetches between keys that hash to the
+   * same bucket.
+   *
+   * @param transaction the current transaction
+   * @param keys the keys to look up
+   * @param[out] results (*results)[i] receives the value(s) associated with keys[i]
+   */
+  void GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                 std::vector<std::vector<ValueType>> *results);
+
+  /**
+   * Calls fn with the key of every pair in the hash table, bucket by bucket.
+   *
+   * @param fn the function to call
+   */
+  void ForEachKey(const std::function<void(const KeyType &)> &fn);
+
+  /**
+   * Deletes every page of the hash table, which must not be used afterwards.
+   * @param[out] pinned_page_ids the pages that are still pinned and were not deleted, for the caller to delete later
+   */
+  void Destroy(std::vector<page_id_t> *pinned_page_ids);
+
   /**
    * Returns the global depth.  Do not touch.
    */
@@ -84,7 +140,20 @@ class ExtendibleHashTable {
    */
   void VerifyIntegrity();
 
+  /**
+   * Verifies the directory like VerifyIntegrity(), over every page of a directory that spans several levels, and
+   * checks the bucket counts kept in the head page.
+   */
+  void VerifyDirectoryTree();
+
  private:
+  /** How many buckets a batch lookup fetches and prefetches into the cache before it probes any of them. */
+  static constexpr size_t BATCH_GROUP_SIZE = 8;
+
+  /** The global depth up to which the bucket page_ids of the directory are kept in memory, see the class comment. */
+  static constexpr uint32_t DIRECTORY_CACHE_DEPTH = 2 * DIRECTORY_LEVEL_DEPTH;
+  static constexpr size_t DIRECTORY_CACHE_CHUNKS = size_t{1} << (DIRECTORY_CACHE_DEPTH - DIRECTORY_LEVEL_DEPTH);
+
   /**
    * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
    * for extendible hashing.
@@ -112,6 +181,23 @@ class ExtendibleHashTable {
    */
   inline auto KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t;
 
+  /**
+   * Maps a full hash to a directory index, like KeyToDirectoryIndex does for the hash of a key.
+   *
+   * @param hash the 64-bit hash of the key
+   * @param dir_page to use for lookup of global depth
+   * @return the directory index
+   */
+  inline auto HashToDirectoryIndex(uint64_t hash, HashTableDirectoryPage *dir_page) -> uint32_t;
+
+  /**
+   * Takes the tag of a key within its bucket from the top byte of its hash, which the directory never uses.
+   *
+   * @param hash the 64-bit hash of the key
+   * @return the tag of the key
+   */
+  inline auto HashToTag(uint64_t hash) -> uint8_t;
+
   /**
    * Get the bucket page_id corresponding to a key.
    *
@@ -128,6 +214,162 @@ class ExtendibleHashTable {
    */
   auto FetchDirectoryPage() -> HashTableDirectoryPage *;
 
+  /**
+   * @param dir_page the head of the directory
+   * @return the number of directory page levels below the head, 0 while the head holds the whole directory
+   */
+  inline auto DirectoryLevels(HashTableDirectoryPage *dir_page) -> uint32_t;
+
+  /**
+   * Fetches a directory page below the head from the buffer pool manager.
+   *
+   * @param page_id the page_id to fetch
+   * @return a pointer to the directory page
+   */
+  auto FetchDirectoryTreePage(page_id_t page_id) -> HashTableDirectoryPage *;
+
+  /**
+   * Allocates a directory page to go below the head from the buffer pool manager.
+   *
+   * @param[out] page_id the page_id of the new page
+   * @return a pointer to the new directory page, pinned
+   */
+  auto NewDirectoryTreePage(page_id_t *page_id) -> HashTableDirectoryPage *;
+
+  /**
+   * Finds the directory page that holds the entry of a directory index.
+   *
+   * @param dir_page the head of the directory
+   * @param directory_idx the directory index
+   * @return the head, or the pinned leaf that holds the entry at slot directory_idx % DIRECTORY_ARRAY_SIZE
+   */
+  auto FetchDirectoryLeaf(HashTableDirectoryPage *dir_page, uint32_t directory_idx) -> HashTableDirectoryPage *;
+
+  /**
+   * Unpins a page returned by FetchDirectoryLeaf.
+   *
+   * @param dir_page the head of the directory
+   * @param leaf_page the page returned by FetchDirectoryLeaf
+   * @param is_dirty whether entries of the page were changed
+   */
+  void ReleaseDirectoryLeaf(HashTableDirectoryPage *dir_page, HashTableDirectoryPage *leaf_page, bool is_dirty);
+
+  /**
+   * Looks up the entry of a directory index.
+   *
+   * @param dir_page the head of the directory
+   * @param directory_idx the directory index
+   * @param[out] local_depth if not null, the local depth of the bucket
+   * @return the page_id of the bucket
+   */
+  auto LookupBucket(HashTableDirectoryPage *dir_page, uint32_t directory_idx, uint32_t *local_depth = nullptr)
+      -> page_id_t;
+
+  /**
+   * @param directory_idx a directory index below 2^DIRECTORY_CACHE_DEPTH
+   * @return the in-memory copy of the bucket page_id of the entry
+   */
+  auto CachedBucket(uint32_t directory_idx) -> std::atomic<page_id_t> & {
+    return directory_cache_[directory_idx / DIRECTORY_ARRAY_SIZE][directory_idx % DIRECTORY_ARRAY_SIZE];
+  }
+
+  /**
+   * Looks up the bucket of a directory index in the in-memory copy of the directory, or in the directory pages once
+   * the directory is deeper than the copy. Needs the table latch.
+   *
+   * @param dir_page the head of the directory
+   * @param directory_idx the directory index
+   * @return the page_id of the bucket
+   */
+  auto LookupCachedBucket(HashTableDirectoryPage *dir_page, uint32_t directory_idx) -> page_id_t;
+
+  /**
+   * Sets the bucket of a directory entry in the in-memory copy of the directory, if the copy covers the directory.
+   * Needs the table latch held exclusively, between BeginDirectoryChange and EndDirectoryChange.
+   *
+   * @param directory_idx the directory index
+   * @param bucket_page_id the page_id of the bucket
+   */
+  void CacheBucket(uint64_t directory_idx, page_id_t bucket_page_id);
+
+  /**
+   * Brings the in-memory copy of the directory to the global depth of the head, after the directory grew or shrank:
+   * the upper half of a grown copy points to the same buckets as the lower one, and a copy that covers the directory
+   * again after it was deeper is read from the pages.
+   *
+   * @param dir_page the head of the directory
+   * @param old_depth the global depth before the directory grew or shrank
+   */
+  void ResizeDirectoryCache(HashTableDirectoryPage *dir_page, uint32_t old_depth);
+
+  /** Makes directory_version_ odd, before a split or merge changes the directory or a bucket. */
+  void BeginDirectoryChange();
+
+  /** Makes directory_version_ even again once the split or merge is done. */
+  void EndDirectoryChange();
+
+  /**
+   * Looks a key up through the in-memory copy of the directory without the table latch.
+   *
+   * @param key the key to look up
+   * @param hash the hash of the key
+   * @param[out] result the value(s) associated with the key
+   * @param[out] found whether any value was found
+   * @return false if the directory changed meanwhile or is deeper than the copy, and the key was not looked up
+   */
+  auto OptimisticGetValue(const KeyType &key, uint64_t hash, std::vector<ValueType> *result, bool *found) -> bool;
+
+  /**
+   * Calls fn for every directory entry whose index has the given low bits, leaf by leaf. These are the entries of
+   * one bucket, if local_depth is its local depth.
+   *
+   * @param dir_page the head of the directory
+   * @param base the low bits, less than 2^local_depth
+   * @param local_depth the number of low bits
+   * @param is_dirty whether fn changes the entries
+   * @param fn called with the page that holds an entry, the slot of the entry in it and its directory index
+   */
+  void ForEachEntry(HashTableDirectoryPage *dir_page, uint32_t base, uint32_t local_depth, bool is_dirty,
+                    const std::function<void(HashTableDirectoryPage *, uint32_t, uint64_t)> &fn);
+
+  /**
+   * Doubles the directory, whose upper half then points to the same buckets as the lower one.
+   *
+   * @param dir_page the head of the directory
+   */
+  void GrowDirectory(HashTableDirectoryPage *dir_page);
+
+  /**
+   * Halves the directory, dropping its upper half.
+   *
+   * @param dir_page the head of the directory
+   */
+  void ShrinkDirectory(HashTableDirectoryPage *dir_page);
+
+  /**
+   * Copies a subtree of directory pages.
+   *
+   * @param page_id the root of the subtree
+   * @param levels the number of levels of the subtree, 1 for a leaf
+   * @return the page_id of the root of the copy
+   */
+  auto CopyDirectoryTree(page_id_t page_id, uint32_t levels) -> page_id_t;
+
+  /**
+   * Deletes a subtree of directory pages.
+   *
+   * @param page_id the root of the subtree
+   * @param levels the number of levels of the subtree, 1 for a leaf
+   */
+  void DeleteDirectoryTree(page_id_t page_id, uint32_t levels);
+
+  /**
+   * Verifies the invariants of VerifyIntegrity over all pages of the directory, and the bucket counts of the head.
+   *
+   * @param dir_page the head of the directory
+   */
+  void VerifyDirectory(HashTableDirectoryPage *dir_page);
+
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
@@ -136,6 +378,20 @@ class ExtendibleHashTable {
    */
   auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
 
+  /**
+   * Allocates an empty bucket page from the buffer pool manager.
+   *
+   * @param[out] bucket_page_id the page_id of the new page
+   * @return a pointer to the new bucket page, pinned
+   */
+  auto NewBucketPage(page_id_t *bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+
+  /**
+   * @param bucket_page a bucket page fetched from the buffer pool manager
+   * @return the page that holds the bucket, for latching it
+   */
+  inline auto BucketToPage(HASH_TABLE_BUCKET_TYPE *bucket_page) -> Page *;
+
   /**
    * Performs insertion with an optional bucket splitting.
    *
@@ -151,23 +407,38 @@ class ExtendibleHashTable {
    * if Remove makes a bucket empty.
    *
    * There are three conditions under which we skip the merge:
-   * 1. The bucket is no longer empty.
+   * 1. Neither the bucket nor its split image is empty.
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
    *
+   * Otherwise the merged bucket is checked again, one level up.
+   *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
    * @param value the value that was removed
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /** Deletes the pages in dropped_pages_ that are no longer pinned. Needs the table latch held exclusively. */
+  void DeleteDroppedPages();
+
   // member variables
   page_id_t directory_page_id_;
+  // the directory page, which stays pinned for as long as the table is used
+  Page *directory_page_{nullptr};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
   // Readers includes inserts and removes, writers are splits and merges
   ReaderWriterLatch table_latch_;
+  // the in-memory copy of the bucket page_ids of the directory; chunks are allocated as the directory grows, and kept
+  std::unique_ptr<std::atomic<page_id_t>[]> directory_cache_[DIRECTORY_CACHE_CHUNKS];
+  // the global depth of the directory, as far as the in-memory copy is concerned
+  std::atomic<uint32_t> cached_depth_{0};
+  // odd while a split or merge is under way, see the class comment
+  std::atomic<uint64_t> directory_version_{0};
+  // buckets and directory pages dropped while still pinned, not deleted yet
+  std::vector<page_id_t> dropped_pages_;
   HashFunction<KeyType> hash_fn_;
 };
 
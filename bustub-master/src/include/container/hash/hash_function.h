@@ -13,19 +13,86 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 #include "murmur3/MurmurHash3.h"
 
 namespace bustub {
 
-template <typename KeyType>
+template <size_t KeySize>
+class GenericKey;
+
+/** The hashing behind the HashFunction specializations for integers and GenericKeys. */
+class FixedWidthHash {
+ public:
+  /** @return the hash of a 64-bit word, mixed by multiplies and xor-shifts (MurmurHash3's 64-bit finalizer) */
+  static inline auto HashWord(uint64_t word) -> uint64_t {
+    word ^= word >> 33;
+    word *= 0xff51afd7ed558ccdULL;
+    word ^= word >> 33;
+    word *= 0xc4ceb9fe1a85ec53ULL;
+    word ^= word >> 33;
+    return word;
+  }
+
+  /**
+   * @return the hash of a key of fixed length, of its 8-byte words up to the last one that is not zero. Keys are
+   * zero-padded, so a short key in a long GenericKey costs little more than in a short one. Two keys of the same
+   * length hash the same words only if they are equal, since the number of words hashed is part of the hash.
+   */
+  static inline auto HashWords(const char *bytes, size_t length) -> uint64_t {
+    size_t end = length / WORD_SIZE;
+    uint64_t tail = 0;
+    memcpy(&tail, bytes + end * WORD_SIZE, length % WORD_SIZE);
+    if (tail == 0) {
+      while (end > 0 && LoadWord(bytes, end - 1) == 0) {
+        end--;
+      }
+    }
+    uint64_t hash = end + (tail != 0 ? 1 : 0);
+    for (size_t i = 0; i < end; i++) {
+      hash = MixWord(hash, LoadWord(bytes, i));
+    }
+    if (tail != 0) {
+      hash = MixWord(hash, tail);
+    }
+    return HashWord(hash);
+  }
+
+ private:
+  static constexpr size_t WORD_SIZE = sizeof(uint64_t);
+
+  static inline auto LoadWord(const char *bytes, size_t index) -> uint64_t {
+    uint64_t word;
+    memcpy(&word, bytes + index * WORD_SIZE, WORD_SIZE);
+    return word;
+  }
+
+  static inline auto MixWord(uint64_t hash, uint64_t word) -> uint64_t {
+    hash = (hash + word) * 0x9e3779b97f4a7c15ULL;
+    return hash ^ (hash >> 32);
+  }
+};
+
+template <typename KeyType, typename Enable = void>
 class HashFunction {
  public:
   /**
    * @param key the key to be hashed
    * @return the hashed value
    */
-  virtual auto GetHash(KeyType key) -> uint64_t {
+  virtual auto GetHash(KeyType key) -> uint64_t { return Hash(key); }
+
+  /** Hash a batch of keys into hashes[0..count). */
+  virtual void GetHashes(const KeyType *keys, size_t count, uint64_t *hashes) {
+    for (size_t i = 0; i < count; i++) {
+      hashes[i] = Hash(keys[i]);
+    }
+  }
+
+ private:
+  static inline auto Hash(const KeyType &key) -> uint64_t {
     uint64_t hash[2];
     murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
                                  reinterpret_cast<void *>(&hash));
@@ -33,4 +100,30 @@ class HashFunction {
   }
 };
 
+/** Integer keys are mixed as a single word rather than run through MurmurHash3 byte by byte. */
+template <typename KeyType>
+class HashFunction<KeyType, std::enable_if_t<std::is_integral_v<KeyType>>> {
+ public:
+  virtual auto GetHash(KeyType key) -> uint64_t { return FixedWidthHash::HashWord(static_cast<uint64_t>(key)); }
+
+  virtual void GetHashes(const KeyType *keys, size_t count, uint64_t *hashes) {
+    for (size_t i = 0; i < count; i++) {
+      hashes[i] = FixedWidthHash::HashWord(static_cast<uint64_t>(keys[i]));
+    }
+  }
+};
+
+/** GenericKeys are hashed a word at a time, up to the end of the key they hold, see FixedWidthHash::HashWords(). */
+template <size_t KeySize>
+class HashFunction<GenericKey<KeySize>> {
+ public:
+  virtual auto GetHash(GenericKey<KeySize> key) -> uint64_t { return FixedWidthHash::HashWords(key.data_, KeySize); }
+
+  virtual void GetHashes(const GenericKey<KeySize> *keys, size_t count, uint64_t *hashes) {
+    for (size_t i = 0; i < count; i++) {
+      hashes[i] = FixedWidthHash::HashWords(keys[i].data_, KeySize);
+    }
+  }
+};
+
 }  // namespace bustub
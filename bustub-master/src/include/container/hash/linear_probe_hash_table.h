@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -32,6 +37,19 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Lookups probe without any latch besides the table latch held shared: a slot is claimed by setting its occupied bit
+ * and published by setting its readable bit, see HashTableBlockPage, and a removed pair leaves a tombstone that is
+ * never reused, so a reader that saw a slot readable always reads a whole pair. Inserts and removes of one key are
+ * serialized by one of a few latches picked by the hash of the key.
+ *
+ * Once more than half of the slots are occupied, tombstones included, the table resizes into a new generation of
+ * blocks: twice as large, or as large again if most pairs were removed. The pairs move over one old block at a time,
+ * each insert and remove moving one block, so that no operation pays for rehashing the whole table. Meanwhile inserts
+ * go into the new generation, and lookups and removes check the old one first and then the new one; a pair is put
+ * into the new generation before it is removed from the old one, so lookups never miss it. The operation that moves
+ * the last block retires the old generation, under the table latch held exclusively. A generation whose block page
+ * ids do not fit into one header page chains as many header pages as it needs.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -47,6 +65,9 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                 const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
 
+  /** Releases the pins on the header pages of the generations in use. */
+  ~LinearProbeHashTable() override;
+
   /**
    * Inserts a key-value pair into the hash table.
    * @param transaction the current transaction
@@ -75,18 +96,134 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. The pairs move over to the new blocks with the
+   * inserts and removes that follow; nothing happens while an earlier resize is still under way.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return current size of the hash table, which is the size after the resize under way, if any
    */
   auto GetSize() -> size_t;
 
+  /**
+   * @return whether pairs are still moving into the blocks of a resize
+   */
+  auto IsResizing() -> bool;
+
  private:
+  /**
+   * The chain of header pages of a generation of blocks, HEADER_ARRAY_SIZE blocks to a page but the last one.
+   */
+  struct Generation {
+    /** @return the number of slots of the generation */
+    auto GetSize() const -> size_t { return header_pages_.front()->GetSize(); }
+
+    /** @return the number of blocks of the generation */
+    auto NumBlocks() const -> size_t {
+      return (header_pages_.size() - 1) * HEADER_ARRAY_SIZE + header_pages_.back()->NumBlocks();
+    }
+
+    /** @return the page id of the block at the given index */
+    auto GetBlockPageId(size_t index) const -> page_id_t {
+      return header_pages_[index / HEADER_ARRAY_SIZE]->GetBlockPageId(index % HEADER_ARRAY_SIZE);
+    }
+
+    std::vector<HashTableHeaderPage *> header_pages_;
+  };
+
+  /**
+   * Allocates a generation of blocks, whose header pages stay pinned for as long as the generation is used.
+   *
+   * @param num_blocks the number of blocks
+   * @return the generation
+   */
+  auto NewGeneration(size_t num_blocks) -> std::unique_ptr<Generation>;
+
+  /**
+   * Deletes the header and block pages of a generation that is no longer used.
+   *
+   * @param generation the generation
+   */
+  void DeleteGeneration(Generation *generation);
+
+  /**
+   * Fetches a block page from the buffer pool manager.
+   *
+   * @param block_page_id the page_id to fetch
+   * @return a pointer to the block page
+   */
+  auto FetchBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
+
+  /**
+   * Walks the occupied slots of a generation from the slot a hash maps to, up to the first unoccupied slot.
+   *
+   * @param generation the generation
+   * @param hash the hash of the key
+   * @param is_dirty whether fn changes the slot it returns true for
+   * @param fn called with the block and the offset of every occupied slot, until it returns true
+   * @return whether fn returned true
+   */
+  auto Probe(Generation *generation, uint64_t hash, bool is_dirty,
+             const std::function<bool(HASH_TABLE_BLOCK_TYPE *, slot_offset_t)> &fn) -> bool;
+
+  /**
+   * Puts a pair into the first unoccupied slot of a generation from the slot the hash of its key maps to.
+   *
+   * @param generation the generation
+   * @param hash the hash of the key
+   * @param key the key to insert
+   * @param value the value to insert
+   * @return false if every slot of the generation is occupied
+   */
+  auto InsertInto(Generation *generation, uint64_t hash, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Removes a pair from a generation.
+   *
+   * @param generation the generation
+   * @param hash the hash of the key
+   * @param key the key to remove
+   * @param value the value to remove
+   * @return whether the pair was there
+   */
+  auto RemoveFrom(Generation *generation, uint64_t hash, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Moves the pairs of the next old block into the new generation, with the table latch held shared.
+   *
+   * @return whether that was the last block, so that the caller should retire the old generation
+   */
+  auto MigrateBlock() -> bool;
+
+  /**
+   * Retires the old generation once all of its blocks moved, taking the table latch exclusively.
+   */
+  void FinishResize();
+
+  /**
+   * Allocates the new generation of a resize, with the table latch held exclusively.
+   *
+   * @param num_slots the number of slots the new generation should have at least
+   */
+  void StartResize(size_t num_slots);
+
+  /**
+   * Starts a resize if too many slots of the table are occupied, taking the table latch exclusively.
+   */
+  void MaybeResize();
+
+  /**
+   * @param hash the hash of a key
+   * @return the latch that serializes inserts and removes of the key
+   */
+  inline auto KeyLatch(uint64_t hash) -> std::mutex &;
+
+  // the number of latches that inserts and removes of different keys spread over
+  static constexpr size_t KEY_LATCH_COUNT = 64;
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
@@ -97,6 +234,17 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  // the generation that lookups check first, and the one a resize moves its pairs into (or nullptr)
+  std::unique_ptr<Generation> generation_;
+  std::unique_ptr<Generation> new_generation_;
+  // the next old block to move, and the number of old blocks moved
+  std::atomic<size_t> next_block_{0};
+  std::atomic<size_t> moved_blocks_{0};
+  // the occupied slots of the generation that takes inserts, and the pairs of the table
+  std::atomic<size_t> num_occupied_{0};
+  std::atomic<size_t> num_pairs_{0};
+  std::array<std::mutex, KEY_LATCH_COUNT> key_latches_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_heap_scan_executor.h
+//
+// Identification: src/include/execution/executors/bitmap_heap_scan_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/bitmap_heap_scan_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * BitmapHeapScanExecutor collects the RIDs matching the plan's keys from the index, sorts them by page and fetches
+ * every heap page once, reading all of its matching slots under a single pin and read latch. When fewer RIDs than
+ * the plan's threshold match, sorting buys nothing and the tuples are fetched one by one in index order instead.
+ */
+class BitmapHeapScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new BitmapHeapScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The bitmap heap scan plan to be executed
+   */
+  BitmapHeapScanExecutor(ExecutorContext *exec_ctx, const BitmapHeapScanPlanNode *plan);
+
+  /** Probe the index and decide how to fetch the matching tuples. */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the scan.
+   * @param[out] tuple The next tuple produced by the scan
+   * @param[out] rid The next tuple RID produced by the scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   * @throws TransactionAbortException if the lock on a row could not be taken; the transaction is aborted
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the scan */
+  auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); }
+
+  /** @return `true` if Init() chose to fetch in page order, `false` if it fetches in index order */
+  auto IsBitmapScan() const -> bool { return bitmap_scan_; }
+
+ private:
+  /**
+   * Lock every matching row of the page holding rids_[cursor_], then read them into page_tuples_ under a single
+   * latch and advance the cursor.
+   */
+  void FetchNextPage();
+
+  /** The bitmap heap scan plan node to be executed */
+  const BitmapHeapScanPlanNode *plan_;
+  /** The table being read */
+  TableInfo *table_info_{nullptr};
+  /** The heap the RIDs were taken for; CLUSTER may have swapped in another since */
+  TableHeap *heap_{nullptr};
+  /** The matching RIDs, deduplicated; sorted by page in a bitmap scan */
+  std::vector<RID> rids_;
+  /** The next entry of rids_ to fetch */
+  size_t cursor_{0};
+  /** Whether the RIDs are fetched in page order */
+  bool bitmap_scan_{false};
+  /** The tuples read from the current page that were not returned yet */
+  std::deque<Tuple> page_tuples_;
+};
+
+}  // namespace bustub
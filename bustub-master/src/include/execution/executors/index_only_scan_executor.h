@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.h
+//
+// Identification: src/include/execution/executors/index_only_scan_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexOnlyScanExecutor produces its tuples from index entries alone and never reads a table page. Entries are kept
+ * in step with the live tuples of the table, so the only visibility check left is the shared lock on the RID that
+ * reading the tuple from the heap would have taken.
+ */
+class IndexOnlyScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new IndexOnlyScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The index-only scan plan to be executed
+   */
+  IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan);
+
+  /** Read the matching entries from the index. */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the scan.
+   * @param[out] tuple The next tuple produced by the scan
+   * @param[out] rid The RID of the table tuple the entry points to
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   * @throws TransactionAbortException if the lock on a row could not be taken; the transaction is aborted
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the scan */
+  auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); }
+
+ private:
+  /** @return whether the index still holds the entry, with the same included columns, for the RID */
+  auto IsStillIndexed(const Tuple &entry, const RID &rid) -> bool;
+
+  /** The index-only scan plan node to be executed */
+  const IndexOnlyScanPlanNode *plan_;
+  /** The index being read */
+  IndexInfo *index_info_{nullptr};
+  /** The table of the index, whose heap latch keeps CLUSTER from repointing the index while it is read */
+  TableInfo *table_info_{nullptr};
+  /** The entries read from the index, in the key schema of the index */
+  std::vector<std::pair<Tuple, RID>> entries_;
+  /** The next entry to return */
+  size_t cursor_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partition_scan_executor.h
+//
+// Identification: src/include/execution/executors/partition_scan_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/partition_scan_plan.h"
+#include "storage/table/table_iterator.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * PartitionScanExecutor reads the partitions of a partitioned table that survive pruning against the plan's key
+ * range, one after the other in partition order, and returns the tuples that satisfy the predicate.
+ */
+class PartitionScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new PartitionScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The partition scan plan to be executed
+   */
+  PartitionScanExecutor(ExecutorContext *exec_ctx, const PartitionScanPlanNode *plan);
+
+  /** Prune the partitions and start at the first one left. */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the scan.
+   * @param[out] tuple The next tuple produced by the scan
+   * @param[out] rid The next tuple RID produced by the scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the scan */
+  auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); }
+
+  /** @return The number of partitions the scan reads, after pruning */
+  auto GetPartitionCount() const -> size_t { return partitions_.size(); }
+
+ private:
+  /** The partition scan plan node to be executed */
+  const PartitionScanPlanNode *plan_;
+  /** The child tables left after pruning */
+  std::vector<TableInfo *> partitions_;
+  /** The entry of partitions_ being read */
+  size_t partition_{0};
+  /** The position in the partition being read, or nullptr before it is started */
+  std::unique_ptr<TableIterator> iter_;
+};
+
+}  // namespace bustub
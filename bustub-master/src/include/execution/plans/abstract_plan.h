@@ -23,6 +23,9 @@ namespace bustub {
 enum class PlanType {
   SeqScan,
   IndexScan,
+  BitmapHeapScan,
+  IndexOnlyScan,
+  PartitionScan,
   Insert,
   Update,
   Delete,
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_heap_scan_plan.h
+//
+// Identification: src/include/execution/plans/bitmap_heap_scan_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * BitmapHeapScanPlanNode looks up a set of keys in an index and reads the matching tuples from the table.
+ * Instead of fetching the heap in index order, the matching RIDs are first sorted by page so that every
+ * heap page is fetched once and all of its matching slots are read together.
+ */
+class BitmapHeapScanPlanNode : public AbstractPlanNode {
+ public:
+  /** Below this many matching RIDs the scan fetches in index order, like a plain index scan. */
+  static constexpr size_t DEFAULT_BITMAP_THRESHOLD = 16;
+
+  /**
+   * Construct a new BitmapHeapScanPlanNode instance.
+   * @param output The output schema of this scan plan node
+   * @param predicate The predicate applied to the fetched tuples, or nullptr
+   * @param index_oid The identifier of the index to probe
+   * @param keys The index keys to look up, laid out in the key schema of the index
+   * @param bitmap_threshold The number of matching RIDs from which the RIDs are sorted by page before fetching
+   */
+  BitmapHeapScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                         std::vector<Tuple> keys, size_t bitmap_threshold = DEFAULT_BITMAP_THRESHOLD)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_{index_oid},
+        keys_{std::move(keys)},
+        bitmap_threshold_{bitmap_threshold} {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::BitmapHeapScan; }
+
+  /** @return The predicate to test tuples against; tuples should only be returned if they evaluate to true */
+  auto GetPredicate() const -> const AbstractExpression * { return predicate_; }
+
+  /** @return The identifier of the index to probe */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  /** @return The index keys to look up */
+  auto GetKeys() const -> const std::vector<Tuple> & { return keys_; }
+
+  /** @return The number of matching RIDs from which the RIDs are sorted by page before fetching */
+  auto GetBitmapThreshold() const -> size_t { return bitmap_threshold_; }
+
+ private:
+  /** The predicate that all returned tuples must satisfy */
+  const AbstractExpression *predicate_;
+  /** The index to probe */
+  index_oid_t index_oid_;
+  /** The keys to look up */
+  std::vector<Tuple> keys_;
+  /** The RID count that switches from index-order fetching to page-order fetching */
+  size_t bitmap_threshold_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_plan.h
+//
+// Identification: src/include/execution/plans/index_only_scan_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexOnlyScanPlanNode answers a query from the entries of an index alone, without reading the table: it may only
+ * refer to the columns the index stores, i.e. its key columns and, for a covering index, its included columns. The
+ * predicate and the output expressions are evaluated against the entries, laid out in the key schema of the index.
+ */
+class IndexOnlyScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new IndexOnlyScanPlanNode instance.
+   * @param output The output schema of this scan plan node, with expressions over the key schema of the index
+   * @param predicate The predicate applied to the index entries, or nullptr
+   * @param index_oid The identifier of the index to scan
+   * @param keys The index keys to look up, laid out in the key schema of the index; empty to scan every entry
+   */
+  IndexOnlyScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                        std::vector<Tuple> keys = {})
+      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_{index_oid}, keys_{std::move(keys)} {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::IndexOnlyScan; }
+
+  /** @return The predicate to test entries against; entries should only be returned if they evaluate to true */
+  auto GetPredicate() const -> const AbstractExpression * { return predicate_; }
+
+  /** @return The identifier of the index to scan */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  /** @return The index keys to look up; empty to scan every entry */
+  auto GetKeys() const -> const std::vector<Tuple> & { return keys_; }
+
+ private:
+  /** The predicate that all returned entries must satisfy */
+  const AbstractExpression *predicate_;
+  /** The index to scan */
+  index_oid_t index_oid_;
+  /** The keys to look up */
+  std::vector<Tuple> keys_;
+};
+
+}  // namespace bustub
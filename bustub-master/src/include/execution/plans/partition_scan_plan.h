@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partition_scan_plan.h
+//
+// Identification: src/include/execution/plans/partition_scan_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * PartitionScanPlanNode scans a partitioned table. Only the partitions that may hold partition keys in the plan's
+ * key range are read (see Catalog::GetPartitions()); the predicate is still applied to every tuple read, so the
+ * range must cover every key the predicate accepts.
+ */
+class PartitionScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new PartitionScanPlanNode instance.
+   * @param output The output schema of this scan plan node
+   * @param predicate The predicate applied to the scanned tuples, or nullptr
+   * @param table_name The name of the partitioned table
+   * @param lower The smallest partition key of interest, or none if unbounded
+   * @param upper The largest partition key of interest, or none if unbounded
+   */
+  PartitionScanPlanNode(const Schema *output, const AbstractExpression *predicate, std::string table_name,
+                        std::optional<Value> lower = std::nullopt, std::optional<Value> upper = std::nullopt)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        table_name_{std::move(table_name)},
+        lower_{std::move(lower)},
+        upper_{std::move(upper)} {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::PartitionScan; }
+
+  /** @return The predicate to test tuples against; tuples should only be returned if they evaluate to true */
+  auto GetPredicate() const -> const AbstractExpression * { return predicate_; }
+
+  /** @return The name of the partitioned table */
+  auto GetTableName() const -> const std::string & { return table_name_; }
+
+  /** @return The smallest partition key of interest, `nullptr` if unbounded */
+  auto GetLower() const -> const Value * { return lower_.has_value() ? &*lower_ : nullptr; }
+
+  /** @return The largest partition key of interest, `nullptr` if unbounded */
+  auto GetUpper() const -> const Value * { return upper_.has_value() ? &*upper_ : nullptr; }
+
+ private:
+  /** The predicate that all returned tuples must satisfy */
+  const AbstractExpression *predicate_;
+  /** The partitioned table to scan */
+  std::string table_name_;
+  /** The bounds of the partition keys of interest */
+  std::optional<Value> lower_;
+  std::optional<Value> upper_;
+};
+
+}  // namespace bustub
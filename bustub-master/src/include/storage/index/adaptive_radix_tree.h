@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+#define ART_TYPE AdaptiveRadixTree<KeyType, ValueType>
+
+/**
+ * An adaptive radix tree (Leis et al.), kept in memory only: nothing of it goes through the buffer pool, so it is
+ * lost with the process and has to be rebuilt from the table. It supports unique keys, like BPlusTree.
+ *
+ * Keys are the KEY_SIZE bytes of KeyType and are ordered byte by byte, which is the order of the key values for
+ * normalized GenericKeys. Each inner node branches on one key byte and comes in four sizes, holding up to 4, 16, 48
+ * or 256 children; a node grows into the next size when it is full and shrinks back when a removal leaves it well
+ * below the smaller size. A node also holds the key bytes that all keys below it share (path compression), and a
+ * key that is alone below a byte is stored as a leaf right there (lazy expansion). Since all keys have the same
+ * length, no key is a prefix of another, and a leaf holds the whole key, which lookups compare at the end.
+ *
+ * Concurrency follows optimistic lock coupling. Every inner node has a version with a lock bit and an obsolete bit.
+ * Readers latch nothing: they read a node's version, read the node, and check that the version is unchanged,
+ * starting over otherwise. Writers descend the same way and lock only the nodes they change, by moving their
+ * version from the one they read; that fails, and the writer starts over, if the node changed in between. A node
+ * that grows, shrinks or has its prefix shortened is replaced by a copy, with the node and its parent locked, and
+ * marked obsolete. The prefix and size of a node never change in place, and leaves are never changed at all.
+ * Replaced nodes and removed leaves are freed by epochs, as in BwTree: every operation registers in the current
+ * epoch, and what is retired during an epoch is freed once no operation of that epoch or an older one is running.
+ *
+ * The root is a node of 256 children without prefix that is never replaced.
+ */
+template <typename KeyType, typename ValueType>
+class AdaptiveRadixTree {
+ public:
+  AdaptiveRadixTree();
+
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  // Insert a key-value pair into this tree; returns false if the key is already there.
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  // Remove a key and its value from this tree; returns false if the key is not there.
+  auto Remove(const KeyType &key) -> bool;
+
+  // return the value associated with a given key
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Call a function with the pairs of the tree in key order, starting at the first key not less than low, until it
+   * returns false. Pairs inserted or removed during the scan may or may not be seen.
+   * @param low the key to start at, or nullptr to start at the first key
+   * @param fn called with each key and its value; returns whether to go on
+   */
+  void Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn);
+
+  /** @return the number of keys in the tree */
+  auto GetSize() const -> size_t { return size_; }
+
+ private:
+  static constexpr size_t KEY_SIZE = sizeof(KeyType);
+  static constexpr uint64_t OBSOLETE = 1;
+  static constexpr uint64_t LOCKED = 2;
+
+  enum class NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+  struct Leaf {
+    KeyType key_;
+    ValueType value_;
+  };
+  static_assert(alignof(Leaf) >= 2, "The low bit of leaf pointers tags them.");
+
+  /** A child is a Node pointer, or a Leaf pointer with the low bit set; 0 for no child. */
+  using Child = uintptr_t;
+
+  struct Node {
+    Node(NodeType type, const uint8_t *prefix, size_t prefix_length);
+    std::atomic<uint64_t> version_{0};
+    const NodeType type_;
+    std::atomic<uint16_t> num_children_{0};
+    const uint32_t prefix_length_;
+    uint8_t prefix_[KEY_SIZE];
+  };
+
+  /** Node4 and Node16: the key bytes of the children in ascending order, next to the children. */
+  template <NodeType TYPE, size_t CAPACITY>
+  struct KeyedNode : public Node {
+    KeyedNode(const uint8_t *prefix, size_t prefix_length) : Node(TYPE, prefix, prefix_length) {}
+    std::atomic<uint8_t> keys_[CAPACITY]{};
+    std::atomic<Child> children_[CAPACITY]{};
+  };
+  using Node4 = KeyedNode<NodeType::NODE4, 4>;
+  using Node16 = KeyedNode<NodeType::NODE16, 16>;
+
+  /** Node48: one slot of children_ per key byte, plus one, or 0 for no child. */
+  struct Node48 : public Node {
+    Node48(const uint8_t *prefix, size_t prefix_length) : Node(NodeType::NODE48, prefix, prefix_length) {}
+    std::atomic<uint8_t> child_index_[256]{};
+    std::atomic<Child> children_[48]{};
+  };
+
+  struct Node256 : public Node {
+    Node256(const uint8_t *prefix, size_t prefix_length) : Node(NodeType::NODE256, prefix, prefix_length) {}
+    std::atomic<Child> children_[256]{};
+  };
+
+  /** The outcome of scanning a subtree. */
+  enum class ScanResult { CONTINUE, DONE, RESTART };
+
+  /** What a scan carries through the tree. */
+  struct ScanState {
+    const std::function<bool(const KeyType &, const ValueType &)> &fn_;
+    /** Whether the first key may equal the bound, which it may not after a restart */
+    bool inclusive_;
+    bool emitted_{false};
+    KeyType last_{};
+  };
+
+  /** Registers an operation in the current epoch while it runs. */
+  class EpochGuard {
+   public:
+    explicit EpochGuard(AdaptiveRadixTree *tree) : tree_(tree), epoch_(tree->EnterEpoch()) {}
+    ~EpochGuard() { tree_->active_[epoch_ % 2]--; }
+    DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+   private:
+    AdaptiveRadixTree *tree_;
+    uint64_t epoch_;
+  };
+
+  // One attempt of each operation; returns false if the attempt ran into a concurrent change and must start over.
+  auto TryInsert(const KeyType &key, const ValueType &value, bool *inserted) -> bool;
+  auto TryRemove(const KeyType &key, bool *removed) -> bool;
+  auto TryGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found) -> bool;
+
+  auto ScanNode(Node *node, size_t depth, const uint8_t *bound, ScanState *state) -> ScanResult;
+
+  // Version locks of the nodes, see the class comment.
+  static auto ReadLock(const Node *node, uint64_t *version) -> bool;
+  static auto Validate(const Node *node, uint64_t version) -> bool { return node->version_ == version; }
+  static auto UpgradeLock(Node *node, uint64_t version) -> bool;
+  static void WriteUnlock(Node *node) { node->version_.fetch_add(LOCKED); }
+  static void WriteUnlockObsolete(Node *node) { node->version_.fetch_add(LOCKED | OBSOLETE); }
+
+  static auto KeyBytes(const KeyType &key) -> const uint8_t * { return reinterpret_cast<const uint8_t *>(&key); }
+  static auto IsLeaf(Child child) -> bool { return (child & 1) != 0; }
+  static auto AsLeaf(Child child) -> Leaf * { return reinterpret_cast<Leaf *>(child & ~Child{1}); }
+  static auto AsNode(Child child) -> Node * { return reinterpret_cast<Node *>(child); }
+  static auto ToChild(Leaf *leaf) -> Child { return reinterpret_cast<Child>(leaf) | 1; }
+  static auto ToChild(Node *node) -> Child { return reinterpret_cast<Child>(node); }
+
+  /** @return how many bytes of the node's prefix the key matches from depth on */
+  static auto MatchPrefix(const Node *node, const uint8_t *key, size_t depth) -> size_t;
+
+  static auto Capacity(NodeType type) -> size_t;
+  static auto GrownType(NodeType type) -> NodeType;
+  static auto ShrunkType(NodeType type) -> NodeType;
+  /** @return the number of children left to a node that makes it shrink; 0 for a node that never shrinks */
+  static auto ShrinkSize(NodeType type) -> size_t;
+
+  static auto NewNode(NodeType type, const uint8_t *prefix, size_t prefix_length) -> Node *;
+  static void DeleteNode(Node *node);
+  /** Free a subtree, when the tree is destroyed. */
+  static void DeleteChild(Child child);
+  /** Free a retired leaf or node, but not the children the node still points to. */
+  static void FreeRetired(Child child);
+
+  /** @return the key bytes and the children of a Node4 or Node16 */
+  static auto KeyedArrays(const Node *node) -> std::pair<std::atomic<uint8_t> *, std::atomic<Child> *>;
+
+  /** @return the child under a key byte, or 0 */
+  static auto FindChild(const Node *node, uint8_t byte) -> Child;
+
+  /**
+   * List the children under the key bytes from the given one on, in ascending order.
+   * @return the number of children listed
+   */
+  static auto ListChildren(const Node *node, uint8_t from, uint8_t *bytes, Child *children) -> size_t;
+
+  // Changes of a node, with the node locked or not yet shared. AddChild() needs the node not to be full.
+  static void AddChild(Node *node, uint8_t byte, Child child);
+  static void ReplaceChild(Node *node, uint8_t byte, Child child);
+  static void RemoveChild(Node *node, uint8_t byte);
+
+  /**
+   * @return a copy of a locked node with another type and prefix, holding all children of the node but the one under
+   * the skipped byte, if any
+   */
+  static auto CopyNode(const Node *node, NodeType type, const uint8_t *prefix, size_t prefix_length,
+                       int skipped_byte = -1) -> Node *;
+
+  auto EnterEpoch() -> uint64_t;
+
+  /** Free a child that was unlinked from the tree once no running operation can read it any more. */
+  void Retire(Child child);
+
+  Node256 *root_;
+  std::atomic<size_t> size_{0};
+
+  std::atomic<uint64_t> epoch_{0};
+  /** The number of operations running in even and odd epochs */
+  std::atomic<size_t> active_[2]{};
+  /** Guards the garbage and the moves to the next epoch. */
+  std::mutex garbage_latch_;
+  /** The children retired in each of the last three epochs */
+  std::vector<Child> garbage_[3];
+};
+
+}  // namespace bustub
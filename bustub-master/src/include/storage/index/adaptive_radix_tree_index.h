@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_index.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define ART_INDEX_TYPE AdaptiveRadixTreeIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * An index kept in an AdaptiveRadixTree, in memory only. Catalog::CreateIndex() fills it from the table heap, which
+ * is also how it is rebuilt after a restart. The keys are ordered by their bytes, so normalized keys (see GenericKey)
+ * come out of scans in key order; entries of other keys are sorted with the comparator when they are scanned.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTreeIndex : public Index {
+ public:
+  explicit AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result, Transaction *transaction) override;
+
+  /** Call a function with the pairs from the first key not less than low on, see AdaptiveRadixTree::Scan(). */
+  void Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn) {
+    container_.Scan(low, fn);
+  }
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  AdaptiveRadixTree<KeyType, ValueType> container_;
+};
+
+}  // namespace bustub
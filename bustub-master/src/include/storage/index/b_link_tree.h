@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_link_tree.h
+//
+// Identification: src/include/storage/index/b_link_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "concurrency/transaction.h"
+#include "storage/page/b_link_tree_page.h"
+
+namespace bustub {
+
+#define BLINKTREE_TYPE BLinkTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * A B-link tree (Lehman and Yao): a B+ tree whose nodes link to their right sibling and carry a high key, see
+ * BLinkTreePage. It supports unique keys, like BPlusTree.
+ *
+ * The links let every operation hold at most one page latch at a time. A search latches a node, picks the child,
+ * and releases the node before it latches the child; if the child split in between, the key lies past its high key
+ * and the search follows right links until it finds it. Inserts descend the same way, remembering the path, and
+ * write-latch only the leaf. A split takes two steps: the upper half moves into a new right sibling, which is
+ * reachable through the right link as soon as the page is released, and only then the separator is posted to the
+ * parent, latched on its own and found through the remembered path (moving right if it split meanwhile).
+ *
+ * Removes only take the key out of its leaf; pages never merge, so a page, once linked, stays in the tree and keeps
+ * its level, which is what allows reading a page's type before latching it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BLinkTree {
+  using InternalPage = BLinkTreePage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BLinkTreePage<KeyType, ValueType, KeyComparator>;
+
+ public:
+  explicit BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                     int leaf_max_size = B_LINK_TREE_LEAF_PAGE_SIZE,
+                     int internal_max_size = B_LINK_TREE_INTERNAL_PAGE_SIZE, page_id_t header_page_id = HEADER_PAGE_ID);
+
+  // Insert a key-value pair into this tree; returns false if the key is already there.
+  auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
+
+  // Remove a key and its value from this tree.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
+
+  // Delete every page of the tree and its record in the header page; the tree must not be used afterwards.
+  // Pages still pinned by someone else are not deleted but appended to pinned_page_ids.
+  void Destroy(std::vector<page_id_t> *pinned_page_ids);
+
+ private:
+  auto FetchTreePage(page_id_t page_id) -> Page *;
+
+  auto NewTreePage(int level) -> Page *;
+
+  auto StartNewTree(const KeyType &key, const ValueType &value) -> bool;
+
+  auto FindPage(const KeyType &key, int level, bool write, std::vector<page_id_t> *path = nullptr) -> Page *;
+
+  auto MoveRight(Page *page, const KeyType &key, bool write) -> Page *;
+
+  void InsertIntoParent(std::vector<page_id_t> *path, int level, KeyType key, page_id_t right_id);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  std::atomic<page_id_t> root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+  page_id_t header_page_id_;
+  // serializes starting the tree and growing it by a new root, and guards the header page record
+  std::mutex root_latch_;
+};
+
+}  // namespace bustub
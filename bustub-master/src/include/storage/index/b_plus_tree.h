@@ -14,7 +14,9 @@
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "storage/index/external_sort.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -23,6 +25,18 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/** Knobs for building an index from existing data, see Catalog::CreateIndex() and BPlusTree::BulkLoad(). */
+struct BulkLoadOptions {
+  /** How full, in percent, the bulk-loaded pages are left; room for later inserts. Clamped to [50, 100]. */
+  int fill_factor_{90};
+  /** Size of the buffer for sorting the keys, in pages; larger inputs are sorted in runs spilled to disk. */
+  size_t sort_buffer_pages_{64};
+  /** Number of threads scanning the table, each a contiguous range of its pages. 0 means one per core. */
+  size_t num_workers_{0};
+  /** Size of the Bloom filter kept over the keys, in bits per key. 0 means no filter. */
+  size_t bloom_filter_bits_per_key_{0};
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
@@ -32,6 +46,18 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency follows latch crabbing. Lookups descend with read latches, releasing each parent once the child is
+ * latched. Inserts and removes first descend the same way but write-latch the leaf; if the leaf would split or
+ * underflow, they give up and descend again from the root with write latches, keeping the latches of every
+ * ancestor that the change may reach (the pages of Transaction::GetPageSet()). root_latch_ guards root_page_id_
+ * and sits above the root page in that order.
+ *
+ * An empty tree can also be built bottom-up from sorted input with BulkLoad(), which fills leaves left to right and
+ * stacks the internal levels on top, writing every page once.
+ *
+ * Batches of point lookups go through GetValues(), which sorts the keys and descends once for all keys bound for
+ * the same page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +66,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     page_id_t header_page_id = HEADER_PAGE_ID);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -48,12 +75,24 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
-  // Remove a key and its value from this B+ tree.
-  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+  // Remove a key and its value from this B+ tree; returns false if the key is not there.
+  auto Remove(const KeyType &key, Transaction *transaction = nullptr) -> bool;
+
+  // Build an empty tree from the sorted pairs of input; duplicate keys keep their first value.
+  // Returns false, leaving the tree untouched, if the tree is not empty.
+  auto BulkLoad(ExternalSort<KeyType, ValueType, KeyComparator> *input, int fill_factor = 90) -> bool;
+
+  // Delete every page of the tree and its record in the header page; the tree must not be used afterwards.
+  // Pages still pinned by someone else are not deleted but appended to pinned_page_ids.
+  void Destroy(std::vector<page_id_t> *pinned_page_ids);
 
   // return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  // Look up a batch of keys at once; (*results)[i] receives the value associated with keys[i], if any.
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -71,9 +110,57 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
+  // returns the leaf page pinned and read-latched, or nullptr if the tree is empty
   auto FindLeafPage(const KeyType &key, bool leftMost = false) -> Page *;
 
  private:
+  /** The structural change a pessimistic descent has to be ready for. */
+  enum class Operation { INSERT, REMOVE };
+
+  /** The rightmost page of a tree level during BulkLoad(), pinned and not yet linked to its parent. */
+  struct BulkLoadLevel {
+    Page *page_;
+    KeyType first_key_;
+  };
+
+  /** How many child pages a batch lookup prefetches into the cache before it searches any of them. */
+  static constexpr size_t BATCH_GROUP_SIZE = 4;
+  /** How many bytes from the start of each page of a group are prefetched: the header and the first keys. */
+  static constexpr size_t BATCH_PREFETCH_BYTES = 256;
+
+  auto FetchTreePage(page_id_t page_id) -> Page *;
+
+  auto NewTreePage(bool leaf) -> Page *;
+
+  void BulkLoadAppend(std::vector<BulkLoadLevel> *levels, const KeyType &key, const ValueType &value, int leaf_fill,
+                      int internal_fill, int fill_factor);
+
+  void BulkLoadLink(std::vector<BulkLoadLevel> *levels, size_t level, int internal_fill, int fill_factor);
+
+  void BulkLoadFinish(std::vector<BulkLoadLevel> *levels, int internal_fill, int fill_factor);
+
+  auto FindLeafPageOptimistic(const KeyType &key, bool left_most, bool write_leaf, bool *is_root,
+                              std::vector<page_id_t> *following = nullptr) -> Page *;
+
+  auto GetValuesFrom(Page *page, const std::vector<KeyType> &keys, const size_t *order, size_t count,
+                     std::vector<std::vector<ValueType>> *results) -> size_t;
+
+  auto MakeIterator(Page *page, int index, const std::vector<page_id_t> &following) -> INDEXITERATOR_TYPE;
+
+  auto FindLeafPagePessimistic(const KeyType &key, Operation op, Transaction *transaction) -> Page *;
+
+  auto Separator(const KeyType &left, const KeyType &right) const -> KeyType;
+
+  auto IsSafe(BPlusTreePage *node, Operation op) const -> bool;
+
+  void ReleasePageSet(Transaction *transaction);
+
+  void DeletePages(Transaction *transaction);
+
+  void DestroySubtree(page_id_t page_id, std::vector<page_id_t> *pinned_page_ids);
+
+  auto RemoveFromLeaf(const KeyType &key, Transaction *transaction) -> bool;
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
@@ -110,6 +197,8 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  page_id_t header_page_id_;
+  mutable ReaderWriterLatch root_latch_;
 };
 
 }  // namespace bustub
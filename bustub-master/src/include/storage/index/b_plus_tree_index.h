@@ -14,9 +14,12 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/index/index.h"
 
 namespace bustub {
@@ -26,7 +29,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 page_id_t header_page_id = HEADER_PAGE_ID);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -34,6 +38,24 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  auto EnableBloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key) -> bool override;
+
+  void ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result, Transaction *transaction) override;
+
+  void Destroy(std::vector<page_id_t> *pinned_page_ids) override {
+    bloom_filter_.reset();
+    container_.Destroy(pinned_page_ids);
+  }
+
+  /**
+   * Build the still empty index from sorted (key, RID) pairs; see BPlusTree::BulkLoad().
+   * @return false if the index is not empty
+   */
+  auto BulkLoad(ExternalSort<KeyType, ValueType, KeyComparator> *input, int fill_factor) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -41,10 +63,15 @@ class BPlusTreeIndex : public Index {
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
  protected:
+  /** Collect the entries whose key columns match those of the key, in key order. */
+  void ScanMatches(const Tuple &key, std::vector<MappingType> *result, Transaction *transaction);
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // the filter of the keys, or nullptr
+  std::unique_ptr<BloomFilter> bloom_filter_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "common/rwlatch.h"
+
+namespace bustub {
+
+/**
+ * A blocked Bloom filter over the key hashes of an index, kept in pages of its own, which lets an index answer
+ * lookups of missing keys without reading its leaf or bucket pages.
+ *
+ * The filter is split into blocks of BLOCK_WORDS 32-bit words, one cache line or less. A key sets one bit in every
+ * word of a single block, picked by the upper half of its hash; the lower half, multiplied by a different odd salt
+ * per word, picks the bits. A lookup thus touches one block on one page.
+ *
+ * Bits cannot be cleared, so removed keys leave their bits behind and a filter that grew past its capacity loses
+ * precision. Either makes the filter stale. A stale filter is bypassed, every lookup answering "maybe", while a
+ * background thread rebuilds it, sized for the current number of keys, from a scan of the index; neither writers nor
+ * lookups ever wait for a scan. The rebuild fills fresh pages outside the filter latch and swaps them in under a
+ * short exclusive hold of it. Adds and lookups share the latch, setting and testing bits atomically. Index writers
+ * add a key only after it is in the index: an add that comes before the rebuild starts is seen by its scan, and one
+ * that comes after is queued and replayed into the fresh pages before the swap.
+ */
+class BloomFilter {
+ public:
+  /** Calls its argument with the hash of every key in the index. */
+  using KeyScan = std::function<void(const std::function<void(uint64_t)> &)>;
+
+  /**
+   * Build a filter of the keys of an index.
+   * @param buffer_pool_manager the buffer pool holding the filter pages
+   * @param bits_per_key the size of the filter per key; 10 bits keep about 1% false positives
+   * @param scan the scan of the index, for building and rebuilding the filter
+   */
+  BloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key, KeyScan scan);
+
+  /** Stop the background rebuild and delete the filter pages. */
+  ~BloomFilter();
+
+  DISALLOW_COPY_AND_MOVE(BloomFilter);
+
+  /** Add the hash of a key that was inserted into the index; schedules a rebuild if that made the filter stale. */
+  void Add(uint64_t hash);
+
+  /**
+   * Record that a key was removed from the index; its bits stay set until the filter is rebuilt, which is scheduled
+   * if the removal made the filter stale. Only removals of keys that were in the index count.
+   */
+  void NoteRemove();
+
+  /** @return false if the key with the given hash is certainly not in the index; always true while stale */
+  auto MayContain(uint64_t hash) -> bool;
+
+  /** Wait until no rebuild is scheduled or running. */
+  void WaitForRebuild();
+
+  /** @return the number of pages holding the filter */
+  auto GetPageCount() const -> size_t { return page_ids_.size(); }
+
+  /** @return how many times the filter was built, the first time included */
+  auto GetBuildCount() const -> size_t { return build_count_; }
+
+ private:
+  /** The number of 32-bit words in a block, and of bits set per key. */
+  static constexpr size_t BLOCK_WORDS = 8;
+  static constexpr size_t BLOCKS_PER_PAGE = PAGE_SIZE / (BLOCK_WORDS * sizeof(uint32_t));
+
+  /** @return whether removed keys or growth have made the filter imprecise enough to rebuild it */
+  auto IsStale() const -> bool;
+
+  /** Wake the background thread, starting it on first use, if the filter is stale. */
+  void ScheduleRebuildIfStale();
+
+  /** Runs the scheduled rebuilds until the filter is destroyed. */
+  void RebuildLoop();
+
+  /** Fill fresh pages, sized for the keys found, from a scan and swap them in for the current ones. */
+  void Build();
+
+  /** Set the bits of a hash in the given filter pages; the current ones need the latch held in either mode. */
+  void SetBits(const std::vector<page_id_t> &page_ids, uint64_t hash);
+
+  /** Fetch the filter page holding a block, throwing an "out of memory" exception if the buffer pool is full. */
+  auto FetchBlockPage(const std::vector<page_id_t> &page_ids, size_t block) -> Page *;
+
+  /** @return the block of a hash in a filter of the given number of pages */
+  static auto BlockOf(uint64_t hash, size_t num_pages) -> size_t {
+    return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(num_pages * BLOCKS_PER_PAGE)) >> 32);
+  }
+
+  /** @return the mask of the bit a hash sets in the given word of its block */
+  static auto MaskOf(uint64_t hash, size_t word) -> uint32_t;
+
+  BufferPoolManager *buffer_pool_manager_;
+  size_t bits_per_key_;
+  KeyScan scan_;
+  /** Held shared to set or test bits, exclusively to swap the pages. */
+  ReaderWriterLatch latch_;
+  std::vector<page_id_t> page_ids_;
+  /** The number of keys the filter was sized for; twice as many make it stale. */
+  std::atomic<size_t> capacity_{0};
+  /** Keys added and removed since the last build, the keys found by it included. */
+  std::atomic<size_t> num_added_{0};
+  std::atomic<size_t> num_removed_{0};
+  std::atomic<size_t> build_count_{0};
+  /** Whether a rebuild is scanning; set and cleared under latch_ held exclusively. */
+  bool building_{false};
+  /** The hashes added while a rebuild scans, replayed into its pages before the swap. */
+  std::mutex pending_latch_;
+  std::vector<uint64_t> pending_;
+
+  /** Protects rebuild_scheduled_, stop_ and the background thread. */
+  std::mutex rebuild_latch_;
+  /** Signalled when a rebuild is scheduled or the thread should stop. */
+  std::condition_variable work_cv_;
+  /** Signalled when the background thread has finished a rebuild. */
+  std::condition_variable done_cv_;
+  bool rebuild_scheduled_{false};
+  bool stop_{false};
+  std::thread rebuild_thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree.h
+//
+// Identification: src/include/storage/index/bw_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define BWTREE_TYPE BwTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * A Bw-tree (Levandoski et al.): a B-link tree whose nodes are never changed in place. It supports unique keys, like
+ * BPlusTree, and lives in memory; Flush() writes its leaves to pages.
+ *
+ * Nodes are named by a logical id, and the mapping table maps each id to the node's current state: a chain of delta
+ * records ending in a base node. An insert or a remove never latches: it prepends a delta for its key to the chain of
+ * the leaf with a compare-and-swap on the leaf's mapping table slot, and starts over from the slot if another writer
+ * got there first. Once a chain grows MAX_CHAIN_LENGTH deltas long, the writer that grew it consolidates it into a
+ * new base node and swaps that in the same way.
+ *
+ * Every delta also carries the node's high key and right sibling, so that any search moves right past a split as in
+ * BLinkTree. A node that outgrows its maximum size splits in two steps: the upper half is copied into a new node,
+ * and a split delta on the old one lowers its high key and links the new node; then an index entry delta posts the
+ * separator to the parent. Splits, and every change of an inner node, run under smo_latch_: they are rare, and
+ * serializing them spares the protocols that let concurrent splits help each other. Nodes never merge.
+ *
+ * Chains swapped out by a consolidation are freed by epochs: every operation registers in the current epoch, and a
+ * chain retired during an epoch is freed once no operation of that epoch or an older one is running.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BwTree {
+ public:
+  /** Header of the page a leaf is flushed to. The pairs follow it. */
+  struct LeafPageHeader {
+    int size_;
+    /** The page of the right sibling, or INVALID_PAGE_ID */
+    page_id_t next_page_id_;
+  };
+
+  static constexpr int LEAF_PAGE_CAPACITY =
+      static_cast<int>((PAGE_SIZE - sizeof(LeafPageHeader)) / sizeof(MappingType));
+
+  /**
+   * @param leaf_max_size the number of pairs that makes a leaf split; less than LEAF_PAGE_CAPACITY, so that a leaf
+   * fits its page
+   */
+  BwTree(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+         int leaf_max_size = LEAF_PAGE_CAPACITY / 2, int internal_max_size = 128);
+
+  ~BwTree();
+
+  DISALLOW_COPY_AND_MOVE(BwTree);
+
+  // Insert a key-value pair into this tree; returns false if the key is already there.
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  // Remove a key and its value from this tree; returns false if the key is not there.
+  auto Remove(const KeyType &key) -> bool;
+
+  // return the value associated with a given key
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Call a function with the pairs of the tree in key order, starting at the first key not less than low, until it
+   * returns false. Each leaf is read at one point in time; pairs inserted or removed during the scan may or may not
+   * be seen.
+   * @param low the key to start at, or nullptr to start at the first key
+   * @param fn called with each key and its value; returns whether to go on
+   */
+  void Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn);
+
+  /**
+   * Consolidate every leaf and write it to its page, allocated by the first flush and rewritten by the next ones.
+   * The pages of the leaves link to each other in key order.
+   * @return the page of the first leaf
+   */
+  auto Flush() -> page_id_t;
+
+  /** Insert the pairs of the leaf pages written by Flush(), from the page of the first leaf on. */
+  void Load(page_id_t first_page_id);
+
+  /**
+   * Delete the pages written by Flush(); the nodes in memory go with the tree.
+   * @param[out] pinned_page_ids the pages that are still pinned and were not deleted
+   */
+  void Destroy(std::vector<page_id_t> *pinned_page_ids);
+
+ private:
+  using NodeId = uint32_t;
+  static constexpr NodeId INVALID_NODE_ID = UINT32_MAX;
+  static constexpr uint32_t MAX_CHAIN_LENGTH = 8;
+  static constexpr size_t MAPPING_CHUNK_SIZE = 1 << 14;
+  static constexpr size_t MAPPING_CHUNKS = 1024;
+
+  enum class NodeType : uint8_t { LEAF, INNER, INSERT, DELETE, SPLIT, INDEX_ENTRY };
+
+  /** What every base node and delta holds: the state of the logical node as of this record. */
+  struct Node {
+    NodeType type_;
+    /** 0 for leaves */
+    uint32_t level_;
+    /** The number of deltas below this record */
+    uint32_t chain_length_;
+    /** The number of pairs or children of the node */
+    int size_;
+    /** The node holds the keys below high_key_, and its right sibling the others; no high key if right_ is invalid */
+    KeyType high_key_;
+    NodeId right_;
+    Node *next_;
+  };
+
+  struct LeafNode : public Node {
+    std::vector<MappingType> pairs_;
+  };
+
+  /** children_[0] covers the keys below children_[1].first, and its key is unused. */
+  struct InnerNode : public Node {
+    std::vector<std::pair<KeyType, NodeId>> children_;
+  };
+
+  /**
+   * A delta record. An INSERT delta adds key_ and value_ to a leaf, a DELETE delta removes key_, an INDEX_ENTRY delta
+   * adds child_ to an inner node, from key_ on. A SPLIT delta only changes the high key and the right sibling.
+   */
+  struct Delta : public Node {
+    KeyType key_;
+    ValueType value_;
+    NodeId child_;
+  };
+
+  /** Registers an operation in the current epoch while it runs. */
+  class EpochGuard {
+   public:
+    explicit EpochGuard(BwTree *tree) : tree_(tree), epoch_(tree->EnterEpoch()) {}
+    ~EpochGuard() { tree_->active_[epoch_ % 2]--; }
+    DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+   private:
+    BwTree *tree_;
+    uint64_t epoch_;
+  };
+
+  auto Slot(NodeId id) const -> std::atomic<Node *> & {
+    return mapping_[id / MAPPING_CHUNK_SIZE][id % MAPPING_CHUNK_SIZE];
+  }
+
+  /** Give a node not yet shared an id; needs smo_latch_. */
+  auto InstallNode(Node *node) -> NodeId;
+
+  /** Set up a delta to go on top of a chain: it inherits the state of the node. */
+  static void Stack(Delta *delta, NodeType type, Node *next);
+
+  /** @return whether a key lies below the high key of a node; a null key is the smallest of all */
+  auto IsBelowHigh(const Node *head, const KeyType *key) const -> bool {
+    return head->right_ == INVALID_NODE_ID || key == nullptr || comparator_(*key, head->high_key_) < 0;
+  }
+
+  /** Follow right siblings from a node to the one holding the key. @return the chain of that node */
+  auto MoveRight(NodeId *id, const KeyType *key) const -> Node *;
+
+  /** Descend to the node of a level holding a key, nullptr for the leftmost one. @return its chain */
+  auto FindNode(const KeyType *key, uint32_t level, NodeId *id) const -> Node *;
+
+  /** @return the child of an inner node that holds a key */
+  auto FindChild(const Node *head, const KeyType *key) const -> NodeId;
+
+  /** Look a key up in the chain of a leaf. */
+  auto FindInChain(const Node *head, const KeyType &key, ValueType *value) const -> bool;
+
+  /** @return the pairs of a leaf, or the children of an inner node, with the deltas applied */
+  auto CollectPairs(const Node *head) const -> std::vector<MappingType>;
+  auto CollectChildren(const Node *head) const -> std::vector<std::pair<KeyType, NodeId>>;
+
+  /** Swap a chain for a new base node. @return false if the chain changed meanwhile */
+  auto Consolidate(NodeId id, Node *head) -> bool;
+
+  /** Split a node while it is larger than its maximum size, posting the separators up; needs smo_latch_. */
+  void SplitNode(NodeId id);
+
+  /** Add the separator of a split to the parent, or grow a new root above the node; needs smo_latch_. */
+  void PostSeparator(NodeId left, uint32_t level, const KeyType &separator, NodeId right);
+
+  auto EnterEpoch() -> uint64_t;
+
+  /** Free a chain that was swapped out once no running operation can read it any more. */
+  void Retire(Node *head);
+
+  static void DeleteChain(Node *head);
+
+  /** @return the page a leaf is flushed to, allocated on the first flush; needs flush_latch_ */
+  auto PageOf(NodeId id) -> page_id_t;
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+
+  /** The mapping table, allocated a chunk at a time. */
+  std::unique_ptr<std::atomic<Node *>[]> mapping_[MAPPING_CHUNKS];
+  std::atomic<NodeId> root_;
+  /** Serializes splits and the changes of inner nodes; guards next_node_id_. */
+  std::mutex smo_latch_;
+  NodeId next_node_id_{0};
+
+  std::atomic<uint64_t> epoch_{0};
+  /** The number of operations running in even and odd epochs */
+  std::atomic<size_t> active_[2]{};
+  /** Guards the garbage and the moves to the next epoch. */
+  std::mutex garbage_latch_;
+  /** The chains retired in each of the last three epochs */
+  std::vector<Node *> garbage_[3];
+
+  /** Guards leaf_pages_. */
+  std::mutex flush_latch_;
+  std::unordered_map<NodeId, page_id_t> leaf_pages_;
+};
+
+}  // namespace bustub
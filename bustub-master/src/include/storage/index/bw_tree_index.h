@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree_index.h
+//
+// Identification: src/include/storage/index/bw_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/index/bw_tree.h"
+#include "storage/index/index.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define BWTREE_INDEX_TYPE BwTreeIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * An index kept in a BwTree, whose inserts and removes take no latch. Like AdaptiveRadixTreeIndex, it is filled from
+ * the table heap by Catalog::CreateIndex().
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BwTreeIndex : public Index {
+ public:
+  BwTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result, Transaction *transaction) override;
+
+  void Destroy(std::vector<page_id_t> *pinned_page_ids) override { container_.Destroy(pinned_page_ids); }
+
+  /** Call a function with the pairs from the first key not less than low on, see BwTree::Scan(). */
+  void Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn) {
+    container_.Scan(low, fn);
+  }
+
+  /** Write the leaves to their pages, see BwTree::Flush(). */
+  auto Flush() -> page_id_t { return container_.Flush(); }
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  BwTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
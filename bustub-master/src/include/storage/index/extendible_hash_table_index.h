@@ -19,6 +19,7 @@
 
 #include "container/hash/extendible_hash_table.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/index/index.h"
 
 namespace bustub {
@@ -39,11 +40,23 @@ class ExtendibleHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  auto EnableBloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key) -> bool override;
+
+  void Destroy(std::vector<page_id_t> *pinned_page_ids) override {
+    bloom_filter_.reset();
+    container_.Destroy(pinned_page_ids);
+  }
+
  protected:
   // comparator for key
   KeyComparator comparator_;
   // container
   ExtendibleHashTable<KeyType, ValueType, KeyComparator> container_;
+  // the filter of the keys, or nullptr
+  std::unique_ptr<BloomFilter> bloom_filter_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORT_TYPE ExternalSort<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSort sorts (key, value) pairs that may not fit in memory, e.g. to feed BPlusTree::BulkLoad().
+ *
+ * Pairs are collected in a buffer of a fixed number of pages. Whenever the buffer is full it is sorted and spilled
+ * as a sorted run to temporary pages of the buffer pool. Sort() then merges the runs, in several passes if there are
+ * more runs than buffer pages, and Next() streams the pairs out of the last merge. A run page is deleted as soon as
+ * it has been read. Pairs with equal keys come out in no particular order.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSort {
+ public:
+  /**
+   * @param buffer_pool_manager the buffer pool holding the temporary run pages
+   * @param comparator the key comparator
+   * @param buffer_pages the size of the sort buffer in pages; also the number of runs merged at once
+   */
+  ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, size_t buffer_pages);
+
+  ~ExternalSort();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSort);
+
+  /** Add a pair. Must not be called after Sort(). */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /**
+   * Sort the pairs added so far and spill them as a run, leaving every pair in a run on disk. Used before another
+   * sorter adopts the runs of this one.
+   */
+  void Flush();
+
+  /**
+   * Take over the runs of a flushed sorter on the same buffer pool, to be merged with the pairs of this one by
+   * Sort(). This way several threads can each sort a part of the input with a sorter of their own. Must not be
+   * called after Sort().
+   */
+  void AdoptRuns(ExternalSort *other);
+
+  /** Finish the input. Afterwards, Next() returns the pairs in key order. */
+  void Sort();
+
+  /**
+   * Get the next pair in key order.
+   * @param[out] pair the next pair
+   * @return false once all pairs have been returned
+   */
+  auto Next(MappingType *pair) -> bool;
+
+  /** @return the number of sorted runs spilled to temporary pages, 0 if everything was sorted in memory */
+  auto GetRunCount() const -> size_t { return spilled_runs_; }
+
+ private:
+  /** Header of a temporary page holding a part of a sorted run. The pairs follow it. */
+  struct RunPageHeader {
+    page_id_t next_page_id_;
+    int size_;
+  };
+
+  static constexpr int RUN_PAGE_CAPACITY =
+      static_cast<int>((PAGE_SIZE - sizeof(RunPageHeader)) / sizeof(std::pair<KeyType, ValueType>));
+
+  /** Read position in a run: the current page, pinned, and the index of the next pair in it. */
+  struct RunCursor {
+    Page *page_;
+    int index_;
+  };
+
+  static auto Header(Page *page) -> RunPageHeader * { return reinterpret_cast<RunPageHeader *>(page->GetData()); }
+
+  static auto Pairs(Page *page) -> MappingType * {
+    return reinterpret_cast<MappingType *>(page->GetData() + sizeof(RunPageHeader));
+  }
+
+  auto NewRunPage() -> Page *;
+
+  /** Sort the buffer and write it out as a new run. */
+  void SpillBuffer();
+
+  /** Append a pair to the run being written, starting it if needed. */
+  void AppendToRun(const MappingType &pair);
+
+  /** @return the first page of the run being written, which is finished */
+  auto FinishRun() -> page_id_t;
+
+  /** Start merging the runs [begin, end) of runs_. */
+  void OpenMerge(size_t begin, size_t end);
+
+  auto NextMerged(MappingType *pair) -> bool;
+
+  /** Move a cursor to its next pair, deleting each page it is done with. @return false at the end of the run */
+  auto Advance(RunCursor *cursor) -> bool;
+
+  /** Delete the pages of a run from the given page on. */
+  void DeleteRun(page_id_t page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t buffer_pages_;
+  std::vector<MappingType> buffer_;
+  size_t buffer_next_{0};
+  bool sorted_{false};
+  size_t spilled_runs_{0};
+
+  /** First pages of the runs that have not been merged yet. */
+  std::vector<page_id_t> runs_;
+  /** Run being written: its first page and its last page, which stays pinned. */
+  page_id_t write_first_page_id_{INVALID_PAGE_ID};
+  Page *write_page_{nullptr};
+
+  /** The runs being merged and a min-heap of indexes into cursors_, ordered by the cursors' current keys. */
+  std::vector<RunCursor> cursors_;
+  std::vector<size_t> heap_;
+};
+
+}  // namespace bustub
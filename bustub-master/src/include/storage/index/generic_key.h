@@ -13,8 +13,11 @@
 #pragma once
 
 #include <cstring>
+#include <string>
 
+#include "common/exception.h"
 #include "storage/table/tuple.h"
+#include "type/type.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -25,6 +28,13 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * Where the key schema allows it (see IsNormalizable()), the key is stored normalized: the columns are encoded one
+ * after the other so that comparing two keys byte by byte with memcmp orders them like their column values.
+ * Integers are stored big-endian with the sign bit flipped, decimals as their IEEE bits with the sign bit flipped
+ * (all bits for negative numbers), and strings with their zero bytes escaped as 00 FF and terminated by 00 01
+ * (00 00 for NULL). The NULL sentinels of the fixed-width types sort like the numbers they are. Other keys hold
+ * the raw bytes of the key tuple and are compared column by column through Value.
  */
 template <size_t KeySize>
 class GenericKey {
@@ -35,13 +45,64 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  /**
+   * Set the key from a key tuple, normalized if the key schema allows it. Keys compared by a GenericComparator must
+   * all be set this way with the comparator's key schema.
+   */
+  inline void SetFromKey(const Tuple &tuple, Schema *key_schema) {
+    SetFromKey(tuple, key_schema, IsNormalizable(key_schema));
+  }
+
+  /**
+   * Set the key from a key tuple as above, where normalized is IsNormalizable(key_schema), worked out once for the
+   * schema (see GenericComparator::IsNormalized()).
+   */
+  inline void SetFromKey(const Tuple &tuple, Schema *key_schema, bool normalized) {
+    if (!normalized) {
+      SetFromKey(tuple);
+      return;
+    }
+    memset(data_, 0, KeySize);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      offset = EncodeColumn(tuple.GetValue(key_schema, i), offset);
+    }
+  }
+
+  /**
+   * Set the key to the smallest normalized key whose first column_count columns are those of the key tuple: the
+   * columns behind them are left zero. The key schema must allow normalizing.
+   * @return the length of the encoding of those columns, which every key that starts with them shares
+   */
+  inline auto SetFromKeyPrefix(const Tuple &tuple, Schema *key_schema, uint32_t column_count) -> size_t {
+    memset(data_, 0, KeySize);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < column_count; i++) {
+      offset = EncodeColumn(tuple.GetValue(key_schema, i), offset);
+    }
+    return offset;
+  }
+
   // NOTE: for test purpose only
+  // stores the integer normalized, i.e. as a key of a single BIGINT column
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    EncodeInteger(static_cast<uint64_t>(key) ^ SIGN_BIT, sizeof(int64_t), 0);
   }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
+    return ToValue(schema, column_idx, IsNormalizable(schema));
+  }
+
+  /** Read a column of the key, where normalized is IsNormalizable(schema), worked out once for the schema. */
+  inline auto ToValue(Schema *schema, uint32_t column_idx, bool normalized) const -> Value {
+    if (normalized) {
+      size_t offset = 0;
+      for (uint32_t i = 0; i < column_idx; i++) {
+        offset = SkipColumn(schema->GetColumn(i).GetType(), offset);
+      }
+      return DecodeColumn(schema->GetColumn(column_idx).GetType(), offset);
+    }
     const char *data_ptr;
     const auto &col = schema->GetColumn(column_idx);
     const TypeId column_type = col.GetType();
@@ -55,9 +116,51 @@ class GenericKey {
     return Value::DeserializeFrom(data_ptr, column_type);
   }
 
+  /**
+   * @return whether keys of the schema are stored normalized: every column has an order-preserving encoding and the
+   * longest possible encoding fits in the key. A VARCHAR column needs a declared length for that.
+   */
+  static auto IsNormalizable(const Schema *key_schema) -> bool {
+    size_t size = 0;
+    for (const auto &column : key_schema->GetColumns()) {
+      switch (column.GetType()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+        case TypeId::SMALLINT:
+        case TypeId::INTEGER:
+        case TypeId::BIGINT:
+        case TypeId::DECIMAL:
+        case TypeId::TIMESTAMP:
+          size += column.GetFixedLength();
+          break;
+        case TypeId::VARCHAR:
+          if (column.GetVariableLength() == 0) {
+            return false;
+          }
+          // Every byte may need escaping, plus the terminator.
+          size += 2 * column.GetVariableLength() + 2;
+          break;
+        default:
+          return false;
+      }
+    }
+    return size <= KeySize;
+  }
+
+  /**
+   * @return the first 8 bytes of the key as a big-endian integer, zero-padded for shorter keys. Prefixes of normalized
+   * keys order like the keys themselves, with ties only between keys that share their first 8 bytes.
+   */
+  inline auto GetPrefix() const -> uint64_t {
+    constexpr size_t size = KeySize < sizeof(uint64_t) ? KeySize : sizeof(uint64_t);
+    return DecodeInteger(size, 0) << (8 * (sizeof(uint64_t) - size));
+  }
+
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // interpret the first 8 bytes as a normalized int64_t, see SetFromInteger()
+  inline auto ToString() const -> int64_t {
+    return static_cast<int64_t>(DecodeInteger(sizeof(int64_t), 0) ^ SIGN_BIT);
+  }
 
   // NOTE: for test purpose only
   // interpret the first 8 bytes as int64_t from data vector
@@ -68,15 +171,140 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  static constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+  /** Store the low size bytes of bits big-endian at offset. @return the offset past them */
+  inline auto EncodeInteger(uint64_t bits, size_t size, size_t offset) -> size_t {
+    for (size_t i = 0; i < size; i++) {
+      data_[offset + i] = static_cast<char>(bits >> (8 * (size - 1 - i)));
+    }
+    return offset + size;
+  }
+
+  inline auto DecodeInteger(size_t size, size_t offset) const -> uint64_t {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < size; i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data_[offset + i]);
+    }
+    return bits;
+  }
+
+  /** Flip the sign bit of a signed integer of the given size, moving negative numbers below positive ones. */
+  static inline auto FlipSign(uint64_t bits, size_t size) -> uint64_t {
+    return (bits ^ (uint64_t{1} << (8 * size - 1))) & (size == 8 ? ~uint64_t{0} : (uint64_t{1} << (8 * size)) - 1);
+  }
+
+  /** Append the normalized encoding of a value at offset. @return the offset past it */
+  inline auto EncodeColumn(const Value &value, size_t offset) -> size_t {
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return EncodeInteger(FlipSign(static_cast<uint8_t>(value.GetAs<int8_t>()), 1), 1, offset);
+      case TypeId::SMALLINT:
+        return EncodeInteger(FlipSign(static_cast<uint16_t>(value.GetAs<int16_t>()), 2), 2, offset);
+      case TypeId::INTEGER:
+        return EncodeInteger(FlipSign(static_cast<uint32_t>(value.GetAs<int32_t>()), 4), 4, offset);
+      case TypeId::BIGINT:
+        return EncodeInteger(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ SIGN_BIT, 8, offset);
+      case TypeId::TIMESTAMP:
+        return EncodeInteger(value.GetAs<uint64_t>(), 8, offset);
+      case TypeId::DECIMAL: {
+        double decimal = value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        return EncodeInteger((bits & SIGN_BIT) != 0 ? ~bits : bits | SIGN_BIT, 8, offset);
+      }
+      case TypeId::VARCHAR: {
+        if (value.IsNull()) {
+          BUSTUB_ASSERT(offset + 2 <= KeySize, "Normalized key overflow.");
+          data_[offset] = 0;
+          data_[offset + 1] = 0;
+          return offset + 2;
+        }
+        // Like Value comparisons, leave out the terminating zero byte.
+        const char *str = value.GetData();
+        uint32_t length = value.GetLength() - 1;
+        for (uint32_t i = 0; i < length; i++) {
+          BUSTUB_ASSERT(offset + 2 <= KeySize, "Normalized key overflow.");
+          data_[offset++] = str[i];
+          if (str[i] == 0) {
+            data_[offset++] = static_cast<char>(0xFF);
+          }
+        }
+        BUSTUB_ASSERT(offset + 2 <= KeySize, "Normalized key overflow.");
+        data_[offset] = 0;
+        data_[offset + 1] = 1;
+        return offset + 2;
+      }
+      default:
+        UNREACHABLE("Type cannot be normalized.");
+    }
+  }
+
+  /** @return the offset past the normalized column of the given type at offset */
+  inline auto SkipColumn(TypeId type, size_t offset) const -> size_t {
+    if (type != TypeId::VARCHAR) {
+      return offset + Type::GetTypeSize(type);
+    }
+    while (data_[offset] != 0 || data_[offset + 1] == static_cast<char>(0xFF)) {
+      offset += data_[offset] == 0 ? 2 : 1;
+    }
+    return offset + 2;
+  }
+
+  inline auto DecodeColumn(TypeId type, size_t offset) const -> Value {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return Value(type, static_cast<int8_t>(FlipSign(DecodeInteger(1, offset), 1)));
+      case TypeId::SMALLINT:
+        return Value(type, static_cast<int16_t>(FlipSign(DecodeInteger(2, offset), 2)));
+      case TypeId::INTEGER:
+        return Value(type, static_cast<int32_t>(FlipSign(DecodeInteger(4, offset), 4)));
+      case TypeId::BIGINT:
+        return Value(type, static_cast<int64_t>(DecodeInteger(8, offset) ^ SIGN_BIT));
+      case TypeId::TIMESTAMP:
+        return Value(type, DecodeInteger(8, offset));
+      case TypeId::DECIMAL: {
+        uint64_t bits = DecodeInteger(8, offset);
+        bits = (bits & SIGN_BIT) != 0 ? bits ^ SIGN_BIT : ~bits;
+        double decimal;
+        memcpy(&decimal, &bits, sizeof(decimal));
+        return Value(type, decimal);
+      }
+      case TypeId::VARCHAR: {
+        if (data_[offset] == 0 && data_[offset + 1] == 0) {
+          return Value(type, nullptr, 0, false);
+        }
+        std::string str;
+        while (data_[offset] != 0 || data_[offset + 1] == static_cast<char>(0xFF)) {
+          str.push_back(data_[offset]);
+          offset += data_[offset] == 0 ? 2 : 1;
+        }
+        return Value(type, str);
+      }
+      default:
+        UNREACHABLE("Type cannot be normalized.");
+    }
+  }
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Normalized keys (see GenericKey) are compared with a single memcmp; the others deserialize each column into a
+ * Value and compare those.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    if (normalized_) {
+      int cmp = memcmp(lhs.data_, rhs.data_, KeySize);
+      return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+    }
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +322,19 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, normalized_{other.normalized_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema)
+      : key_schema_(key_schema), normalized_(GenericKey<KeySize>::IsNormalizable(key_schema)) {}
+
+  /** @return whether the keys are normalized and compared with memcmp */
+  auto IsNormalized() const -> bool { return normalized_; }
 
  private:
   Schema *key_schema_;
+  bool normalized_;
 };
 
 }  // namespace bustub
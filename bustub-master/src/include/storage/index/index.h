@@ -18,11 +18,13 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
 namespace bustub {
 
+class BufferPoolManager;
 class Transaction;
 
 /**
@@ -32,6 +34,10 @@ class Transaction;
  * index, since the external callers does not know the actual structure of
  * the index key, so it is the index's responsibility to maintain such a
  * mapping relation and does the conversion between tuple key and index key
+ *
+ * A covering index also stores included columns in its entries, behind the key columns. They take no part in
+ * lookups, but let an index-only scan answer queries on them without reading the table. The key schema and key
+ * attributes describe whole entries, key columns first, so that index keys built from table tuples carry them.
  */
 class IndexMetadata {
  public:
@@ -43,10 +49,15 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param include_attrs The base table columns stored in the entries besides the key columns
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, const std::vector<uint32_t> &include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_column_count_(include_attrs.size()) {
+    key_attrs_.insert(key_attrs_.end(), include_attrs.begin(), include_attrs.end());
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -58,18 +69,23 @@ class IndexMetadata {
   /** @return The name of the table on which the index is created */
   inline auto GetTableName() -> const std::string & { return table_name_; }
 
-  /** @return A schema object pointer that represents the indexed key */
+  /** @return A schema object pointer that represents the indexed key, followed by the included columns */
   inline auto GetKeySchema() const -> Schema * { return key_schema_; }
 
   /**
-   * @return The number of columns inside index key (not in tuple key)
+   * @return The number of columns inside index key (not in tuple key), without the included columns
    *
    * NOTE: this must be defined inside the cpp source file because it
    * uses the member of catalog::Schema which is not known here.
    */
-  auto GetIndexColumnCount() const -> std::uint32_t { return static_cast<uint32_t>(key_attrs_.size()); }
+  auto GetIndexColumnCount() const -> std::uint32_t {
+    return static_cast<uint32_t>(key_attrs_.size() - include_column_count_);
+  }
+
+  /** @return The number of included columns, which follow the key columns in the key schema */
+  auto GetIncludeColumnCount() const -> std::uint32_t { return static_cast<uint32_t>(include_column_count_); }
 
-  /** @return The mapping relation between indexed columns and base table columns */
+  /** @return The mapping relation between indexed (and then included) columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
   /** @return A string representation for debugging */
@@ -91,7 +107,9 @@ class IndexMetadata {
   /** The name of the table on which the index is created */
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
-  const std::vector<uint32_t> key_attrs_;
+  std::vector<uint32_t> key_attrs_;
+  /** How many of the key attributes are included columns rather than key columns */
+  const size_t include_column_count_;
   /** The schema of the indexed key */
   Schema *key_schema_;
 };
@@ -130,6 +148,9 @@ class Index {
   /** @return The number of indexed columns */
   auto GetIndexColumnCount() const -> std::uint32_t { return metadata_->GetIndexColumnCount(); }
 
+  /** @return The number of included columns */
+  auto GetIncludeColumnCount() const -> std::uint32_t { return metadata_->GetIncludeColumnCount(); }
+
   /** @return The index name */
   auto GetName() const -> const std::string & { return metadata_->GetName(); }
 
@@ -168,13 +189,61 @@ class Index {
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
   /**
-   * Search the index for the provided key.
+   * Search the index for the provided key. A covering index matches the key columns alone: the included columns of
+   * the key are ignored, and every entry with the same key columns is a result.
    * @param key The index key
    * @param result The collection of RIDs that is populated with results of the search
    * @param transaction The transaction context
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for a batch of keys, as ScanKey() does for each of them. Indexes that can share work between
+   * the keys of a batch override this; by default the keys are looked up one at a time.
+   * @param keys The index keys
+   * @param results Populated with one collection of RIDs per key, in the order of the keys
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), std::vector<RID>{});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  /**
+   * Read index entries without going to the table, for an index-only scan. Only indexes that keep their entries in
+   * key order support this; the others throw a NotImplementedException.
+   * @param key The index key to look up, matched on its key columns alone; nullptr for every entry in key order
+   * @param result The collection that is populated with the matching entries, as tuples in the key schema (key
+   * columns, then included columns), each with the RID it points to
+   * @param transaction The transaction context
+   */
+  virtual void ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result, Transaction *transaction) {
+    throw NotImplementedException("This index type cannot return its entries.");
+  }
+
+  /**
+   * Keep a blocked Bloom filter of the keys in the index (see BloomFilter), which ScanKey() and ScanKeys() consult
+   * first, so that lookups of most missing keys read no leaf or bucket page. Must be called before the index is
+   * shared. Only some indexes support a filter; the others ignore the call.
+   * @param buffer_pool_manager The buffer pool holding the filter pages
+   * @param bits_per_key The size of the filter per key
+   * @return Whether the index keeps a filter from now on
+   */
+  virtual auto EnableBloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key) -> bool {
+    return false;
+  }
+
+  /**
+   * Free the pages of the index when it is dropped; the index is not used again afterwards. Indexes whose pages, if
+   * any, go away with the index object itself do nothing.
+   * @param[out] pinned_page_ids the pages that could not be deleted because they are still pinned, for the caller to
+   * delete later
+   */
+  virtual void Destroy(std::vector<page_id_t> *pinned_page_ids) {}
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -13,31 +13,85 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <deque>
+#include <functional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * Range scan over the leaves of a B+ tree. While it consumes a leaf, the iterator keeps the next PREFETCH_DEPTH leaves
+ * on their way into the buffer pool (see BufferPoolManager::PrefetchPage), so that leaf reads overlap with the scan.
+ * Their page ids come from the parent of the leaf: the tree hands over the children that follow the start leaf, and
+ * whenever the scan steps into a leaf it did not know about, it asks the tree for the children that follow that one.
+ * The ids are only hints; the sibling pointer of each leaf is prefetched as well, and is what the scan follows.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
-  IndexIterator();
+  /** Finds the leaf that holds a key, and appends the page ids of the leaves that follow it under the same parent. */
+  using LeafLookup = std::function<void(const KeyType &key, std::vector<page_id_t> *following)>;
+
+  /** How many leaves ahead of the scan are prefetched. */
+  static constexpr size_t PREFETCH_DEPTH = 8;
+
+  /**
+   * @param buffer_pool_manager the buffer pool the tree lives in
+   * @param page the leaf page to start on, pinned and read-latched by the caller; nullptr for the end iterator.
+   *        The iterator takes over the pin and the latch.
+   * @param index the position in the leaf page to start at
+   * @param following the page ids of the leaves after the start leaf, as far as the caller knows them
+   * @param leaf_lookup looks up the leaves that follow later ones; empty to only prefetch along sibling pointers
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                const std::vector<page_id_t> &following = {}, LeafLookup leaf_lookup = nullptr);
   ~IndexIterator();  // NOLINT
 
+  DISALLOW_COPY(IndexIterator);
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return page_id_ == itr.page_id_ && (page_id_ == INVALID_PAGE_ID || index_ == itr.index_);
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** Skip to the next leaf page while the current one is exhausted. */
+  void SkipExhaustedLeaves();
+  /** Drop the latch and the pin on the current leaf page. */
+  void Release();
+  /**
+   * Forget the known leaves up to the one being entered, which is pinned but not latched. If it was not among them,
+   * look up the leaves that follow it, latching it only for a moment to read its first key.
+   */
+  void Advance(Page *next, page_id_t next_page_id);
+  /** Prefetch the known leaves up to PREFETCH_DEPTH ahead of the current one, or else its right sibling. */
+  void Prefetch();
+
+  BufferPoolManager *buffer_pool_manager_;
+  Page *page_;
+  LeafPage *leaf_;
+  page_id_t page_id_;
+  int index_;
+  /** Page ids of the leaves expected after the current one, in key order. */
+  std::deque<page_id_t> following_;
+  /** How many of the first following_ leaves have been prefetched. */
+  size_t prefetched_;
+  LeafLookup leaf_lookup_;
 };
 
 }  // namespace bustub
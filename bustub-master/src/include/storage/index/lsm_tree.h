@@ -0,0 +1,289 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree.h
+//
+// Identification: src/include/storage/index/lsm_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "storage/index/bloom_filter.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define LSMTREE_TYPE LsmTree<KeyType, ValueType, KeyComparator>
+
+/** Knobs of an LsmTree. */
+struct LsmTreeOptions {
+  /** Number of writes a memtable takes before it is frozen and written out as a run */
+  size_t memtable_entries_{4096};
+  /** Number of runs on level 0 that get them merged into level 1 */
+  size_t level0_runs_{4};
+  /** How many times more entries each level from 1 on holds than the one above it before it is merged down */
+  size_t size_ratio_{8};
+  /** Size of the Bloom filter of each run, in bits per key */
+  size_t bloom_filter_bits_per_key_{10};
+  /** Number of frozen memtables waiting to be written out that makes writers wait */
+  size_t max_frozen_memtables_{2};
+};
+
+/**
+ * A log-structured merge tree: writes go to memory and reach the pages in large sorted batches, so that each insert
+ * costs a fraction of a sequential page write rather than a random leaf write. It maps each key to one value; a
+ * later insert of a key replaces its value, and a remove writes a tombstone that hides the older values.
+ *
+ * Writes go to the memtable, a skiplist that concurrent writers insert into without latches (see MemTable). Once
+ * full, the memtable is frozen and a new one takes the writes, while a background thread writes the frozen one out
+ * as a sorted run: pages of entries in key order, written one after the other, with the first key of each page and a
+ * Bloom filter of all its keys kept aside. The runs form levels. Level 0 holds the runs written from memtables,
+ * whose keys overlap; once it has level0_runs_ of them, they are merged with the run of level 1. Each further level
+ * holds a single run, which is merged into the next level once it outgrows size_ratio_ times the level above it
+ * (leveled compaction). Tombstones are dropped when merged into the last level.
+ *
+ * A lookup checks the memtable, the frozen memtables and then the runs from the newest to the oldest, skipping the
+ * runs whose Bloom filter rules the key out, and stops at the first entry of the key. A scan merges all of them in
+ * key order, taking the newest entry of each key. Both work on a snapshot of the memtables and runs (a Version), so
+ * the background thread never waits for them; a run replaced by a merge is deleted once no snapshot holds it.
+ *
+ * Nothing is logged and the list of runs is only kept in memory, so the tree does not outlive the process; like
+ * AdaptiveRadixTree, it is rebuilt from the table.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LsmTree {
+ public:
+  LsmTree(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, LsmTreeOptions options = {});
+
+  ~LsmTree();
+
+  DISALLOW_COPY_AND_MOVE(LsmTree);
+
+  // Map a key to a value, replacing its value if it has one.
+  void Insert(const KeyType &key, const ValueType &value);
+
+  // Remove a key and its value from this tree.
+  void Remove(const KeyType &key);
+
+  // return the value associated with a given key
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Call a function with the pairs of the tree in key order, starting at the first key not less than low, until it
+   * returns false. The runs are those of when the scan started; writes during the scan may or may not be seen.
+   * @param low the key to start at, or nullptr to start at the first key
+   * @param fn called with each key and its value; returns whether to go on
+   */
+  void Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn);
+
+  /** Write out the memtable and wait until the background thread has nothing left to flush or merge. */
+  void Flush();
+
+  /** @return the number of runs on each level, from level 0 on */
+  auto GetRunCounts() -> std::vector<size_t>;
+
+ private:
+  /** An entry of the memtables and runs: a value, or a tombstone. */
+  struct Entry {
+    KeyType key_;
+    ValueType value_;
+    bool deleted_;
+  };
+
+  /**
+   * A skiplist ordered by key and, for each key, from the newest write to the oldest. Writers never update a node:
+   * each write links a new node, level by level from the bottom, with a compare-and-swap on the predecessor's link,
+   * searching again if it lost a race. Nodes are only freed with the memtable, so readers follow links freely.
+   */
+  class MemTable {
+   public:
+    explicit MemTable(const KeyComparator &comparator) : comparator_(comparator) {}
+
+    ~MemTable();
+
+    DISALLOW_COPY_AND_MOVE(MemTable);
+
+    void Put(const Entry &entry, uint64_t sequence);
+
+    /** @return the newest entry of a key, or nullptr */
+    auto Find(const KeyType &key) const -> const Entry *;
+
+    /** @return the number of writes taken */
+    auto GetSize() const -> size_t { return size_; }
+
+   private:
+    friend class LsmTree;
+    static constexpr int MAX_HEIGHT = 12;
+
+    struct Node {
+      Entry entry_;
+      uint64_t sequence_;
+      int height_;
+      std::atomic<Node *> next_[MAX_HEIGHT]{};
+    };
+
+    /** @return whether a node sorts before the given key and sequence */
+    auto Before(const Node *node, const KeyType &key, uint64_t sequence) const -> bool;
+
+    /** Find the last node before (key, sequence) and the one after it, on each level. */
+    void FindPosition(const KeyType &key, uint64_t sequence, Node **preds, Node **succs) const;
+
+    /** @return the first node of the first key not less than the given one, or nullptr */
+    auto LowerBound(const KeyType *key) const -> const Node *;
+
+    KeyComparator comparator_;
+    Node head_{};
+    std::atomic<size_t> size_{0};
+  };
+
+  /** A sorted run: one entry per key, in key order, in pages of its own that are never changed once written. */
+  class Run {
+   public:
+    /**
+     * Write a run.
+     * @param next produces the entries in key order; returns false once there are no more
+     */
+    Run(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, size_t bits_per_key,
+        const std::function<bool(Entry *)> &next);
+
+    ~Run();
+
+    DISALLOW_COPY_AND_MOVE(Run);
+
+    /** Look a key up. @return false if the run has no entry of the key */
+    auto Find(const KeyType &key, Entry *entry) const -> bool;
+
+    /** Read the entries of one page of the run. */
+    void ReadPage(size_t page_index, std::vector<Entry> *entries) const;
+
+    /** @return the index of the page that holds the key if any run page does */
+    auto FindPage(const KeyType &key) const -> size_t;
+
+    auto GetPageCount() const -> size_t { return page_ids_.size(); }
+    auto GetSize() const -> size_t { return size_; }
+
+   private:
+    /** Header of a run page. The entries follow it. */
+    struct RunPageHeader {
+      int size_;
+    };
+
+    static constexpr int RUN_PAGE_CAPACITY = static_cast<int>((PAGE_SIZE - sizeof(RunPageHeader)) / sizeof(Entry));
+
+    static auto Header(Page *page) -> RunPageHeader * { return reinterpret_cast<RunPageHeader *>(page->GetData()); }
+    static auto Entries(Page *page) -> Entry * {
+      return reinterpret_cast<Entry *>(page->GetData() + sizeof(RunPageHeader));
+    }
+
+    auto FetchRunPage(size_t page_index) const -> Page *;
+
+    BufferPoolManager *buffer_pool_manager_;
+    KeyComparator comparator_;
+    std::vector<page_id_t> page_ids_;
+    /** The first key of each page */
+    std::vector<KeyType> first_keys_;
+    size_t size_{0};
+    std::unique_ptr<BloomFilter> bloom_filter_;
+  };
+
+  /** The memtables and runs at one point in time. Versions are never changed; a change installs a new one. */
+  struct Version {
+    std::shared_ptr<MemTable> memtable_;
+    /** Frozen memtables waiting to be written out, oldest first */
+    std::vector<std::shared_ptr<MemTable>> frozen_;
+    /** The runs of each level; level 0 oldest first, the other levels at most one run each */
+    std::vector<std::vector<std::shared_ptr<Run>>> levels_;
+  };
+
+  /** Read position in a memtable or a run, on the newest entry of each key. */
+  class Cursor {
+   public:
+    Cursor(const MemTable *memtable, const KeyType *low);
+    Cursor(const Run *run, const KeyType *low, const KeyComparator &comparator);
+
+    auto IsValid() const -> bool;
+    auto Get() const -> const Entry &;
+    void Next();
+
+   private:
+    /** Move to the next page once past the last entry of this one. */
+    void LoadPage();
+
+    const MemTable *memtable_{nullptr};
+    const typename MemTable::Node *node_{nullptr};
+    const Run *run_{nullptr};
+    size_t page_index_{0};
+    size_t slot_{0};
+    std::vector<Entry> entries_;
+  };
+
+  /** Write an entry into the memtable, freezing it if it is full. */
+  void Write(const Entry &entry);
+
+  /** Freeze the memtable if it still is the given one, once fewer than max_frozen_memtables_ memtables are frozen. */
+  void Freeze(const MemTable *memtable, bool wait_for_room);
+
+  auto GetVersion() -> std::shared_ptr<const Version>;
+
+  /** Install a new version; needs version_latch_ held. */
+  void InstallVersion(std::unique_ptr<Version> version);
+
+  /**
+   * Get the next entry of a merge of cursors, ordered newest first, in key order: the newest entry of the smallest
+   * key that any cursor is on. The cursors move past the key.
+   * @return false once the cursors are all at their end
+   */
+  auto MergeNext(std::vector<Cursor> *cursors, bool drop_tombstones, Entry *entry) -> bool;
+
+  /** @return the cursors of every memtable and run of a version, newest first */
+  auto OpenCursors(const Version &version, const KeyType *low) -> std::vector<Cursor>;
+
+  /** @return the level whose runs are due to be merged into the next one, or -1 */
+  auto PickCompaction(const Version &version) const -> int;
+
+  /** Write out the oldest frozen memtable or merge a level down, whichever is due. */
+  void CompactionLoop();
+
+  /** @return the run merged from the runs of a level and of the next one, nullptr if nothing is left of them */
+  auto Compact(const Version &version, size_t level) -> std::shared_ptr<Run>;
+
+  /** @return a new run of the given entries, nullptr if there are none */
+  auto NewRun(const std::function<bool(Entry *)> &next) -> std::shared_ptr<Run>;
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  LsmTreeOptions options_;
+  std::atomic<uint64_t> next_sequence_{0};
+
+  /** Held shared while writing into the memtable and exclusively while freezing it. */
+  ReaderWriterLatch memtable_latch_;
+  /** The memtable taking the writes; changes under memtable_latch_ and version_latch_. */
+  MemTable *memtable_;
+
+  /** Protects version_, stop_ and the background thread. */
+  std::mutex version_latch_;
+  std::shared_ptr<const Version> version_;
+  /** Signalled when the background thread has work or should stop. */
+  std::condition_variable work_cv_;
+  /** Signalled when the background thread has finished a flush or a merge. */
+  std::condition_variable done_cv_;
+  bool stop_{false};
+  bool busy_{false};
+  std::thread compaction_thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree_index.h
+//
+// Identification: src/include/storage/index/lsm_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/index/index.h"
+#include "storage/index/lsm_tree.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define LSMTREE_INDEX_TYPE LsmTreeIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * An index kept in an LsmTree, for tables that take many more inserts than lookups. Like AdaptiveRadixTreeIndex, it
+ * is filled from the table heap by Catalog::CreateIndex(). Keys are unique and InsertEntry() does not look for the
+ * key first: inserting a key that is already there replaces its RID.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LsmTreeIndex : public Index {
+ public:
+  LsmTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+               LsmTreeOptions options = {});
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result, Transaction *transaction) override;
+
+  /** Call a function with the pairs from the first key not less than low on, see LsmTree::Scan(). */
+  void Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn) {
+    container_.Scan(low, fn);
+  }
+
+  /** Write out the memtable and wait for the merges it makes due, see LsmTree::Flush(). */
+  void Flush() { container_.Flush(); }
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  LsmTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_link_tree_page.h
+//
+// Identification: src/include/storage/page/b_link_tree_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <utility>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_LINK_TREE_PAGE_TYPE BLinkTreePage<KeyType, ValueType, KeyComparator>
+#define B_LINK_TREE_PAGE_HEADER_SIZE (32 + sizeof(KeyType))
+#define B_LINK_TREE_LEAF_PAGE_SIZE \
+  static_cast<int>((PAGE_SIZE - B_LINK_TREE_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, ValueType>))
+#define B_LINK_TREE_INTERNAL_PAGE_SIZE \
+  static_cast<int>((PAGE_SIZE - B_LINK_TREE_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>))
+
+/**
+ * A node of a B-link tree (see BLinkTree). Leaves map keys to values, internal pages map keys to child page ids;
+ * both use this page, with ValueType = page_id_t for the latter.
+ *
+ * Every node links to its right sibling on the same level and carries a high key, which no key on the node reaches
+ * (the rightmost node of a level has none). A search that arrives at a node after it split finds its key at or past
+ * the high key and follows the right link. Like in BPlusTreeInternalPage, the first key of an internal page is
+ * invalid: PAGE_ID(i) covers the keys K(i) <= K < K(i+1), and the last child the keys up to the high key.
+ *
+ * Page format (keys are stored in order):
+ *  ----------------------------------------------------------------------
+ * | HEADER | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 32 + sizeof(KeyType) bytes in total):
+ *  ----------------------------------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) | Level (4) | PageId (4) | RightPageId (4)
+ *  ----------------------------------------------------------------------------------------------
+ *  ---------------------------------
+ * | HasHighKey (4) | HighKey
+ *  ---------------------------------
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BLinkTreePage {
+ public:
+  // must call initialize method after "create" a new node; leaves are on level 0
+  void Init(page_id_t page_id, int level, int max_size);
+
+  auto IsLeafPage() const -> bool;
+  auto GetLevel() const -> int;
+  auto GetSize() const -> int;
+  auto GetMaxSize() const -> int;
+  auto GetPageId() const -> page_id_t;
+  auto GetRightPageId() const -> page_id_t;
+  auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+
+  // whether the key lies past the high key, i.e. a search for it has to follow the right link
+  auto IsBeyond(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
+  // leaf lookup and changes
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto Remove(const KeyType &key, const KeyComparator &comparator) -> bool;
+
+  // internal lookup
+  auto ChildFor(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+
+  // insert in key order; returns the new size
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  // first half of a split: move the upper half into the empty sibling and link it in on the right
+  void MoveHalfTo(BLinkTreePage *recipient);
+
+ private:
+  IndexPageType page_type_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  int level_;
+  page_id_t page_id_;
+  page_id_t right_page_id_;
+  int has_high_key_;
+  KeyType high_key_;
+  // Flexible array member for page data.
+  MappingType array_[1];
+};
+
+}  // namespace bustub
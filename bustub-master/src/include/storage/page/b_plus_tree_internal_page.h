@@ -11,14 +11,17 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE (28 + 2 * sizeof(KeyType))
+#define INTERNAL_PAGE_ENTRY_SIZE (sizeof(uint64_t) + sizeof(page_id_t) + sizeof(uint16_t))
+// The most entries that fit, which is when no key needs more than its 8-byte head; one more for a page about to split
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(uint64_t)) / INTERNAL_PAGE_ENTRY_SIZE - 1)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -27,28 +30,59 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Keys are stored compressed. The page records the fence keys of its subtree, i.e. the separators its parent keeps
+ * on either side of it (missing at the left and right edges of the tree), and KeyAt(0) returns the low fence. Every
+ * key that can ever land on the page lies between the fences, so with normalized keys (see GenericKey) it shares
+ * their common prefix, which is left out of the entries. Of the rest, trailing zero bytes are dropped; separators
+ * chosen by the tree are truncated to the shortest key that still separates the children, so they end in many.
+ * Each remaining suffix is split into an 8-byte head, searched with KeySearch, and a tail stored behind the entries.
+ *
+ * Internal page format (the entry arrays start 8-aligned, key tails are stored in order):
+ *  ------------------------------------------------------------------------------------------------
+ * | HEADER | HEAD(1) ... HEAD(n) | PAGE_ID(1) ... PAGE_ID(n) | TAIL_END(1) ... TAIL_END(n) | TAILS |
+ *  ------------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 28 + 2 * sizeof(KeyType) bytes in total):
+ *  ------------------------------------------------------------------------------------------------
+ * | BPlusTreePage header (24) | PrefixSize (2) | Fences (1) | CompressPrefix (1) | LowFence | HighFence |
+ *  ------------------------------------------------------------------------------------------------
+ *
+ * The entries are rewritten as a whole by every change, which is cheap next to how rarely internal pages change.
+ * Since their size varies, a page is full (IsOverflow()) or underfull (IsUnderflow()) by the space it uses as well
+ * as by its entry count.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  // compress_prefix leaves out the prefix of the fences, which takes keys that compare bytewise
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool compress_prefix = false);
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
   auto ValueIndex(const ValueType &value) const -> int;
   auto ValueAt(int index) const -> ValueType;
 
+  // set a fence, e.g. while building a tree bottom-up
+  void SetLowFence(const KeyType &key);
+  void SetHighFence(const KeyType &key);
+
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
   void Remove(int index);
   auto RemoveAndReturnOnlyChild() -> ValueType;
 
+  // fullness, by entry count and by space
+  auto IsOverflow() const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto CanInsert(int fill_factor = 100) const -> bool;
+  auto CanRemove() const -> bool;
+  auto CanSetKeyAt(int index, const KeyType &key) const -> bool;
+  auto CanMerge(const BPlusTreeInternalPage *right, const KeyType &middle_key) const -> bool;
+  auto CanBorrow(const BPlusTreeInternalPage *sibling, const KeyType &middle_key, bool from_right) const -> bool;
+
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
@@ -56,12 +90,34 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
+  // Append a child after the last one, e.g. while building a tree bottom-up; the key of a first child is ignored
+  void AppendChild(const KeyType &key, const ValueType &child, BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  static constexpr uint8_t LOW_FENCE = 1;
+  static constexpr uint8_t HIGH_FENCE = 2;
+
+  auto Heads() const -> const uint64_t *;
+  auto Children() const -> const ValueType *;
+  auto TailEnds() const -> const uint16_t *;
+  auto Tails() const -> const char *;
+  auto TailOf(int index, int *length) const -> const char *;
+  auto GetUsedSpace() const -> size_t;
+  static auto GetSpaceLimit() -> size_t;
+  static auto GetMaxEntrySize() -> size_t;
+
+  auto GetPrefixSize(uint8_t fences, const KeyType &low, const KeyType &high) const -> int;
+  auto EncodedSize(const std::vector<MappingType> &entries, int prefix_size) const -> size_t;
+  auto Entries() const -> std::vector<MappingType>;
+  void Rebuild(const std::vector<MappingType> &entries);
+  void Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager);
+
+  uint16_t prefix_size_;
+  uint8_t fences_;
+  uint8_t compress_prefix_;
+  KeyType low_fence_;
+  KeyType high_fence_;
   // Flexible array member for page data.
-  MappingType array_[1];
+  char entries_[1];
 };
 }  // namespace bustub
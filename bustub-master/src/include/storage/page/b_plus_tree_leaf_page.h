@@ -19,7 +19,9 @@ namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+// Room for one spare slot plus an 8-byte key prefix per slot, see below
+#define LEAF_PAGE_SIZE \
+  ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(uint64_t)) / (sizeof(MappingType) + sizeof(uint64_t)) - 1)
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -38,6 +40,10 @@ namespace bustub {
  *  -----------------------------------------------
  * | ParentPageId (4) | PageId (4) | NextPageId (4)
  *  -----------------------------------------------
+ *
+ * Behind the last slot, the page keeps the 8-byte prefix of every key (see GenericKey::GetPrefix()) in a contiguous
+ * array, so that KeyIndex() can search normalized keys with SIMD instructions (see KeySearch) and only compare full
+ * keys among those sharing a prefix.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -64,6 +70,10 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
+  auto Prefixes() const -> const uint64_t *;
+  auto Prefixes() -> uint64_t *;
+  void SetItem(int index, const MappingType &item);
+  void MoveItems(int first, int last, int dest);
   void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
@@ -33,6 +33,10 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ * Every slot also has a one-byte tag, a part of the key's hash that the caller passes along with the key. Lookups
+ * compare the tags of BUCKET_TAG_GROUP slots at once (with SSE2 where available) and call the comparator only on
+ * slots whose tag matches. Tags are only a filter: a caller without a hash may pass the same tag for every key, at
+ * the cost of comparing every key, but it must pass equal tags for equal keys.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -43,9 +47,15 @@ class HashTableBucketPage {
   /**
    * Scan the bucket and collect values that have the matching key
    *
+   * @param tag the tag of the key
    * @return true if at least one key matched
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result, uint8_t tag = 0) -> bool;
+
+  /**
+   * Prefetches the occupied_, readable_ and tags_ arrays into the CPU cache, ahead of a GetValue() that reads them.
+   */
+  void PrefetchMetadata() const;
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -53,16 +63,18 @@ class HashTableBucketPage {
    *
    * @param key key to insert
    * @param value value to insert
+   * @param tag the tag of the key
    * @return true if inserted, false if duplicate KV pair or bucket is full
    */
-  auto Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t tag = 0) -> bool;
 
   /**
    * Removes a key and value.
    *
+   * @param tag the tag of the key
    * @return true if removed, false if not found
    */
-  auto Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t tag = 0) -> bool;
 
   /**
    * Gets the key at an index in the bucket.
@@ -80,6 +92,14 @@ class HashTableBucketPage {
    */
   auto ValueAt(uint32_t bucket_idx) const -> ValueType;
 
+  /**
+   * Gets the tag at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the tag at
+   * @return tag at index bucket_idx of the bucket
+   */
+  auto TagAt(uint32_t bucket_idx) const -> uint8_t;
+
   /**
    * Remove the KV pair at bucket_idx
    */
@@ -138,10 +158,23 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /**
+   * @param group_idx the index of the first slot of a group of BUCKET_TAG_GROUP slots
+   * @return a mask with bit i set if slot group_idx + i is readable and has the given tag
+   */
+  auto MatchTag(uint32_t group_idx, uint8_t tag) const -> uint32_t;
+
+  /**
+   * @return the index of the first slot that does not hold a pair, or BUCKET_ARRAY_SIZE if there is none
+   */
+  auto FirstFreeSlot() const -> uint32_t;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // the tag of each slot, padded to whole groups so that every group can be loaded at once
+  uint8_t tags_[(BUCKET_ARRAY_SIZE + BUCKET_TAG_GROUP - 1) / BUCKET_TAG_GROUP * BUCKET_TAG_GROUP];
   MappingType array_[1];
 };
 
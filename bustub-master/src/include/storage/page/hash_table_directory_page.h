@@ -27,9 +27,13 @@ namespace bustub {
  * Directory Page for extendible hash table.
  *
  * Directory format (size in byte):
- * --------------------------------------------------------------------------------------------
- * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
- * --------------------------------------------------------------------------------------------
+ * ----------------------------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | BucketCounts(132) | Free(1392)
+ * ----------------------------------------------------------------------------------------------------------------
+ *
+ * A directory of more than DIRECTORY_ARRAY_SIZE entries is a tree of such pages, which ExtendibleHashTable walks:
+ * the head keeps the global depth and the bucket counts, and the BucketPageIds of the head and of inner pages hold
+ * the page ids of the pages one level down. Only the leaves use LocalDepths.
  */
 class HashTableDirectoryPage {
  public:
@@ -113,6 +117,14 @@ class HashTableDirectoryPage {
    */
   auto GetGlobalDepth() -> uint32_t;
 
+  /**
+   * Set the global depth of the directory, leaving the entries as they are. For the head of a directory that spans
+   * several pages, whose caller rearranges the pages below.
+   *
+   * @param global_depth the new global depth
+   */
+  void SetGlobalDepth(uint32_t global_depth);
+
   /**
    * Increment the global depth of the directory
    */
@@ -171,6 +183,28 @@ class HashTableDirectoryPage {
    */
   auto GetLocalHighBit(uint32_t bucket_idx) -> uint32_t;
 
+  /**
+   * Copy the local depths and bucket page ids of another directory page into this one. The page id, LSN, global
+   * depth and bucket counts stay as they are.
+   *
+   * @param other the page to copy from
+   */
+  void CopyEntriesFrom(const HashTableDirectoryPage *other);
+
+  /**
+   * @param local_depth a local depth
+   * @return the number of buckets of that local depth, as kept up to date by the hash table
+   */
+  auto GetBucketCount(uint32_t local_depth) -> uint32_t;
+
+  /**
+   * Add to the number of buckets of a local depth. A directory can shrink once no bucket is as deep as it.
+   *
+   * @param local_depth the local depth
+   * @param delta the number of buckets that were added (or removed, if negative)
+   */
+  void UpdateBucketCount(uint32_t local_depth, int32_t delta);
+
   /**
    * VerifyIntegrity
    *
@@ -192,6 +226,7 @@ class HashTableDirectoryPage {
   uint32_t global_depth_{0};
   uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+  uint32_t bucket_counts_[DIRECTORY_MAX_DEPTH + 1];
 };
 
 }  // namespace bustub
@@ -26,10 +26,13 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 32 bytes in total, followed by the block page ids):
+ * --------------------------------------------------------------------------------------------
+ * | LSN (4) | Padding(4) | Size (8) | PageId(4) | NextPageId(4) | NextBlockIndex(8) | BlockPageIds
+ * --------------------------------------------------------------------------------------------
+ *
+ * A header with HEADER_ARRAY_SIZE blocks fills its page; a table of more blocks chains further header pages through
+ * NextPageId, the first one holding the size of the whole table.
  */
 class HashTableHeaderPage {
  public:
@@ -57,6 +60,18 @@ class HashTableHeaderPage {
    */
   void SetPageId(page_id_t page_id);
 
+  /**
+   * @return the page ID of the next header page of the table, or INVALID_PAGE_ID
+   */
+  auto GetNextPageId() const -> page_id_t;
+
+  /**
+   * Sets the page ID of the next header page of the table
+   *
+   * @param next_page_id the page id of the next header page, or INVALID_PAGE_ID
+   */
+  void SetNextPageId(page_id_t next_page_id);
+
   /**
    * @return the lsn of this page
    */
@@ -90,12 +105,13 @@ class HashTableHeaderPage {
   auto NumBlocks() -> size_t;
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  size_t next_ind_;
   // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  page_id_t block_page_ids_[1];
 };
 
 }  // namespace bustub
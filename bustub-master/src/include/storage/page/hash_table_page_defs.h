@@ -28,17 +28,37 @@
  */
 #define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
+/**
+ * HEADER_ARRAY_SIZE is the number of block page ids that fit into a linear probe hash header page, behind its 32 bytes
+ * of fields.
+ */
+#define HEADER_ARRAY_SIZE ((PAGE_SIZE - 32) / sizeof(page_id_t))
+
 /**
  * Extendible Hashing Definitions
  */
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
 
+/**
+ * A directory larger than DIRECTORY_ARRAY_SIZE entries spreads over a tree of directory pages, each of which resolves
+ * DIRECTORY_LEVEL_DEPTH bits of the directory index (see ExtendibleHashTable). The global depth goes up to
+ * DIRECTORY_MAX_DEPTH, the width of the hash the directory is indexed with.
+ */
+#define DIRECTORY_LEVEL_DEPTH 9
+#define DIRECTORY_MAX_DEPTH 32
+
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_, and a byte for its tag in tags_.
+ * 4 * (PAGE_SIZE - 32) / (4 * sizeof (MappingType) + 5) = (PAGE_SIZE - 32)/(sizeof (MappingType) + 1.25) because
+ * 1.25 bytes = 10 bits is the space required to maintain the flags and the tag for a key value pair. The 32 bytes
+ * held back cover rounding tags_ up to whole SIMD registers and aligning the pairs behind it.
+ */
+#define BUCKET_ARRAY_SIZE (4 * (PAGE_SIZE - 32) / (4 * sizeof(MappingType) + 5))
+
+/**
+ * BUCKET_TAG_GROUP is the number of tags that an extendible hashing bucket page compares at once.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_TAG_GROUP 16
@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/page/key_search.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+namespace bustub {
+
+/** The instruction set used to search the key prefixes of a B+ tree page. */
+enum class KeySearchKernel { SCALAR, SSE42, AVX2 };
+
+/**
+ * Search a sorted array of 8-byte key prefixes (see GenericKey::GetPrefix()) as kept by B+ tree pages.
+ *
+ * A binary search narrows the range down to a few cache lines, which are then compared against the target all at
+ * once with SIMD instructions. The widest kernel the CPU supports is picked at startup.
+ */
+class KeySearch {
+ public:
+  /** @return the index of the first prefix >= target in prefixes[0, size) */
+  static auto LowerBound(const uint64_t *prefixes, int size, uint64_t target) -> int;
+
+  /** @return the index of the first prefix > target in prefixes[0, size) */
+  static auto UpperBound(const uint64_t *prefixes, int size, uint64_t target) -> int;
+
+  /** @return the kernel in use */
+  static auto GetKernel() -> KeySearchKernel;
+
+  /** @return whether the CPU supports the kernel */
+  static auto IsSupported(KeySearchKernel kernel) -> bool;
+
+  /**
+   * Switch kernels, for tests and benchmarks. Searches already running finish with the kernel they started with.
+   * @return false, leaving the kernel unchanged, if the CPU does not support the kernel
+   */
+  static auto SetKernel(KeySearchKernel kernel) -> bool;
+};
+
+}  // namespace bustub
@@ -138,6 +138,15 @@ class TablePage : public Page {
    */
   auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
 
+  /**
+   * @param tuple the tuple to be inserted
+   * @param reserved the number of bytes that must stay free after the insertion
+   * @return true if the tuple fits into this page and leaves at least reserved bytes free
+   */
+  auto HasRoomFor(const Tuple &tuple, uint32_t reserved) -> bool {
+    return GetFreeSpaceRemaining() >= tuple.GetLength() + SIZE_TUPLE + reserved;
+  }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -12,7 +12,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -20,6 +28,17 @@
 
 namespace bustub {
 
+/** How TableHeap::InsertTuple picks the page for a new tuple. */
+enum class InsertMode {
+  /** Walk the chain from the first page and take the first page with enough space. */
+  FreeSpaceFirst,
+  /**
+   * Every inserting thread fills a private tail page taken from extents of fresh pages linked at the end of the
+   * chain, so concurrent inserts touch different pages and rows stay grouped by insertion time.
+   */
+  Append
+};
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
@@ -108,11 +127,120 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * Snapshot the ids of all pages in the table, in chain order. Pages linked after the call are not included.
+   * This lets callers such as ANALYZE split the table into page ranges without walking the chain themselves.
+   * @return the page ids of this table
+   */
+  auto GetPageIds() -> std::vector<page_id_t>;
+
+  /** @return the number of tuples inserted into this table since it was opened */
+  inline auto GetInsertCount() const -> uint64_t { return insert_count_.load(); }
+
+  /** @return the number of tuples deleted from this table since it was opened (net of rolled back deletes) */
+  inline auto GetDeleteCount() const -> uint64_t { return delete_count_.load(); }
+
+  /** @return the buffer pool manager backing this table */
+  inline auto GetBufferPoolManager() const -> BufferPoolManager * { return buffer_pool_manager_; }
+
+  /** @return the lock manager in use by this table */
+  inline auto GetLockManager() const -> LockManager * { return lock_manager_; }
+
+  /** Default number of pages linked at once in InsertMode::Append. */
+  static constexpr uint32_t DEFAULT_EXTENT_PAGES = 8;
+
+  /**
+   * Choose how InsertTuple picks pages.
+   * @param mode the insert mode
+   * @param extent_pages InsertMode::Append only: the number of fresh pages linked at the end of the chain at once
+   * @param fill_factor InsertMode::Append only: the percentage of a page filled by inserts; the rest is left free
+   * for updates that grow tuples in place
+   */
+  void SetInsertMode(InsertMode mode, uint32_t extent_pages = DEFAULT_EXTENT_PAGES, uint32_t fill_factor = 100);
+
+  /** @return the current insert mode */
+  inline auto GetInsertMode() const -> InsertMode { return insert_mode_.load(); }
+
+  /** @return the log manager in use by this table */
+  inline auto GetLogManager() const -> LogManager * { return log_manager_; }
+
+  /**
+   * Start recording the RIDs touched by writes. This lets a copy of the table taken while it is being modified
+   * (see TableClusterer) be brought up to date afterwards.
+   */
+  void StartChangeCapture();
+
+  /** @return the RIDs written since StartChangeCapture() or the previous call, in write order and possibly repeated */
+  auto DrainCapturedChanges() -> std::vector<RID>;
+
+  /** Stop recording writes and drop the changes that were not drained. */
+  void StopChangeCapture();
+
+  /** Wait for in-flight writes to finish and hold off new ones until UnblockWriters() is called. */
+  void BlockWriters();
+
+  /** Let writes proceed again. */
+  void UnblockWriters();
+
+  /**
+   * Reject every later InsertTuple, MarkDelete and UpdateTuple by aborting the writing transaction. Used once the
+   * table has been replaced by a rewritten copy; must be called between BlockWriters() and UnblockWriters().
+   */
+  void Retire();
+
  private:
+  /** Record a page that was just linked to the end of the chain. */
+  void AppendPageId(page_id_t page_id);
+
+  /** Record a written RID if change capture is on. */
+  void CaptureChange(const RID &rid);
+
+  /** Update the counters, change capture and write set after a successful insert. */
+  void RecordInsert(const RID &rid, Transaction *txn);
+
+  /** Insert a tuple into the calling thread's tail page (InsertMode::Append). */
+  auto AppendTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+
+  /**
+   * Replace a thread's tail with a fresh page, linking a new extent if needed.
+   * @return the new tail, or INVALID_PAGE_ID on failure (the thread is then left without a tail)
+   */
+  auto TakeExtentPage(Transaction *txn, std::thread::id thread_id) -> page_id_t;
+
+  /** Link a fresh page at the end of the chain. @return its id, or INVALID_PAGE_ID on failure */
+  auto LinkNewPage(Transaction *txn) -> page_id_t;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+
+  /** Protects page_ids_. */
+  std::mutex page_ids_latch_;
+  /** Every page of the table in chain order, kept in memory so page ranges can be handed out without I/O. */
+  std::vector<page_id_t> page_ids_;
+  /** Modification counters, used to decide when table statistics are stale. */
+  std::atomic<uint64_t> insert_count_{0};
+  std::atomic<uint64_t> delete_count_{0};
+
+  std::atomic<InsertMode> insert_mode_{InsertMode::FreeSpaceFirst};
+  std::atomic<uint32_t> extent_pages_{DEFAULT_EXTENT_PAGES};
+  std::atomic<uint32_t> fill_factor_{100};
+  /** Protects free_extent_pages_ and tail_pages_, and serializes extent allocation. */
+  std::mutex extent_latch_;
+  /** Linked pages no thread has taken as its tail yet, in chain order. */
+  std::deque<page_id_t> free_extent_pages_;
+  /** The tail page of every thread that inserted in InsertMode::Append; entries go away with the heap. */
+  std::unordered_map<std::thread::id, page_id_t> tail_pages_;
+
+  /** Held in read mode by every write, in write mode by BlockWriters(). */
+  ReaderWriterLatch writers_latch_;
+  /** Set by Retire(); protected by writers_latch_. */
+  bool retired_{false};
+  /** Protects captured_rids_. */
+  std::mutex capture_latch_;
+  std::atomic<bool> capturing_{false};
+  std::vector<RID> captured_rids_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,762 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType>
+ART_TYPE::Node::Node(NodeType type, const uint8_t *prefix, size_t prefix_length)
+    : type_(type), prefix_length_(static_cast<uint32_t>(prefix_length)) {
+  if (prefix_length > 0) {
+    memcpy(prefix_, prefix, prefix_length);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+ART_TYPE::AdaptiveRadixTree() : root_(new Node256(nullptr, 0)) {}
+
+template <typename KeyType, typename ValueType>
+ART_TYPE::~AdaptiveRadixTree() {
+  DeleteChild(ToChild(root_));
+  for (auto &garbage : garbage_) {
+    for (Child child : garbage) {
+      FreeRetired(child);
+    }
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  bool found;
+  while (true) {
+    EpochGuard guard(this);
+    if (TryGetValue(key, result, &found)) {
+      return found;
+    }
+    std::this_thread::yield();
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::TryGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found) -> bool {
+  const uint8_t *bytes = KeyBytes(key);
+  const Node *node = root_;
+  size_t depth = 0;
+  *found = false;
+  while (true) {
+    uint64_t version;
+    if (!ReadLock(node, &version)) {
+      return false;
+    }
+    if (MatchPrefix(node, bytes, depth) < node->prefix_length_) {
+      return Validate(node, version);
+    }
+    depth += node->prefix_length_;
+    Child child = FindChild(node, bytes[depth]);
+    if (!Validate(node, version)) {
+      return false;
+    }
+    if (child == 0) {
+      return true;
+    }
+    if (IsLeaf(child)) {
+      const Leaf *leaf = AsLeaf(child);
+      if (memcmp(KeyBytes(leaf->key_), bytes, KEY_SIZE) == 0) {
+        result->push_back(leaf->value_);
+        *found = true;
+      }
+      return true;
+    }
+    node = AsNode(child);
+    depth++;
+  }
+}
+
+/*
+ * The scan copies the children of each node and validates the copy before it descends, so it never holds a lock. A
+ * child that was replaced in the meantime is obsolete by the time the scan reads it; the scan then starts over from
+ * the root, just past the last key it returned.
+ */
+template <typename KeyType, typename ValueType>
+void ART_TYPE::Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn) {
+  KeyType bound{};
+  bool has_bound = low != nullptr;
+  if (has_bound) {
+    bound = *low;
+  }
+  bool inclusive = true;
+  while (true) {
+    EpochGuard guard(this);
+    ScanState state{fn, inclusive};
+    if (ScanNode(root_, 0, has_bound ? KeyBytes(bound) : nullptr, &state) != ScanResult::RESTART) {
+      return;
+    }
+    if (state.emitted_) {
+      bound = state.last_;
+      has_bound = true;
+      inclusive = false;
+    }
+    std::this_thread::yield();
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::ScanNode(Node *node, size_t depth, const uint8_t *bound, ScanState *state) -> ScanResult {
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return ScanResult::RESTART;
+  }
+  if (bound != nullptr) {
+    // the keys below the node all start with its prefix
+    int cmp = memcmp(node->prefix_, bound + depth, node->prefix_length_);
+    if (cmp < 0) {
+      return ScanResult::CONTINUE;
+    }
+    if (cmp > 0) {
+      bound = nullptr;
+    }
+  }
+  depth += node->prefix_length_;
+  uint8_t bytes[256];
+  Child children[256];
+  size_t count = ListChildren(node, bound != nullptr ? bound[depth] : 0, bytes, children);
+  if (!Validate(node, version)) {
+    return ScanResult::RESTART;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t *child_bound = bound != nullptr && bytes[i] == bound[depth] ? bound : nullptr;
+    if (!IsLeaf(children[i])) {
+      ScanResult result = ScanNode(AsNode(children[i]), depth + 1, child_bound, state);
+      if (result != ScanResult::CONTINUE) {
+        return result;
+      }
+      continue;
+    }
+    const Leaf *leaf = AsLeaf(children[i]);
+    if (child_bound != nullptr) {
+      int cmp = memcmp(KeyBytes(leaf->key_), child_bound, KEY_SIZE);
+      if (cmp < 0 || (cmp == 0 && !state->inclusive_)) {
+        continue;
+      }
+    }
+    state->last_ = leaf->key_;
+    state->emitted_ = true;
+    if (!state->fn_(leaf->key_, leaf->value_)) {
+      return ScanResult::DONE;
+    }
+  }
+  return ScanResult::CONTINUE;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  bool inserted;
+  while (true) {
+    EpochGuard guard(this);
+    if (TryInsert(key, value, &inserted)) {
+      if (inserted) {
+        size_++;
+      }
+      return inserted;
+    }
+    std::this_thread::yield();
+  }
+}
+
+/*
+ * Only the root has no parent, and it neither has a prefix nor ever gets full, so the cases that replace a node
+ * always find a parent.
+ */
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::TryInsert(const KeyType &key, const ValueType &value, bool *inserted) -> bool {
+  const uint8_t *bytes = KeyBytes(key);
+  Node *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  Node *node = root_;
+  size_t depth = 0;
+  *inserted = true;
+  while (true) {
+    uint64_t version;
+    if (!ReadLock(node, &version)) {
+      return false;
+    }
+
+    size_t matched = MatchPrefix(node, bytes, depth);
+    if (matched < node->prefix_length_) {
+      // The key leaves the prefix of the node: a new node takes the matched part of the prefix, with a copy of the
+      // node that keeps the rest and the new leaf below it.
+      if (!UpgradeLock(parent, parent_version)) {
+        return false;
+      }
+      if (!UpgradeLock(node, version)) {
+        WriteUnlock(parent);
+        return false;
+      }
+      Node *split = NewNode(NodeType::NODE4, node->prefix_, matched);
+      Node *rest = CopyNode(node, node->type_, node->prefix_ + matched + 1, node->prefix_length_ - matched - 1);
+      AddChild(split, node->prefix_[matched], ToChild(rest));
+      AddChild(split, bytes[depth + matched], ToChild(new Leaf{key, value}));
+      ReplaceChild(parent, parent_byte, ToChild(split));
+      WriteUnlock(parent);
+      WriteUnlockObsolete(node);
+      Retire(ToChild(node));
+      return true;
+    }
+
+    depth += node->prefix_length_;
+    uint8_t byte = bytes[depth];
+    Child child = FindChild(node, byte);
+    bool full = node->num_children_ >= Capacity(node->type_);
+    if (!Validate(node, version)) {
+      return false;
+    }
+
+    if (child == 0) {
+      if (!full) {
+        if (!UpgradeLock(node, version)) {
+          return false;
+        }
+        AddChild(node, byte, ToChild(new Leaf{key, value}));
+        WriteUnlock(node);
+        return true;
+      }
+      if (!UpgradeLock(parent, parent_version)) {
+        return false;
+      }
+      if (!UpgradeLock(node, version)) {
+        WriteUnlock(parent);
+        return false;
+      }
+      Node *grown = CopyNode(node, GrownType(node->type_), node->prefix_, node->prefix_length_);
+      AddChild(grown, byte, ToChild(new Leaf{key, value}));
+      ReplaceChild(parent, parent_byte, ToChild(grown));
+      WriteUnlock(parent);
+      WriteUnlockObsolete(node);
+      Retire(ToChild(node));
+      return true;
+    }
+
+    if (IsLeaf(child)) {
+      const uint8_t *other = KeyBytes(AsLeaf(child)->key_);
+      if (memcmp(other, bytes, KEY_SIZE) == 0) {
+        *inserted = false;
+        return true;
+      }
+      // Both keys share the bytes up to this one; a new node holds the bytes they share past it as its prefix.
+      if (!UpgradeLock(node, version)) {
+        return false;
+      }
+      size_t end = depth + 1;
+      while (other[end] == bytes[end]) {
+        end++;
+      }
+      Node *expanded = NewNode(NodeType::NODE4, bytes + depth + 1, end - depth - 1);
+      AddChild(expanded, other[end], child);
+      AddChild(expanded, bytes[end], ToChild(new Leaf{key, value}));
+      ReplaceChild(node, byte, ToChild(expanded));
+      WriteUnlock(node);
+      return true;
+    }
+
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = AsNode(child);
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::Remove(const KeyType &key) -> bool {
+  bool removed;
+  while (true) {
+    EpochGuard guard(this);
+    if (TryRemove(key, &removed)) {
+      if (removed) {
+        size_--;
+      }
+      return removed;
+    }
+    std::this_thread::yield();
+  }
+}
+
+/*
+ * A node other than the root that loses its last child is taken out of its parent, and a Node4 left with a single
+ * leaf is replaced by that leaf. A Node4 left with a single inner node keeps it, since merging the prefixes would
+ * take replacing the child as well.
+ */
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::TryRemove(const KeyType &key, bool *removed) -> bool {
+  const uint8_t *bytes = KeyBytes(key);
+  Node *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  Node *node = root_;
+  size_t depth = 0;
+  *removed = false;
+  while (true) {
+    uint64_t version;
+    if (!ReadLock(node, &version)) {
+      return false;
+    }
+    if (MatchPrefix(node, bytes, depth) < node->prefix_length_) {
+      return Validate(node, version);
+    }
+    depth += node->prefix_length_;
+    uint8_t byte = bytes[depth];
+    Child child = FindChild(node, byte);
+    size_t num_children = node->num_children_;
+    Child sibling = 0;
+    if (node->type_ == NodeType::NODE4 && num_children == 2) {
+      uint8_t sibling_bytes[4];
+      Child siblings[4];
+      if (ListChildren(node, 0, sibling_bytes, siblings) == 2) {
+        sibling = sibling_bytes[0] == byte ? siblings[1] : siblings[0];
+      }
+    }
+    if (!Validate(node, version)) {
+      return false;
+    }
+    if (child == 0) {
+      return true;
+    }
+    if (!IsLeaf(child)) {
+      parent = node;
+      parent_version = version;
+      parent_byte = byte;
+      node = AsNode(child);
+      depth++;
+      continue;
+    }
+    if (memcmp(KeyBytes(AsLeaf(child)->key_), bytes, KEY_SIZE) != 0) {
+      return true;
+    }
+
+    if (parent == nullptr || (num_children - 1 != ShrinkSize(node->type_) && num_children != 1 &&
+                              (sibling == 0 || !IsLeaf(sibling)))) {
+      if (!UpgradeLock(node, version)) {
+        return false;
+      }
+      RemoveChild(node, byte);
+      WriteUnlock(node);
+      Retire(child);
+      *removed = true;
+      return true;
+    }
+    if (!UpgradeLock(parent, parent_version)) {
+      return false;
+    }
+    if (!UpgradeLock(node, version)) {
+      WriteUnlock(parent);
+      return false;
+    }
+    if (num_children == 1) {
+      RemoveChild(parent, parent_byte);
+    } else if (sibling != 0 && IsLeaf(sibling)) {
+      ReplaceChild(parent, parent_byte, sibling);
+    } else {
+      Node *shrunk = CopyNode(node, ShrunkType(node->type_), node->prefix_, node->prefix_length_, byte);
+      ReplaceChild(parent, parent_byte, ToChild(shrunk));
+    }
+    WriteUnlock(parent);
+    WriteUnlockObsolete(node);
+    Retire(ToChild(node));
+    Retire(child);
+    *removed = true;
+    return true;
+  }
+}
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::ReadLock(const Node *node, uint64_t *version) -> bool {
+  *version = node->version_;
+  return (*version & (LOCKED | OBSOLETE)) == 0;
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::UpgradeLock(Node *node, uint64_t version) -> bool {
+  return node->version_.compare_exchange_strong(version, version + LOCKED);
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::MatchPrefix(const Node *node, const uint8_t *key, size_t depth) -> size_t {
+  size_t matched = 0;
+  while (matched < node->prefix_length_ && node->prefix_[matched] == key[depth + matched]) {
+    matched++;
+  }
+  return matched;
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::Capacity(NodeType type) -> size_t {
+  switch (type) {
+    case NodeType::NODE4:
+      return 4;
+    case NodeType::NODE16:
+      return 16;
+    case NodeType::NODE48:
+      return 48;
+    default:
+      return 256;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::GrownType(NodeType type) -> NodeType {
+  switch (type) {
+    case NodeType::NODE4:
+      return NodeType::NODE16;
+    case NodeType::NODE16:
+      return NodeType::NODE48;
+    default:
+      return NodeType::NODE256;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::ShrunkType(NodeType type) -> NodeType {
+  switch (type) {
+    case NodeType::NODE256:
+      return NodeType::NODE48;
+    case NodeType::NODE48:
+      return NodeType::NODE16;
+    default:
+      return NodeType::NODE4;
+  }
+}
+
+/*
+ * A node shrinks well below the capacity of the smaller type, so that a key inserted and removed again at the
+ * boundary does not replace the node each time.
+ */
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::ShrinkSize(NodeType type) -> size_t {
+  switch (type) {
+    case NodeType::NODE16:
+      return 3;
+    case NodeType::NODE48:
+      return 12;
+    case NodeType::NODE256:
+      return 37;
+    default:
+      return 0;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::NewNode(NodeType type, const uint8_t *prefix, size_t prefix_length) -> Node * {
+  switch (type) {
+    case NodeType::NODE4:
+      return new Node4(prefix, prefix_length);
+    case NodeType::NODE16:
+      return new Node16(prefix, prefix_length);
+    case NodeType::NODE48:
+      return new Node48(prefix, prefix_length);
+    default:
+      return new Node256(prefix, prefix_length);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::DeleteNode(Node *node) {
+  switch (node->type_) {
+    case NodeType::NODE4:
+      delete static_cast<Node4 *>(node);
+      break;
+    case NodeType::NODE16:
+      delete static_cast<Node16 *>(node);
+      break;
+    case NodeType::NODE48:
+      delete static_cast<Node48 *>(node);
+      break;
+    default:
+      delete static_cast<Node256 *>(node);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::DeleteChild(Child child) {
+  if (IsLeaf(child)) {
+    delete AsLeaf(child);
+    return;
+  }
+  uint8_t bytes[256];
+  Child children[256];
+  size_t count = ListChildren(AsNode(child), 0, bytes, children);
+  for (size_t i = 0; i < count; i++) {
+    DeleteChild(children[i]);
+  }
+  DeleteNode(AsNode(child));
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::KeyedArrays(const Node *node) -> std::pair<std::atomic<uint8_t> *, std::atomic<Child> *> {
+  auto *keyed = const_cast<Node *>(node);
+  if (node->type_ == NodeType::NODE4) {
+    auto *node4 = static_cast<Node4 *>(keyed);
+    return {node4->keys_, node4->children_};
+  }
+  auto *node16 = static_cast<Node16 *>(keyed);
+  return {node16->keys_, node16->children_};
+}
+
+/*
+ * Readers call this on nodes that may change under them; the counts are clamped to the capacity so that a torn read
+ * never leaves the node, and the caller validates the version before using the result.
+ */
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::FindChild(const Node *node, uint8_t byte) -> Child {
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      size_t capacity = Capacity(node->type_);
+      size_t count = std::min<size_t>(node->num_children_, capacity);
+      auto [keys, children] = KeyedArrays(node);
+      for (size_t i = 0; i < count; i++) {
+        if (keys[i] == byte) {
+          return children[i];
+        }
+      }
+      return 0;
+    }
+    case NodeType::NODE48: {
+      const auto *node48 = static_cast<const Node48 *>(node);
+      uint8_t index = node48->child_index_[byte];
+      return index == 0 ? 0 : node48->children_[index - 1].load();
+    }
+    default:
+      return static_cast<const Node256 *>(node)->children_[byte];
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::ListChildren(const Node *node, uint8_t from, uint8_t *bytes, Child *children) -> size_t {
+  size_t count = 0;
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      size_t num_children = std::min<size_t>(node->num_children_, Capacity(node->type_));
+      auto [keys, node_children] = KeyedArrays(node);
+      for (size_t i = 0; i < num_children; i++) {
+        if (keys[i] >= from) {
+          bytes[count] = keys[i];
+          children[count++] = node_children[i];
+        }
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      const auto *node48 = static_cast<const Node48 *>(node);
+      for (size_t byte = from; byte < 256; byte++) {
+        uint8_t index = node48->child_index_[byte];
+        if (index != 0) {
+          bytes[count] = static_cast<uint8_t>(byte);
+          children[count++] = node48->children_[index - 1];
+        }
+      }
+      break;
+    }
+    default: {
+      const auto *node256 = static_cast<const Node256 *>(node);
+      for (size_t byte = from; byte < 256; byte++) {
+        Child child = node256->children_[byte];
+        if (child != 0) {
+          bytes[count] = static_cast<uint8_t>(byte);
+          children[count++] = child;
+        }
+      }
+    }
+  }
+  return count;
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::AddChild(Node *node, uint8_t byte, Child child) {
+  uint16_t count = node->num_children_;
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      auto [keys, children] = KeyedArrays(node);
+      size_t position = count;
+      while (position > 0 && keys[position - 1] > byte) {
+        keys[position] = keys[position - 1].load();
+        children[position] = children[position - 1].load();
+        position--;
+      }
+      keys[position] = byte;
+      children[position] = child;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      size_t slot = 0;
+      while (node48->children_[slot] != 0) {
+        slot++;
+      }
+      node48->children_[slot] = child;
+      node48->child_index_[byte] = static_cast<uint8_t>(slot + 1);
+      break;
+    }
+    default:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+  }
+  node->num_children_ = count + 1;
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::ReplaceChild(Node *node, uint8_t byte, Child child) {
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      auto [keys, children] = KeyedArrays(node);
+      for (size_t i = 0; i < node->num_children_; i++) {
+        if (keys[i] == byte) {
+          children[i] = child;
+          return;
+        }
+      }
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1] = child;
+      return;
+    }
+    default:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::RemoveChild(Node *node, uint8_t byte) {
+  uint16_t count = node->num_children_;
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      auto [keys, children] = KeyedArrays(node);
+      size_t position = 0;
+      while (keys[position] != byte) {
+        position++;
+      }
+      for (; position + 1 < count; position++) {
+        keys[position] = keys[position + 1].load();
+        children[position] = children[position + 1].load();
+      }
+      children[count - 1] = 0;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1] = 0;
+      node48->child_index_[byte] = 0;
+      break;
+    }
+    default:
+      static_cast<Node256 *>(node)->children_[byte] = 0;
+  }
+  node->num_children_ = count - 1;
+}
+
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::CopyNode(const Node *node, NodeType type, const uint8_t *prefix, size_t prefix_length,
+                        int skipped_byte) -> Node * {
+  Node *copy = NewNode(type, prefix, prefix_length);
+  uint8_t bytes[256];
+  Child children[256];
+  size_t count = ListChildren(node, 0, bytes, children);
+  for (size_t i = 0; i < count; i++) {
+    if (bytes[i] != skipped_byte) {
+      AddChild(copy, bytes[i], children[i]);
+    }
+  }
+  return copy;
+}
+
+/*****************************************************************************
+ * RECLAMATION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+auto ART_TYPE::EnterEpoch() -> uint64_t {
+  while (true) {
+    uint64_t epoch = epoch_;
+    active_[epoch % 2]++;
+    if (epoch_ == epoch) {
+      return epoch;
+    }
+    // the epoch moved on before the operation registered; it may have been counted out already
+    active_[epoch % 2]--;
+  }
+}
+
+/*
+ * Operations run in the current epoch or the one before. What was retired in the epoch before the one before was
+ * unlinked before any running operation started, so once no operation of the epoch before is left, the epoch moves
+ * on and that garbage is freed. Unlike a single count of running operations, this never waits for a moment with no
+ * operation running at all, which a busy tree may never reach.
+ */
+template <typename KeyType, typename ValueType>
+void ART_TYPE::Retire(Child child) {
+  std::vector<Child> freed;
+  {
+    std::lock_guard<std::mutex> guard(garbage_latch_);
+    uint64_t epoch = epoch_;
+    garbage_[epoch % 3].push_back(child);
+    if (active_[(epoch + 1) % 2] == 0) {
+      freed.swap(garbage_[(epoch + 2) % 3]);
+      epoch_ = epoch + 1;
+    }
+  }
+  for (Child retired : freed) {
+    FreeRetired(retired);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::FreeRetired(Child child) {
+  if (IsLeaf(child)) {
+    delete AsLeaf(child);
+  } else {
+    DeleteNode(AsNode(child));
+  }
+}
+
+template class AdaptiveRadixTree<GenericKey<4>, RID>;
+template class AdaptiveRadixTree<GenericKey<8>, RID>;
+template class AdaptiveRadixTree<GenericKey<16>, RID>;
+template class AdaptiveRadixTree<GenericKey<32>, RID>;
+template class AdaptiveRadixTree<GenericKey<64>, RID>;
+
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_index.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree_index.h"
+
+#include <algorithm>
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ART_INDEX_TYPE::AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata)
+    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
+
+  container_.Insert(index_key, rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
+
+  container_.Remove(index_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
+
+  container_.GetValue(index_key, result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result,
+                                 Transaction *transaction) {
+  std::vector<std::pair<KeyType, ValueType>> entries;
+  if (key != nullptr) {
+    KeyType index_key;
+    index_key.SetFromKey(*key, GetKeySchema(), comparator_.IsNormalized());
+    std::vector<ValueType> values;
+    container_.GetValue(index_key, &values);
+    for (const auto &value : values) {
+      entries.emplace_back(index_key, value);
+    }
+  } else {
+    container_.Scan(nullptr, [&](const KeyType &index_key, const ValueType &value) {
+      entries.emplace_back(index_key, value);
+      return true;
+    });
+    if (!comparator_.IsNormalized()) {
+      std::sort(entries.begin(), entries.end(),
+                [&](const auto &lhs, const auto &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+    }
+  }
+
+  Schema *key_schema = GetKeySchema();
+  std::vector<Value> values;
+  for (const auto &entry : entries) {
+    values.clear();
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      values.push_back(entry.first.ToValue(key_schema, i, comparator_.IsNormalized()));
+    }
+    result->emplace_back(Tuple(values, key_schema), entry.second);
+  }
+}
+
+template class AdaptiveRadixTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class AdaptiveRadixTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class AdaptiveRadixTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class AdaptiveRadixTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class AdaptiveRadixTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,332 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_link_tree.cpp
+//
+// Identification: src/storage/index/b_link_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/b_link_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+BLINKTREE_TYPE::BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                          int leaf_max_size, int internal_max_size, page_id_t header_page_id)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size),
+      header_page_id_(header_page_id) {}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key
+ * This method is used for point query
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
+  Page *page = FindPage(key, 0, false);
+  if (page == nullptr) {
+    return false;
+  }
+  ValueType value;
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the tree, starting it if it is empty. A leaf that fills up splits; the
+ * separator is posted to the parent once the leaf is released.
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
+  if (root_page_id_ == INVALID_PAGE_ID && StartNewTree(key, value)) {
+    return true;
+  }
+  std::vector<page_id_t> path;
+  Page *page = FindPage(key, 0, true, &path);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  if (leaf->Insert(key, value, comparator_) < leaf->GetMaxSize()) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+
+  Page *sibling_page = NewTreePage(0);
+  auto *sibling = reinterpret_cast<LeafPage *>(sibling_page->GetData());
+  leaf->MoveHalfTo(sibling);
+  KeyType separator = sibling->KeyAt(0);
+  page_id_t sibling_id = sibling_page->GetPageId();
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  InsertIntoParent(&path, 1, separator, sibling_id);
+  return true;
+}
+
+/*
+ * Start the tree with a root leaf holding the pair, unless another thread started it first.
+ * @return whether the tree was started
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) -> bool {
+  std::scoped_lock lock(root_latch_);
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    return false;
+  }
+  Page *page = NewTreePage(0);
+  reinterpret_cast<LeafPage *>(page->GetData())->Insert(key, value, comparator_);
+  root_page_id_ = page->GetPageId();
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  return true;
+}
+
+/*
+ * Second step of a split: insert the separator and the new right page into the parent on the given level, which
+ * may split in turn. The parent is the page the descent passed on that level, or the page that took over the key
+ * by splitting since. Without one the split page was the root: either a new root goes on top of the old one, the
+ * leftmost page of its level, or another thread grew the tree meanwhile, and the parent is looked up from the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::InsertIntoParent(std::vector<page_id_t> *path, int level, KeyType key, page_id_t right_id) {
+  while (true) {
+    Page *page;
+    if (!path->empty()) {
+      page = FetchTreePage(path->back());
+      path->pop_back();
+      page->WLatch();
+      page = MoveRight(page, key, true);
+    } else {
+      std::unique_lock lock(root_latch_);
+      page_id_t root_id = root_page_id_;
+      Page *root_page = FetchTreePage(root_id);
+      int root_level = reinterpret_cast<InternalPage *>(root_page->GetData())->GetLevel();
+      buffer_pool_manager_->UnpinPage(root_id, false);
+      if (root_level == level - 1) {
+        Page *new_root_page = NewTreePage(level);
+        reinterpret_cast<InternalPage *>(new_root_page->GetData())->PopulateNewRoot(root_id, key, right_id);
+        root_page_id_ = new_root_page->GetPageId();
+        UpdateRootPageId();
+        buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+        return;
+      }
+      lock.unlock();
+      page = FindPage(key, level, true);
+    }
+
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    if (node->Insert(key, right_id, comparator_) < node->GetMaxSize()) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return;
+    }
+    Page *sibling_page = NewTreePage(level);
+    auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+    node->MoveHalfTo(sibling);
+    key = sibling->KeyAt(0);
+    right_id = sibling_page->GetPageId();
+    buffer_pool_manager_->UnpinPage(right_id, true);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    level++;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key. The leaf is left as it is, however few keys remain.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  Page *page = FindPage(key, 0, true);
+  if (page == nullptr) {
+    return;
+  }
+  bool removed = reinterpret_cast<LeafPage *>(page->GetData())->Remove(key, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+/*
+ * Fetch a page of the tree, throwing an "out of memory" exception if the buffer pool is full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::FetchTreePage(page_id_t page_id) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a b-link tree page.");
+  }
+  return page;
+}
+
+/*
+ * Allocate and initialize an empty page of the tree on the given level, throwing an "out of memory" exception if
+ * the buffer pool is full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::NewTreePage(int level) -> Page * {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a b-link tree page.");
+  }
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, level, leaf_max_size_);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, level, internal_max_size_);
+  }
+  return page;
+}
+
+/*
+ * Descend from the root to the page on the given level that holds the key, holding one read latch at a time and
+ * recording the internal pages passed on the way down in path.
+ * @return the page, pinned and latched (in write mode if write is set), or nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::FindPage(const KeyType &key, int level, bool write, std::vector<page_id_t> *path) -> Page * {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  // The header, levels included, is laid out the same on every page; a page never changes level once linked.
+  Page *page = FetchTreePage(page_id);
+  bool target = reinterpret_cast<InternalPage *>(page->GetData())->GetLevel() == level;
+  while (true) {
+    if (write && target) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    page = MoveRight(page, key, write && target);
+    if (target) {
+      return page;
+    }
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    if (path != nullptr) {
+      path->push_back(page->GetPageId());
+    }
+    page_id_t child_id = node->ChildFor(key, comparator_);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = FetchTreePage(child_id);
+    target = reinterpret_cast<InternalPage *>(page->GetData())->GetLevel() == level;
+  }
+}
+
+/*
+ * Follow right links from the latched page while the key lies past its high key, i.e. the page split since its
+ * parent sent the search here. The latch moves along: the page is released before its sibling is latched.
+ * @return the page that holds the key, pinned and latched like the given one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BLINKTREE_TYPE::MoveRight(Page *page, const KeyType &key, bool write) -> Page * {
+  while (reinterpret_cast<InternalPage *>(page->GetData())->IsBeyond(key, comparator_)) {
+    page_id_t right_id = reinterpret_cast<InternalPage *>(page->GetData())->GetRightPageId();
+    if (write) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = FetchTreePage(right_id);
+    if (write) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+  }
+  return page;
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h). Call this method everytime root
+ * page id is changed, with root_latch_ held.
+ * @parameter: insert_record      default value is false. When set to true,
+ * insert a record <index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(FetchTreePage(header_page_id_));
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+}
+
+/*
+ * Every level is a chain of right links, starting at the leftmost child of the level above.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Destroy(std::vector<page_id_t> *pinned_page_ids) {
+  std::lock_guard<std::mutex> guard(root_latch_);
+  page_id_t leftmost_id = root_page_id_;
+  while (leftmost_id != INVALID_PAGE_ID) {
+    page_id_t page_id = leftmost_id;
+    leftmost_id = INVALID_PAGE_ID;
+    while (page_id != INVALID_PAGE_ID) {
+      auto *node = reinterpret_cast<InternalPage *>(FetchTreePage(page_id)->GetData());
+      if (leftmost_id == INVALID_PAGE_ID && !node->IsLeafPage()) {
+        leftmost_id = node->ValueAt(0);
+      }
+      page_id_t right_id = node->GetRightPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      if (!buffer_pool_manager_->DeletePage(page_id)) {
+        pinned_page_ids->push_back(page_id);
+      }
+      page_id = right_id;
+    }
+  }
+  root_page_id_ = INVALID_PAGE_ID;
+  auto *header_page = static_cast<HeaderPage *>(FetchTreePage(header_page_id_));
+  header_page->DeleteRecord(index_name_);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+}
+
+template class BLinkTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,7 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -20,19 +26,25 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, page_id_t header_page_id)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      header_page_id_(header_page_id) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
+  root_latch_.RLock();
+  bool empty = root_page_id_ == INVALID_PAGE_ID;
+  root_latch_.RUnlock();
+  return empty;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -43,7 +55,136 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  return false;
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+/*
+ * Look up a batch of keys at once. The keys are sorted, so that the keys bound for the same page share the descent
+ * to it: every page on the way is fetched and latched once for all of its keys, rather than once per key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), std::vector<ValueType>{});
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  // Every pass descends from the root and searches a prefix of the remaining keys; see GetValuesFrom().
+  size_t done = 0;
+  while (done < order.size()) {
+    root_latch_.RLock();
+    if (root_page_id_ == INVALID_PAGE_ID) {
+      root_latch_.RUnlock();
+      return;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+    if (page == nullptr) {
+      root_latch_.RUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch the root page.");
+    }
+    page->RLatch();
+    root_latch_.RUnlock();
+    size_t searched = GetValuesFrom(page, keys, order.data() + done, order.size() - done, results);
+    if (searched == 0) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a b+ tree page.");
+    }
+    done += searched;
+  }
+}
+
+/*
+ * Search the pinned and read-latched page, and the subtree below it, for the keys keys[order[0]], ...,
+ * keys[order[count - 1]] in key order, and release the page. The keys of an internal page split into runs bound for
+ * the same child. As in latch crabbing, the children of the runs are pinned and read-latched before the page is
+ * released, and searched in turn once it is, in groups of BATCH_GROUP_SIZE with the first cache lines of every page
+ * of a group prefetched before the first of them is searched.
+ * If the buffer pool cannot hold all of the children at once, only the keys of the children it holds are searched,
+ * and those of none if it holds none. Returns how many of the keys, from the first on, were searched; the caller
+ * descends again for the others.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValuesFrom(Page *page, const std::vector<KeyType> &keys, const size_t *order, size_t count,
+                                   std::vector<std::vector<ValueType>> *results) -> size_t {
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    ValueType value;
+    for (size_t i = 0; i < count; i++) {
+      if (leaf->Lookup(keys[order[i]], &value, comparator_)) {
+        (*results)[order[i]].push_back(value);
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return count;
+  }
+
+  // runs[r] is the child of the r-th run and the position of its first key; a sentinel closes the last run
+  auto *internal = reinterpret_cast<InternalPage *>(node);
+  std::vector<std::pair<page_id_t, size_t>> runs;
+  for (size_t i = 0; i < count; i++) {
+    page_id_t child_id = internal->Lookup(keys[order[i]], comparator_);
+    if (runs.empty() || runs.back().first != child_id) {
+      runs.emplace_back(child_id, i);
+    }
+  }
+  runs.emplace_back(INVALID_PAGE_ID, count);
+
+  std::vector<Page *> children;
+  children.reserve(runs.size() - 1);
+  while (children.size() + 1 < runs.size()) {
+    Page *child = buffer_pool_manager_->FetchPage(runs[children.size()].first);
+    if (child == nullptr) {
+      break;
+    }
+    child->RLatch();
+    children.push_back(child);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+  auto release_children = [&](size_t from) {
+    for (size_t r = from; r < children.size(); r++) {
+      children[r]->RUnlatch();
+      buffer_pool_manager_->UnpinPage(children[r]->GetPageId(), false);
+    }
+  };
+  for (size_t first = 0; first < children.size(); first += BATCH_GROUP_SIZE) {
+    size_t last = std::min(first + BATCH_GROUP_SIZE, children.size());
+    for (size_t r = first; r < last; r++) {
+      for (size_t offset = 0; offset < BATCH_PREFETCH_BYTES; offset += 64) {
+        __builtin_prefetch(children[r]->GetData() + offset);
+      }
+    }
+    for (size_t r = first; r < last; r++) {
+      size_t run_size = runs[r + 1].second - runs[r].second;
+      size_t searched;
+      try {
+        searched = GetValuesFrom(children[r], keys, order + runs[r].second, run_size, results);
+      } catch (Exception &e) {
+        release_children(r + 1);
+        throw;
+      }
+      if (searched < run_size) {
+        release_children(r + 1);
+        return runs[r].second + searched;
+      }
+    }
+  }
+  return runs[children.size()].second;
 }
 
 /*****************************************************************************
@@ -58,7 +199,27 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  // Optimistic pass: most inserts fit into the leaf and only need its write latch.
+  bool is_root;
+  Page *page = FindLeafPageOptimistic(key, false, true, &is_root);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType existing;
+    if (leaf->Lookup(key, &existing, comparator_)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    if (IsSafe(leaf, Operation::INSERT)) {
+      leaf->Insert(key, value, comparator_);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return true;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  return InsertIntoLeaf(key, value, transaction);
 }
 /*
  * Insert constant key & value pair into an empty tree
@@ -67,7 +228,19 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate the root page.");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -79,7 +252,28 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  Transaction local_transaction(INVALID_TXN_ID);
+  auto *txn = transaction != nullptr ? transaction : &local_transaction;
+
+  Page *page = FindLeafPagePessimistic(key, Operation::INSERT, txn);
+  if (page == nullptr) {
+    StartNewTree(key, value);
+    ReleasePageSet(txn);
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    ReleasePageSet(txn);
+    return false;
+  }
+  if (leaf->Insert(key, value, comparator_) >= leaf->GetMaxSize()) {
+    LeafPage *sibling = Split(leaf);
+    InsertIntoParent(leaf, Separator(leaf->KeyAt(leaf->GetSize() - 1), sibling->KeyAt(0)), sibling, txn);
+    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+  }
+  ReleasePageSet(txn);
+  return true;
 }
 
 /*
@@ -92,7 +286,23 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::Split(N *node) -> N * {
-  return nullptr;
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a page to split into.");
+  }
+  // The new page is reachable only through the node and its parent, both write-latched, so it needs no latch.
+  auto *sibling = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    sibling->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    node->MoveHalfTo(sibling);
+    sibling->SetNextPageId(node->GetNextPageId());
+    node->SetNextPageId(page_id);
+  } else {
+    sibling->Init(page_id, node->GetParentPageId(), internal_max_size_, comparator_.IsNormalized());
+    node->MoveHalfTo(sibling, buffer_pool_manager_);
+  }
+  return sibling;
 }
 
 /*
@@ -106,7 +316,191 @@ auto BPLUSTREE_TYPE::Split(N *node) -> N * {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    // The old root was not safe, so root_latch_ is still held in write mode.
+    page_id_t root_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a new root page.");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_id, INVALID_PAGE_ID, internal_max_size_, comparator_.IsNormalized());
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+
+  // The parent is in the transaction's page set, already write-latched by this thread.
+  page_id_t parent_id = old_node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchTreePage(parent_id)->GetData());
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(parent_id);
+  if (parent->IsOverflow()) {
+    InternalPage *sibling = Split(parent);
+    InsertIntoParent(parent, sibling->KeyAt(0), sibling, transaction);
+    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_id, true);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree bottom-up from input, which must be sorted. Leaves are filled left to right up to the fill factor;
+ * whenever one is full it is linked into the rightmost page of the level above, which grows the same way. Every
+ * page is written once and only the rightmost page of each level stays pinned, so the build streams through the
+ * buffer pool. The tree is not reachable before root_page_id_ is set, and root_latch_ keeps others out until then.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(ExternalSort<KeyType, ValueType, KeyComparator> *input, int fill_factor) -> bool {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  // Never fill a page up to the size that makes it split, nor below the size that makes it underflow.
+  fill_factor = std::clamp(fill_factor, 50, 100);
+  int leaf_fill = std::clamp(leaf_max_size_ * fill_factor / 100, std::max(leaf_max_size_ / 2, 1), leaf_max_size_ - 1);
+  int internal_fill =
+      std::clamp(internal_max_size_ * fill_factor / 100, std::max((internal_max_size_ + 1) / 2, 2), internal_max_size_);
+
+  std::vector<BulkLoadLevel> levels;
+  MappingType pair;
+  while (input->Next(&pair)) {
+    BulkLoadAppend(&levels, pair.first, pair.second, leaf_fill, internal_fill, fill_factor);
+  }
+  if (!levels.empty()) {
+    BulkLoadFinish(&levels, internal_fill, fill_factor);
+    UpdateRootPageId(1);
+  }
+  root_latch_.WUnlock();
+  return true;
+}
+
+/*
+ * Append a pair to the rightmost leaf, starting a new leaf once it is full. A key equal to the previous one is
+ * dropped, since the tree only supports unique keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppend(std::vector<BulkLoadLevel> *levels, const KeyType &key, const ValueType &value,
+                                    int leaf_fill, int internal_fill, int fill_factor) {
+  if (levels->empty()) {
+    levels->push_back(BulkLoadLevel{NewTreePage(true), key});
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>((*levels)[0].page_->GetData());
+  if (leaf->GetSize() > 0 && comparator_(leaf->KeyAt(leaf->GetSize() - 1), key) == 0) {
+    return;
+  }
+  if (leaf->GetSize() == leaf_fill) {
+    Page *page = NewTreePage(true);
+    leaf->SetNextPageId(page->GetPageId());
+    KeyType separator = Separator(leaf->KeyAt(leaf->GetSize() - 1), key);
+    BulkLoadLink(levels, 1, internal_fill, fill_factor);
+    (*levels)[0] = BulkLoadLevel{page, separator};
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  }
+  leaf->Insert(key, value, comparator_);
+}
+
+/*
+ * Link the rightmost page of level - 1 into the rightmost page of level, starting that level or a new page on it
+ * if needed, and unpin it: it is complete. An internal page is full at internal_fill children or once its keys take
+ * up the fill factor of its space; the first key of the next child fences the two pages.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadLink(std::vector<BulkLoadLevel> *levels, size_t level, int internal_fill,
+                                  int fill_factor) {
+  BulkLoadLevel child = (*levels)[level - 1];
+  if (levels->size() == level) {
+    levels->push_back(BulkLoadLevel{NewTreePage(false), child.first_key_});
+  }
+  auto *parent = reinterpret_cast<InternalPage *>((*levels)[level].page_->GetData());
+  if (parent->GetSize() == internal_fill || !parent->CanInsert(fill_factor)) {
+    parent->SetHighFence(child.first_key_);
+    Page *page = NewTreePage(false);
+    BulkLoadLink(levels, level + 1, internal_fill, fill_factor);
+    (*levels)[level] = BulkLoadLevel{page, child.first_key_};
+    parent = reinterpret_cast<InternalPage *>(page->GetData());
+    parent->SetLowFence(child.first_key_);
+  }
+  parent->AppendChild(child.first_key_, child.page_->GetPageId(), buffer_pool_manager_);
+  buffer_pool_manager_->UnpinPage(child.page_->GetPageId(), true);
+}
+
+/*
+ * Link the rightmost pages bottom-up once the input is exhausted. Such a page may be short; it then merges into or
+ * borrows from its left neighbour, which is full up to the fill factor. The top page becomes the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadFinish(std::vector<BulkLoadLevel> *levels, int internal_fill, int fill_factor) {
+  for (size_t level = 0; level + 1 < levels->size(); level++) {
+    Page *page = (*levels)[level].page_;
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool underflow = node->IsLeafPage() ? node->GetSize() < node->GetMinSize()
+                                        : reinterpret_cast<InternalPage *>(node)->IsUnderflow();
+    if (!underflow) {
+      BulkLoadLink(levels, level + 1, internal_fill, fill_factor);
+      continue;
+    }
+    auto *parent = reinterpret_cast<InternalPage *>((*levels)[level + 1].page_->GetData());
+    page_id_t neighbor_id = parent->ValueAt(parent->GetSize() - 1);
+    Page *neighbor_page = FetchTreePage(neighbor_id);
+    bool merge;
+    if (node->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<LeafPage *>(node);
+      auto *neighbor = reinterpret_cast<LeafPage *>(neighbor_page->GetData());
+      merge = neighbor->GetSize() + leaf->GetSize() < leaf_max_size_;
+      if (merge) {
+        leaf->MoveAllTo(neighbor);
+      } else {
+        while (leaf->GetSize() < leaf->GetMinSize()) {
+          neighbor->MoveLastToFrontOf(leaf);
+        }
+        (*levels)[level].first_key_ = Separator(neighbor->KeyAt(neighbor->GetSize() - 1), leaf->KeyAt(0));
+      }
+    } else {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      auto *neighbor = reinterpret_cast<InternalPage *>(neighbor_page->GetData());
+      merge = neighbor->CanMerge(internal, (*levels)[level].first_key_);
+      if (merge) {
+        internal->MoveAllTo(neighbor, (*levels)[level].first_key_, buffer_pool_manager_);
+      } else {
+        while (internal->IsUnderflow() && internal->CanBorrow(neighbor, (*levels)[level].first_key_, false)) {
+          neighbor->MoveLastToFrontOf(internal, (*levels)[level].first_key_, buffer_pool_manager_);
+          (*levels)[level].first_key_ = internal->KeyAt(0);
+        }
+      }
+    }
+    buffer_pool_manager_->UnpinPage(neighbor_id, true);
+    if (merge) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      buffer_pool_manager_->DeletePage(page->GetPageId());
+    } else {
+      BulkLoadLink(levels, level + 1, internal_fill, fill_factor);
+    }
+  }
+
+  Page *top = levels->back().page_;
+  auto *root = reinterpret_cast<BPlusTreePage *>(top->GetData());
+  root_page_id_ = top->GetPageId();
+  if (!root->IsLeafPage() && root->GetSize() == 1) {
+    // Everything below the top page merged into a single page, which becomes the root.
+    root_page_id_ = reinterpret_cast<InternalPage *>(root)->RemoveAndReturnOnlyChild();
+    reinterpret_cast<BPlusTreePage *>(FetchTreePage(root_page_id_)->GetData())->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    buffer_pool_manager_->UnpinPage(top->GetPageId(), false);
+    buffer_pool_manager_->DeletePage(top->GetPageId());
+  } else {
+    buffer_pool_manager_->UnpinPage(top->GetPageId(), true);
+  }
+  levels->clear();
+}
 
 /*****************************************************************************
  * REMOVE
@@ -117,21 +511,131 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * @return: false if the key is not in the tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+auto BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) -> bool {
+  // Optimistic pass: most removes leave the leaf at least half full and only need its write latch.
+  bool is_root;
+  Page *page = FindLeafPageOptimistic(key, false, true, &is_root);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (!leaf->Lookup(key, &existing, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  // A root leaf may shrink down to one entry; emptying it empties the tree, which changes the root. The parent page
+  // id is not read here: a pessimistic writer may be moving this leaf to another parent.
+  if (is_root ? leaf->GetSize() > 1 : leaf->GetSize() > leaf->GetMinSize()) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return RemoveFromLeaf(key, transaction);
+}
+
+/*
+ * Pessimistic remove: descend with write latches and merge or redistribute on underflow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, Transaction *transaction) -> bool {
+  Transaction local_transaction(INVALID_TXN_ID);
+  auto *txn = transaction != nullptr ? transaction : &local_transaction;
+
+  bool removed = false;
+  Page *page = FindLeafPagePessimistic(key, Operation::REMOVE, txn);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int size = leaf->GetSize();
+    removed = leaf->RemoveAndDeleteRecord(key, comparator_) < size;
+    if (removed) {
+      CoalesceOrRedistribute(leaf, txn);
+    }
+  }
+  ReleasePageSet(txn);
+  DeletePages(txn);
+  return removed;
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * Pages emptied along the way are added to the transaction's deleted page set.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -> bool {
-  return false;
+  if (node->IsRootPage()) {
+    if (AdjustRoot(node)) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+      return true;
+    }
+    return false;
+  }
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    if (node->GetSize() >= node->GetMinSize()) {
+      return false;
+    }
+  } else {
+    if (!node->IsUnderflow()) {
+      return false;
+    }
+  }
+
+  // The node was not safe, so its parent is still write-latched by this thread. The sibling is latched here; the
+  // parent's latch keeps every other pessimistic writer away from it.
+  page_id_t parent_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchTreePage(parent_id)->GetData());
+  if (parent->GetSize() == 1) {
+    // The parent itself could neither merge nor borrow; the node has no sibling to turn to.
+    buffer_pool_manager_->UnpinPage(parent_id, false);
+    return false;
+  }
+  int index = parent->ValueIndex(node->GetPageId());
+  page_id_t sibling_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  Page *sibling_page = FetchTreePage(sibling_id);
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // A leaf splits as soon as it reaches its max size, so merged leaves have to stay below it. Internal pages also
+  // have to fit their keys, and redistributing has to fit the new separator into the parent; a node that can do
+  // neither is left underfull.
+  int key_index = index == 0 ? 1 : index;
+  bool merge;
+  bool redistribute;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    merge = sibling->GetSize() + node->GetSize() < node->GetMaxSize();
+    redistribute = !merge && parent->CanSetKeyAt(key_index, index == 0
+                                                                ? Separator(sibling->KeyAt(0), sibling->KeyAt(1))
+                                                                : Separator(sibling->KeyAt(sibling->GetSize() - 2),
+                                                                            sibling->KeyAt(sibling->GetSize() - 1)));
+  } else {
+    KeyType middle_key = parent->KeyAt(key_index);
+    merge = index == 0 ? node->CanMerge(sibling, middle_key) : sibling->CanMerge(node, middle_key);
+    redistribute = !merge && node->CanBorrow(sibling, middle_key, index == 0) &&
+                   parent->CanSetKeyAt(key_index, sibling->KeyAt(index == 0 ? 1 : sibling->GetSize() - 1));
+  }
+  bool node_deleted = false;
+  if (merge) {
+    node_deleted = index != 0;
+    Coalesce(&sibling, &node, &parent, index, transaction);
+  } else if (redistribute) {
+    Redistribute(sibling, node, index);
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+  buffer_pool_manager_->UnpinPage(parent_id, true);
+  return node_deleted;
 }
 
 /*
@@ -140,6 +644,7 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
+ * The right one of the two pages is always merged into the left one.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
@@ -151,7 +656,18 @@ template <typename N>
 auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) -> bool {
-  return false;
+  if (index == 0) {
+    std::swap(*neighbor_node, *node);
+    index = 1;
+  }
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(*neighbor_node);
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  transaction->AddIntoDeletedPageSet((*node)->GetPageId());
+  (*parent)->Remove(index);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
@@ -165,7 +681,34 @@ auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  page_id_t parent_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchTreePage(parent_id)->GetData());
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      parent->SetKeyAt(1, Separator(node->KeyAt(node->GetSize() - 1), neighbor_node->KeyAt(0)));
+    } else {
+      parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    }
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      parent->SetKeyAt(index, Separator(neighbor_node->KeyAt(neighbor_node->GetSize() - 1), node->KeyAt(0)));
+    } else {
+      parent->SetKeyAt(index, node->KeyAt(0));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(parent_id, true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -177,7 +720,26 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return false; }
+auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool {
+  // Only reached when the root was not safe, so root_latch_ is still held in write mode.
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId();
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  page_id_t child_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  reinterpret_cast<BPlusTreePage *>(FetchTreePage(child_id)->GetData())->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(child_id, true);
+  root_page_id_ = child_id;
+  UpdateRootPageId();
+  return true;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -188,7 +750,12 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return f
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  bool is_root;
+  std::vector<page_id_t> following;
+  Page *page = FindLeafPageOptimistic(KeyType{}, true, false, &is_root, &following);
+  return MakeIterator(page, 0, following);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -196,7 +763,13 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  bool is_root;
+  std::vector<page_id_t> following;
+  Page *page = FindLeafPageOptimistic(key, false, false, &is_root, &following);
+  int index = page == nullptr ? 0 : reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return MakeIterator(page, index, following);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -204,7 +777,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return IN
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(buffer_pool_manager_, nullptr, 0); }
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -215,7 +788,236 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE();
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  bool is_root;
+  return FindLeafPageOptimistic(key, leftMost, false, &is_root);
+}
+
+/*
+ * Fetch a page of the tree, throwing an "out of memory" exception if the buffer pool is full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a b+ tree page.");
+  }
+  return page;
+}
+
+/*
+ * Allocate and initialize a page of the tree that has no parent yet, throwing an "out of memory" exception if the
+ * buffer pool is full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewTreePage(bool leaf) -> Page * {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a b+ tree page.");
+  }
+  if (leaf) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())
+        ->Init(page_id, INVALID_PAGE_ID, internal_max_size_, comparator_.IsNormalized());
+  }
+  return page;
+}
+
+/*
+ * Start an iterator on the given leaf, which finds the leaves to prefetch beyond the given ones by descending to
+ * their parent again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MakeIterator(Page *page, int index, const std::vector<page_id_t> &following)
+    -> INDEXITERATOR_TYPE {
+  auto leaf_lookup = [this](const KeyType &key, std::vector<page_id_t> *leaves) {
+    bool is_root;
+    Page *leaf_page = FindLeafPageOptimistic(key, false, false, &is_root, leaves);
+    if (leaf_page != nullptr) {
+      leaf_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    }
+  };
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, following, leaf_lookup);
+}
+
+/*
+ * Descend to the leaf with read latches, releasing each page once its child is latched. The leaf itself is
+ * write-latched if write_leaf is set. A page's type never changes while its parent links to it, so it can be read
+ * before the page is latched. If following is given, the page ids of the leaves after the leaf under the same
+ * parent are appended to it, for a scan to prefetch.
+ * @return the leaf page, pinned and latched, or nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool left_most, bool write_leaf, bool *is_root,
+                                            std::vector<page_id_t> *following) -> Page * {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch the root page.");
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  bool write = write_leaf && node->IsLeafPage();
+  write ? page->WLatch() : page->RLatch();
+  root_latch_.RUnlock();
+  *is_root = true;
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    if (child == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a b+ tree page.");
+    }
+    node = reinterpret_cast<BPlusTreePage *>(child->GetData());
+    write = write_leaf && node->IsLeafPage();
+    write ? child->WLatch() : child->RLatch();
+    if (following != nullptr && node->IsLeafPage()) {
+      for (int i = internal->ValueIndex(child_id) + 1; i < internal->GetSize(); i++) {
+        following->push_back(internal->ValueAt(i));
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    *is_root = false;
+  }
+  return page;
+}
+
+/*
+ * Descend to the leaf with write latches. Every latched page is added to the transaction's page set; once a page is
+ * safe, i.e. the operation cannot propagate above it, the latches of its ancestors are released. root_latch_ is
+ * recorded in the page set as a nullptr entry in front of the root page.
+ * @return the leaf page, or nullptr if the tree is empty (root_latch_ is held either way)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPagePessimistic(const KeyType &key, Operation op, Transaction *transaction) -> Page * {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  page_id_t page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      ReleasePageSet(transaction);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a b+ tree page.");
+    }
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op)) {
+      ReleasePageSet(transaction);
+    }
+    transaction->AddIntoPageSet(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+  }
+  return nullptr;
+}
+
+/*
+ * The shortest key that separates two neighbouring keys, left < separator <= right. Normalized keys are cut after the
+ * first byte in which they differ; internal pages drop the zero bytes behind it. Other keys cannot be cut.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Separator(const KeyType &left, const KeyType &right) const -> KeyType {
+  if (!comparator_.IsNormalized()) {
+    return right;
+  }
+  size_t size = 0;
+  while (size < sizeof(KeyType) && left.data_[size] == right.data_[size]) {
+    size++;
+  }
+  KeyType separator{};
+  memcpy(separator.data_, right.data_, std::min(size + 1, sizeof(KeyType)));
+  return separator;
+}
+
+/*
+ * Whether the operation on the page cannot change its parent: an insert does not split it and a remove does not
+ * make it underflow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const -> bool {
+  if (op == Operation::INSERT) {
+    return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize()
+                              : reinterpret_cast<InternalPage *>(node)->CanInsert();
+  }
+  if (node->IsRootPage()) {
+    return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+  }
+  return node->IsLeafPage() ? node->GetSize() > node->GetMinSize()
+                            : reinterpret_cast<InternalPage *>(node)->CanRemove();
+}
+
+/*
+ * Release the write latches and pins of every page in the transaction's page set.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePageSet(Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  page_set->clear();
+}
+
+/*
+ * Delete the pages emptied by merges. Called once no latch is held on them anymore.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(Transaction *transaction) {
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Destroy(std::vector<page_id_t> *pinned_page_ids) {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    DestroySubtree(root_page_id_, pinned_page_ids);
+    root_page_id_ = INVALID_PAGE_ID;
+  }
+  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id_));
+  header_page->DeleteRecord(index_name_);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  root_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DestroySubtree(page_id_t page_id, std::vector<page_id_t> *pinned_page_ids) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(FetchTreePage(page_id)->GetData());
+  std::vector<page_id_t> children;
+  if (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      children.push_back(internal->ValueAt(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  for (page_id_t child : children) {
+    DestroySubtree(child, pinned_page_ids);
+  }
+  if (!buffer_pool_manager_->DeletePage(page_id)) {
+    pinned_page_ids->push_back(page_id);
+  }
 }
 
 /*
@@ -228,15 +1030,13 @@ auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
-    // update root_page_id in header_page
+  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id_));
+  // create a new record<index_name + root_page_id> in header_page, or update root_page_id in header_page when the
+  // record already exists (a tree that became empty and is started again)
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 }
 
 /*
@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -16,38 +18,158 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     page_id_t header_page_id)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 header_page_id) {
+  // Included columns follow the key columns in the entries; only normalized keys can be matched on a prefix.
+  BUSTUB_ASSERT(GetIncludeColumnCount() == 0 || comparator_.IsNormalized(),
+                "An index with included columns needs a key that can be normalized.");
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
 
-  container_.Insert(index_key, rid, transaction);
+  if (container_.Insert(index_key, rid, transaction) && bloom_filter_ != nullptr) {
+    bloom_filter_->Add(HashFunction<KeyType>().GetHash(index_key));
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
 
-  container_.Remove(index_key, transaction);
+  if (container_.Remove(index_key, transaction) && bloom_filter_ != nullptr) {
+    bloom_filter_->NoteRemove();
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (GetIncludeColumnCount() > 0) {
+    std::vector<MappingType> entries;
+    ScanMatches(key, &entries, transaction);
+    for (const auto &entry : entries) {
+      result->push_back(entry.second);
+    }
+    return;
+  }
+
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(HashFunction<KeyType>().GetHash(index_key))) {
+    return;
+  }
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  if (GetIncludeColumnCount() > 0) {
+    Index::ScanKeys(keys, results, transaction);
+    return;
+  }
+
+  // only the keys that pass the filter are looked up
+  std::vector<KeyType> index_keys;
+  std::vector<size_t> positions;
+  for (size_t i = 0; i < keys.size(); i++) {
+    KeyType index_key;
+    index_key.SetFromKey(keys[i], GetKeySchema(), comparator_.IsNormalized());
+    if (bloom_filter_ == nullptr || bloom_filter_->MayContain(HashFunction<KeyType>().GetHash(index_key))) {
+      index_keys.push_back(index_key);
+      positions.push_back(i);
+    }
+  }
+  std::vector<std::vector<RID>> found;
+  container_.GetValues(index_keys, &found, transaction);
+  results->assign(keys.size(), std::vector<RID>{});
+  for (size_t i = 0; i < positions.size(); i++) {
+    (*results)[positions[i]] = std::move(found[i]);
+  }
+}
+
+/*
+ * A covering index is looked up by a prefix of its entry keys, which a filter of whole keys cannot answer.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::EnableBloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key) -> bool {
+  if (GetIncludeColumnCount() > 0) {
+    return false;
+  }
+  bloom_filter_ = std::make_unique<BloomFilter>(buffer_pool_manager, bits_per_key,
+                                                [this](const std::function<void(uint64_t)> &add) {
+                                                  for (auto iterator = container_.Begin(); !iterator.IsEnd();
+                                                       ++iterator) {
+                                                    add(HashFunction<KeyType>().GetHash((*iterator).first));
+                                                  }
+                                                });
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanEntries(const Tuple *key, std::vector<std::pair<Tuple, RID>> *result,
+                                       Transaction *transaction) {
+  std::vector<MappingType> entries;
+  if (key != nullptr) {
+    ScanMatches(*key, &entries, transaction);
+  } else {
+    for (auto iterator = container_.Begin(); !iterator.IsEnd(); ++iterator) {
+      entries.push_back(*iterator);
+    }
+  }
+
+  Schema *key_schema = GetKeySchema();
+  std::vector<Value> values;
+  for (const auto &entry : entries) {
+    values.clear();
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      values.push_back(entry.first.ToValue(key_schema, i, comparator_.IsNormalized()));
+    }
+    result->emplace_back(Tuple(values, key_schema), entry.second);
+  }
+}
+
+/*
+ * Without included columns the entry key is the whole key. Otherwise the entries that share the key columns are
+ * neighbours in the tree; they start at the key columns followed by zero bytes, and share the encoding of the key
+ * columns.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanMatches(const Tuple &key, std::vector<MappingType> *result, Transaction *transaction) {
+  KeyType index_key;
+  if (GetIncludeColumnCount() == 0) {
+    index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
+    std::vector<RID> rids;
+    container_.GetValue(index_key, &rids, transaction);
+    for (const auto &rid : rids) {
+      result->emplace_back(index_key, rid);
+    }
+    return;
+  }
+
+  size_t prefix_size = index_key.SetFromKeyPrefix(key, GetKeySchema(), GetIndexColumnCount());
+  for (auto iterator = container_.Begin(index_key);
+       !iterator.IsEnd() && memcmp((*iterator).first.data_, index_key.data_, prefix_size) == 0; ++iterator) {
+    result->push_back(*iterator);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(ExternalSort<KeyType, ValueType, KeyComparator> *input, int fill_factor) -> bool {
+  return container_.BulkLoad(input, fill_factor);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/storage/index/bloom_filter.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/bloom_filter.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+BloomFilter::BloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key, KeyScan scan)
+    : buffer_pool_manager_(buffer_pool_manager),
+      bits_per_key_(std::max<size_t>(bits_per_key, 1)),
+      scan_(std::move(scan)) {
+  Build();
+}
+
+BloomFilter::~BloomFilter() {
+  {
+    std::lock_guard<std::mutex> guard(rebuild_latch_);
+    stop_ = true;
+  }
+  work_cv_.notify_one();
+  done_cv_.notify_all();
+  if (rebuild_thread_.joinable()) {
+    rebuild_thread_.join();
+  }
+  for (page_id_t page_id : page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+void BloomFilter::Add(uint64_t hash) {
+  latch_.RLock();
+  SetBits(page_ids_, hash);
+  num_added_++;
+  if (building_) {
+    std::lock_guard<std::mutex> guard(pending_latch_);
+    pending_.push_back(hash);
+  }
+  latch_.RUnlock();
+  ScheduleRebuildIfStale();
+}
+
+void BloomFilter::NoteRemove() {
+  num_removed_++;
+  ScheduleRebuildIfStale();
+}
+
+auto BloomFilter::MayContain(uint64_t hash) -> bool {
+  if (IsStale()) {
+    return true;
+  }
+  latch_.RLock();
+  size_t block = BlockOf(hash, page_ids_.size());
+  Page *page = FetchBlockPage(page_ids_, block);
+  const auto *words = reinterpret_cast<const uint32_t *>(page->GetData()) + (block % BLOCKS_PER_PAGE) * BLOCK_WORDS;
+  bool found = true;
+  for (size_t word = 0; word < BLOCK_WORDS && found; word++) {
+    uint32_t mask = MaskOf(hash, word);
+    found = (__atomic_load_n(&words[word], __ATOMIC_RELAXED) & mask) == mask;
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  latch_.RUnlock();
+  return found;
+}
+
+void BloomFilter::WaitForRebuild() {
+  std::unique_lock<std::mutex> lock(rebuild_latch_);
+  done_cv_.wait(lock, [&] { return stop_ || !rebuild_scheduled_; });
+}
+
+/*
+ * Removed keys leave stale bits behind, which turn lookups of them into false positives; more keys than the filter
+ * was sized for raise the false positive rate of every lookup. Either is tolerated up to half of the keys.
+ */
+auto BloomFilter::IsStale() const -> bool {
+  size_t added = num_added_;
+  return 2 * num_removed_ > added || added > 2 * capacity_;
+}
+
+void BloomFilter::ScheduleRebuildIfStale() {
+  if (!IsStale()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(rebuild_latch_);
+  if (rebuild_scheduled_ || stop_) {
+    return;
+  }
+  rebuild_scheduled_ = true;
+  if (!rebuild_thread_.joinable()) {
+    rebuild_thread_ = std::thread(&BloomFilter::RebuildLoop, this);
+  }
+  work_cv_.notify_one();
+}
+
+/*
+ * Writes made during a scan may leave the fresh filter stale already, in which case it is rebuilt again. A rebuild
+ * that ran out of buffer pool pages leaves the filter stale, and bypassed, until the next write schedules another.
+ */
+void BloomFilter::RebuildLoop() {
+  std::unique_lock<std::mutex> lock(rebuild_latch_);
+  while (true) {
+    work_cv_.wait(lock, [&] { return stop_ || rebuild_scheduled_; });
+    if (stop_) {
+      return;
+    }
+    lock.unlock();
+    bool built = true;
+    try {
+      Build();
+    } catch (Exception &e) {
+      built = false;
+    }
+    lock.lock();
+    rebuild_scheduled_ = built && IsStale();
+    done_cv_.notify_all();
+  }
+}
+
+void BloomFilter::Build() {
+  // From here on adds are queued for the fresh pages, and removals are counted against them.
+  latch_.WLock();
+  building_ = true;
+  size_t removed = num_removed_;
+  latch_.WUnlock();
+
+  std::vector<uint64_t> hashes;
+  std::vector<page_id_t> page_ids;
+  // Called with the latch held exclusively, which keeps adders away from pending_.
+  auto abandon = [&] {
+    building_ = false;
+    pending_.clear();
+    latch_.WUnlock();
+    for (page_id_t page_id : page_ids) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+  };
+  try {
+    scan_([&](uint64_t hash) { hashes.push_back(hash); });
+    // At least one page, rounded up to whole pages; NewPage() hands out the pages zeroed.
+    size_t num_bits = std::max<size_t>(hashes.size() * bits_per_key_, 1);
+    size_t page_bits = BLOCKS_PER_PAGE * BLOCK_WORDS * 32;
+    size_t num_pages = (num_bits + page_bits - 1) / page_bits;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a Bloom filter page.");
+      }
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+    for (uint64_t hash : hashes) {
+      SetBits(page_ids, hash);
+    }
+  } catch (Exception &e) {
+    latch_.WLock();
+    abandon();
+    throw;
+  }
+
+  latch_.WLock();
+  try {
+    for (uint64_t hash : pending_) {
+      SetBits(page_ids, hash);
+    }
+  } catch (Exception &e) {
+    abandon();
+    throw;
+  }
+  size_t added = hashes.size() + pending_.size();
+  pending_.clear();
+  building_ = false;
+  page_ids_.swap(page_ids);
+  capacity_ = page_ids_.size() * BLOCKS_PER_PAGE * BLOCK_WORDS * 32 / bits_per_key_;
+  num_added_ = added;
+  num_removed_ -= removed;
+  build_count_++;
+  latch_.WUnlock();
+  // The old pages are unpinned: every reader of them held the latch.
+  for (page_id_t page_id : page_ids) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+void BloomFilter::SetBits(const std::vector<page_id_t> &page_ids, uint64_t hash) {
+  size_t block = BlockOf(hash, page_ids.size());
+  Page *page = FetchBlockPage(page_ids, block);
+  auto *words = reinterpret_cast<uint32_t *>(page->GetData()) + (block % BLOCKS_PER_PAGE) * BLOCK_WORDS;
+  for (size_t word = 0; word < BLOCK_WORDS; word++) {
+    __atomic_fetch_or(&words[word], MaskOf(hash, word), __ATOMIC_RELAXED);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
+auto BloomFilter::FetchBlockPage(const std::vector<page_id_t> &page_ids, size_t block) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_ids[block / BLOCKS_PER_PAGE]);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a Bloom filter page.");
+  }
+  return page;
+}
+
+/*
+ * The salts are the ones of the split block Bloom filters of Apache Parquet: odd constants whose products with the
+ * same hash spread over the bits of a word independently enough.
+ */
+auto BloomFilter::MaskOf(uint64_t hash, size_t word) -> uint32_t {
+  static constexpr uint32_t SALTS[BLOCK_WORDS] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                   0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+  return 1U << ((static_cast<uint32_t>(hash) * SALTS[word]) >> 27);
+}
+
+}  // namespace bustub
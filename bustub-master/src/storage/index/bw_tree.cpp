@@ -0,0 +1,606 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree.cpp
+//
+// Identification: src/storage/index/bw_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/bw_tree.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+BWTREE_TYPE::BwTree(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, int leaf_max_size,
+                    int internal_max_size)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(std::min(leaf_max_size, LEAF_PAGE_CAPACITY - 1)),
+      internal_max_size_(internal_max_size) {
+  auto *root = new LeafNode();
+  root->type_ = NodeType::LEAF;
+  root->level_ = 0;
+  root->chain_length_ = 0;
+  root->size_ = 0;
+  root->right_ = INVALID_NODE_ID;
+  root->next_ = nullptr;
+  std::lock_guard<std::mutex> guard(smo_latch_);
+  root_ = InstallNode(root);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BWTREE_TYPE::~BwTree() {
+  for (NodeId id = 0; id < next_node_id_; id++) {
+    DeleteChain(Slot(id));
+  }
+  for (auto &garbage : garbage_) {
+    for (Node *head : garbage) {
+      DeleteChain(head);
+    }
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  EpochGuard guard(this);
+  NodeId id;
+  Node *head = FindNode(&key, 0, &id);
+  ValueType value;
+  if (!FindInChain(head, key, &value)) {
+    return false;
+  }
+  result->push_back(value);
+  return true;
+}
+
+/*
+ * Each leaf is read under an epoch of its own, and the next leaf is found again from the root with the high key of
+ * the one before, so that a long scan does not hold back the freeing of retired chains.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn) {
+  KeyType bound;
+  const KeyType *next_low = low;
+  if (low != nullptr) {
+    bound = *low;
+    next_low = &bound;
+  }
+  while (true) {
+    std::vector<MappingType> pairs;
+    bool last;
+    KeyType high_key;
+    {
+      EpochGuard guard(this);
+      NodeId id;
+      Node *head = FindNode(next_low, 0, &id);
+      pairs = CollectPairs(head);
+      last = head->right_ == INVALID_NODE_ID;
+      high_key = head->high_key_;
+    }
+    auto it = pairs.begin();
+    if (next_low != nullptr) {
+      it = std::lower_bound(pairs.begin(), pairs.end(), *next_low, [this](const MappingType &lhs, const KeyType &rhs) {
+        return comparator_(lhs.first, rhs) < 0;
+      });
+    }
+    for (; it != pairs.end(); ++it) {
+      if (!fn(it->first, it->second)) {
+        return;
+      }
+    }
+    if (last) {
+      return;
+    }
+    bound = high_key;
+    next_low = &bound;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::MoveRight(NodeId *id, const KeyType *key) const -> Node * {
+  Node *head = Slot(*id);
+  while (!IsBelowHigh(head, key)) {
+    *id = head->right_;
+    head = Slot(*id);
+  }
+  return head;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::FindNode(const KeyType *key, uint32_t level, NodeId *id) const -> Node * {
+  *id = root_;
+  while (true) {
+    Node *head = MoveRight(id, key);
+    if (head->level_ == level) {
+      return head;
+    }
+    *id = FindChild(head, key);
+  }
+}
+
+/*
+ * The child holding a key is the one with the largest separator not above it, whether its entry is in the base node
+ * or in a delta. Entries of the base node past the high key may still be there after a split, but the key lies below
+ * the high key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::FindChild(const Node *head, const KeyType *key) const -> NodeId {
+  const Delta *best = nullptr;
+  const Node *node = head;
+  for (; node->type_ != NodeType::INNER; node = node->next_) {
+    if (node->type_ != NodeType::INDEX_ENTRY || key == nullptr) {
+      continue;
+    }
+    const auto *delta = static_cast<const Delta *>(node);
+    if (comparator_(delta->key_, *key) <= 0 && (best == nullptr || comparator_(delta->key_, best->key_) > 0)) {
+      best = delta;
+    }
+  }
+  const auto &children = static_cast<const InnerNode *>(node)->children_;
+  size_t index = 0;
+  if (key != nullptr) {
+    auto it = std::upper_bound(
+        children.begin() + 1, children.end(), *key,
+        [this](const KeyType &lhs, const std::pair<KeyType, NodeId> &rhs) { return comparator_(lhs, rhs.first) < 0; });
+    index = static_cast<size_t>(it - children.begin()) - 1;
+  }
+  if (best != nullptr && (index == 0 || comparator_(best->key_, children[index].first) > 0)) {
+    return best->child_;
+  }
+  return children[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::FindInChain(const Node *head, const KeyType &key, ValueType *value) const -> bool {
+  const Node *node = head;
+  for (; node->type_ != NodeType::LEAF; node = node->next_) {
+    if (node->type_ != NodeType::INSERT && node->type_ != NodeType::DELETE) {
+      continue;
+    }
+    const auto *delta = static_cast<const Delta *>(node);
+    if (comparator_(delta->key_, key) == 0) {
+      if (delta->type_ == NodeType::DELETE) {
+        return false;
+      }
+      if (value != nullptr) {
+        *value = delta->value_;
+      }
+      return true;
+    }
+  }
+  const auto &pairs = static_cast<const LeafNode *>(node)->pairs_;
+  auto it = std::lower_bound(pairs.begin(), pairs.end(), key, [this](const MappingType &lhs, const KeyType &rhs) {
+    return comparator_(lhs.first, rhs) < 0;
+  });
+  if (it == pairs.end() || comparator_(it->first, key) != 0) {
+    return false;
+  }
+  if (value != nullptr) {
+    *value = it->second;
+  }
+  return true;
+}
+
+/*
+ * The deltas are applied from the oldest on. The pairs that moved to the right sibling in a split are still in the
+ * base node, and in deltas older than the split, so they are dropped at the end.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::CollectPairs(const Node *head) const -> std::vector<MappingType> {
+  std::vector<const Delta *> deltas;
+  const Node *node = head;
+  for (; node->type_ != NodeType::LEAF; node = node->next_) {
+    if (node->type_ == NodeType::INSERT || node->type_ == NodeType::DELETE) {
+      deltas.push_back(static_cast<const Delta *>(node));
+    }
+  }
+  std::vector<MappingType> pairs = static_cast<const LeafNode *>(node)->pairs_;
+  auto less = [this](const MappingType &lhs, const KeyType &rhs) { return comparator_(lhs.first, rhs) < 0; };
+  for (auto it = deltas.rbegin(); it != deltas.rend(); ++it) {
+    const Delta *delta = *it;
+    auto position = std::lower_bound(pairs.begin(), pairs.end(), delta->key_, less);
+    if (delta->type_ == NodeType::INSERT) {
+      pairs.emplace(position, delta->key_, delta->value_);
+    } else if (position != pairs.end() && comparator_(position->first, delta->key_) == 0) {
+      pairs.erase(position);
+    }
+  }
+  if (head->right_ != INVALID_NODE_ID) {
+    pairs.erase(std::lower_bound(pairs.begin(), pairs.end(), head->high_key_, less), pairs.end());
+  }
+  return pairs;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::CollectChildren(const Node *head) const -> std::vector<std::pair<KeyType, NodeId>> {
+  std::vector<const Delta *> deltas;
+  const Node *node = head;
+  for (; node->type_ != NodeType::INNER; node = node->next_) {
+    if (node->type_ == NodeType::INDEX_ENTRY) {
+      deltas.push_back(static_cast<const Delta *>(node));
+    }
+  }
+  std::vector<std::pair<KeyType, NodeId>> children = static_cast<const InnerNode *>(node)->children_;
+  auto less = [this](const std::pair<KeyType, NodeId> &lhs, const KeyType &rhs) {
+    return comparator_(lhs.first, rhs) < 0;
+  };
+  for (const Delta *delta : deltas) {
+    children.emplace(std::lower_bound(children.begin() + 1, children.end(), delta->key_, less), delta->key_,
+                     delta->child_);
+  }
+  if (head->right_ != INVALID_NODE_ID) {
+    children.erase(std::lower_bound(children.begin() + 1, children.end(), head->high_key_, less), children.end());
+  }
+  return children;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  EpochGuard guard(this);
+  NodeId id;
+  Node *head = FindNode(&key, 0, &id);
+  auto *delta = new Delta;
+  delta->key_ = key;
+  delta->value_ = value;
+  while (true) {
+    if (FindInChain(head, key, nullptr)) {
+      delete delta;
+      return false;
+    }
+    Stack(delta, NodeType::INSERT, head);
+    delta->size_++;
+    if (Slot(id).compare_exchange_strong(head, delta)) {
+      break;
+    }
+    // another writer changed the leaf, which may have split
+    head = MoveRight(&id, &key);
+  }
+  if (delta->size_ > leaf_max_size_) {
+    std::lock_guard<std::mutex> smo_guard(smo_latch_);
+    SplitNode(id);
+  } else if (delta->chain_length_ >= MAX_CHAIN_LENGTH) {
+    Consolidate(id, delta);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::Remove(const KeyType &key) -> bool {
+  EpochGuard guard(this);
+  NodeId id;
+  Node *head = FindNode(&key, 0, &id);
+  auto *delta = new Delta;
+  delta->key_ = key;
+  while (true) {
+    if (!FindInChain(head, key, nullptr)) {
+      delete delta;
+      return false;
+    }
+    Stack(delta, NodeType::DELETE, head);
+    delta->size_--;
+    if (Slot(id).compare_exchange_strong(head, delta)) {
+      break;
+    }
+    head = MoveRight(&id, &key);
+  }
+  if (delta->chain_length_ >= MAX_CHAIN_LENGTH) {
+    Consolidate(id, delta);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::Stack(Delta *delta, NodeType type, Node *next) {
+  delta->type_ = type;
+  delta->level_ = next->level_;
+  delta->chain_length_ = next->chain_length_ + 1;
+  delta->size_ = next->size_;
+  delta->high_key_ = next->high_key_;
+  delta->right_ = next->right_;
+  delta->next_ = next;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::Consolidate(NodeId id, Node *head) -> bool {
+  Node *base;
+  if (head->level_ == 0) {
+    auto *leaf = new LeafNode;
+    leaf->pairs_ = CollectPairs(head);
+    leaf->type_ = NodeType::LEAF;
+    leaf->size_ = static_cast<int>(leaf->pairs_.size());
+    base = leaf;
+  } else {
+    auto *inner = new InnerNode;
+    inner->children_ = CollectChildren(head);
+    inner->type_ = NodeType::INNER;
+    inner->size_ = static_cast<int>(inner->children_.size());
+    base = inner;
+  }
+  base->level_ = head->level_;
+  base->chain_length_ = 0;
+  base->high_key_ = head->high_key_;
+  base->right_ = head->right_;
+  base->next_ = nullptr;
+  if (!Slot(id).compare_exchange_strong(head, base)) {
+    DeleteChain(base);
+    return false;
+  }
+  Retire(head);
+  return true;
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::InstallNode(Node *node) -> NodeId {
+  NodeId id = next_node_id_;
+  if (id >= MAPPING_CHUNK_SIZE * MAPPING_CHUNKS) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "The mapping table of the Bw-tree is full.");
+  }
+  auto &chunk = mapping_[id / MAPPING_CHUNK_SIZE];
+  if (chunk == nullptr) {
+    chunk = std::make_unique<std::atomic<Node *>[]>(MAPPING_CHUNK_SIZE);
+  }
+  next_node_id_++;
+  Slot(id) = node;
+  return id;
+}
+
+/*
+ * A write to a leaf makes the compare-and-swap of the split delta fail, and the split is done again from the new
+ * chain; the copy of the upper half is never seen by anyone, so it is freed and its id reused. Inner nodes only
+ * change under smo_latch_, so their splits always go through.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::SplitNode(NodeId id) {
+  Node *head = Slot(id);
+  while (head->size_ > (head->level_ == 0 ? leaf_max_size_ : internal_max_size_)) {
+    Node *sibling;
+    KeyType separator;
+    int kept;
+    if (head->level_ == 0) {
+      auto pairs = CollectPairs(head);
+      kept = static_cast<int>(pairs.size() / 2);
+      separator = pairs[kept].first;
+      auto *leaf = new LeafNode;
+      leaf->pairs_.assign(pairs.begin() + kept, pairs.end());
+      leaf->type_ = NodeType::LEAF;
+      leaf->size_ = static_cast<int>(leaf->pairs_.size());
+      sibling = leaf;
+    } else {
+      auto children = CollectChildren(head);
+      kept = static_cast<int>(children.size() / 2);
+      separator = children[kept].first;
+      auto *inner = new InnerNode;
+      inner->children_.assign(children.begin() + kept, children.end());
+      inner->type_ = NodeType::INNER;
+      inner->size_ = static_cast<int>(inner->children_.size());
+      sibling = inner;
+    }
+    sibling->level_ = head->level_;
+    sibling->chain_length_ = 0;
+    sibling->high_key_ = head->high_key_;
+    sibling->right_ = head->right_;
+    sibling->next_ = nullptr;
+    NodeId sibling_id = InstallNode(sibling);
+
+    auto *split = new Delta;
+    Stack(split, NodeType::SPLIT, head);
+    split->size_ = kept;
+    split->high_key_ = separator;
+    split->right_ = sibling_id;
+    if (Slot(id).compare_exchange_strong(head, split)) {
+      PostSeparator(id, split->level_, separator, sibling_id);
+      return;
+    }
+    delete split;
+    DeleteChain(sibling);
+    Slot(sibling_id) = nullptr;
+    next_node_id_--;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::PostSeparator(NodeId left, uint32_t level, const KeyType &separator, NodeId right) {
+  if (root_ == left) {
+    auto *root = new InnerNode();
+    root->children_.emplace_back(KeyType{}, left);
+    root->children_.emplace_back(separator, right);
+    root->type_ = NodeType::INNER;
+    root->level_ = level + 1;
+    root->chain_length_ = 0;
+    root->size_ = 2;
+    root->right_ = INVALID_NODE_ID;
+    root->next_ = nullptr;
+    root_ = InstallNode(root);
+    return;
+  }
+  // The parent that holds the separator holds the split node too, since the node held the separator before.
+  NodeId parent;
+  Node *head = FindNode(&separator, level + 1, &parent);
+  auto *entry = new Delta;
+  Stack(entry, NodeType::INDEX_ENTRY, head);
+  entry->key_ = separator;
+  entry->child_ = right;
+  entry->size_++;
+  Slot(parent) = entry;
+  if (entry->size_ > internal_max_size_) {
+    SplitNode(parent);
+  } else if (entry->chain_length_ >= MAX_CHAIN_LENGTH) {
+    Consolidate(parent, entry);
+  }
+}
+
+/*****************************************************************************
+ * EPOCHS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::EnterEpoch() -> uint64_t {
+  while (true) {
+    uint64_t epoch = epoch_;
+    active_[epoch % 2]++;
+    if (epoch_ == epoch) {
+      return epoch;
+    }
+    // the epoch moved on before the operation registered; it may have been counted out already
+    active_[epoch % 2]--;
+  }
+}
+
+/*
+ * Operations run in the current epoch or the one before. A chain retired in the epoch before the one before was
+ * swapped out before any running operation started, so once no operation of the epoch before is left, the epoch moves
+ * on and those chains are freed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::Retire(Node *head) {
+  std::vector<Node *> freed;
+  {
+    std::lock_guard<std::mutex> guard(garbage_latch_);
+    uint64_t epoch = epoch_;
+    garbage_[epoch % 3].push_back(head);
+    if (active_[(epoch + 1) % 2] == 0) {
+      freed.swap(garbage_[(epoch + 2) % 3]);
+      epoch_ = epoch + 1;
+    }
+  }
+  for (Node *chain : freed) {
+    DeleteChain(chain);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::DeleteChain(Node *head) {
+  while (head != nullptr) {
+    Node *next = head->next_;
+    if (head->type_ == NodeType::LEAF) {
+      delete static_cast<LeafNode *>(head);
+    } else if (head->type_ == NodeType::INNER) {
+      delete static_cast<InnerNode *>(head);
+    } else {
+      delete static_cast<Delta *>(head);
+    }
+    head = next;
+  }
+}
+
+/*****************************************************************************
+ * FLUSH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::Flush() -> page_id_t {
+  std::lock_guard<std::mutex> flush_guard(flush_latch_);
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  NodeId id;
+  {
+    EpochGuard guard(this);
+    FindNode(nullptr, 0, &id);
+  }
+  while (id != INVALID_NODE_ID) {
+    std::vector<MappingType> pairs;
+    NodeId right;
+    {
+      EpochGuard guard(this);
+      Node *head = Slot(id);
+      if (head->size_ > leaf_max_size_) {
+        // an insert is about to split it, and it may not fit its page until then
+        std::lock_guard<std::mutex> smo_guard(smo_latch_);
+        SplitNode(id);
+        continue;
+      }
+      pairs = CollectPairs(head);
+      right = head->right_;
+      if (head->chain_length_ > 0) {
+        Consolidate(id, head);
+      }
+    }
+
+    page_id_t page_id = PageOf(id);
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch the page of a leaf.");
+    }
+    auto *header = reinterpret_cast<LeafPageHeader *>(page->GetData());
+    header->size_ = static_cast<int>(pairs.size());
+    header->next_page_id_ = right == INVALID_NODE_ID ? INVALID_PAGE_ID : PageOf(right);
+    std::copy(pairs.begin(), pairs.end(), reinterpret_cast<MappingType *>(page->GetData() + sizeof(LeafPageHeader)));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    if (first_page_id == INVALID_PAGE_ID) {
+      first_page_id = page_id;
+    }
+    id = right;
+  }
+  return first_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::Load(page_id_t first_page_id) {
+  std::vector<MappingType> pairs;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch the page of a leaf.");
+    }
+    const auto *header = reinterpret_cast<const LeafPageHeader *>(page->GetData());
+    const auto *begin = reinterpret_cast<const MappingType *>(page->GetData() + sizeof(LeafPageHeader));
+    pairs.assign(begin, begin + header->size_);
+    page_id_t next_page_id = header->next_page_id_;
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    for (const auto &pair : pairs) {
+      Insert(pair.first, pair.second);
+    }
+    page_id = next_page_id;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BWTREE_TYPE::Destroy(std::vector<page_id_t> *pinned_page_ids) {
+  std::lock_guard<std::mutex> guard(flush_latch_);
+  for (const auto &[id, page_id] : leaf_pages_) {
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      pinned_page_ids->push_back(page_id);
+    }
+  }
+  leaf_pages_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BWTREE_TYPE::PageOf(NodeId id) -> page_id_t {
+  auto it = leaf_pages_.find(id);
+  if (it != leaf_pages_.end()) {
+    return it->second;
+  }
+  page_id_t page_id;
+  if (buffer_pool_manager_->NewPage(&page_id) == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a page for a leaf.");
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  leaf_pages_.emplace(id, page_id);
+  return page_id;
+}
+
+template class BwTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BwTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BwTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BwTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BwTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
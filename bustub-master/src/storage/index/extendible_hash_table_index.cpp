@@ -18,28 +18,67 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
 
-  container_.Insert(transaction, index_key, rid);
+  if (container_.Insert(transaction, index_key, rid) && bloom_filter_ != nullptr) {
+    bloom_filter_->Add(HashFunction<KeyType>().GetHash(index_key));
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
 
-  container_.Remove(transaction, index_key, rid);
+  if (container_.Remove(transaction, index_key, rid) && bloom_filter_ != nullptr) {
+    bloom_filter_->NoteRemove();
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), comparator_.IsNormalized());
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(HashFunction<KeyType>().GetHash(index_key))) {
+    return;
+  }
 
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                     Transaction *transaction) {
+  // only the keys that pass the filter are looked up
+  std::vector<KeyType> index_keys;
+  std::vector<size_t> positions;
+  for (size_t i = 0; i < keys.size(); i++) {
+    KeyType index_key;
+    index_key.SetFromKey(keys[i], GetKeySchema(), comparator_.IsNormalized());
+    if (bloom_filter_ == nullptr || bloom_filter_->MayContain(HashFunction<KeyType>().GetHash(index_key))) {
+      index_keys.push_back(index_key);
+      positions.push_back(i);
+    }
+  }
+  std::vector<std::vector<RID>> found;
+  container_.GetValues(transaction, index_keys, &found);
+  results->assign(keys.size(), std::vector<RID>{});
+  for (size_t i = 0; i < positions.size(); i++) {
+    (*results)[positions[i]] = std::move(found[i]);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_INDEX_TYPE::EnableBloomFilter(BufferPoolManager *buffer_pool_manager, size_t bits_per_key) -> bool {
+  bloom_filter_ = std::make_unique<BloomFilter>(
+      buffer_pool_manager, bits_per_key, [this](const std::function<void(uint64_t)> &add) {
+        container_.ForEachKey([&](const KeyType &key) { add(HashFunction<KeyType>().GetHash(key)); });
+      });
+  return true;
+}
+
 template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
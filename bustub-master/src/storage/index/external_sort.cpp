@@ -0,0 +1,261 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/storage/index/external_sort.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sort.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                 size_t buffer_pages)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      buffer_pages_(std::max<size_t>(buffer_pages, 2)) {
+  buffer_.reserve(buffer_pages_ * RUN_PAGE_CAPACITY);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::~ExternalSort() {
+  if (write_page_ != nullptr) {
+    Header(write_page_)->next_page_id_ = INVALID_PAGE_ID;
+    runs_.push_back(FinishRun());
+  }
+  for (auto &cursor : cursors_) {
+    if (cursor.page_ != nullptr) {
+      page_id_t page_id = cursor.page_->GetPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      DeleteRun(page_id);
+    }
+  }
+  for (page_id_t page_id : runs_) {
+    DeleteRun(page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!sorted_, "Pairs cannot be added once sorted.");
+  if (buffer_.size() == buffer_pages_ * RUN_PAGE_CAPACITY) {
+    SpillBuffer();
+  }
+  buffer_.emplace_back(key, value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Flush() {
+  BUSTUB_ASSERT(!sorted_, "Pairs cannot be flushed once sorted.");
+  if (!buffer_.empty()) {
+    SpillBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::AdoptRuns(ExternalSort *other) {
+  BUSTUB_ASSERT(!sorted_ && other->buffer_.empty(), "Runs can only be adopted from a flushed sorter before sorting.");
+  runs_.insert(runs_.end(), other->runs_.begin(), other->runs_.end());
+  spilled_runs_ += other->spilled_runs_;
+  other->runs_.clear();
+  other->spilled_runs_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Sort() {
+  sorted_ = true;
+  if (runs_.empty()) {
+    // Everything fits in memory: no run is written at all.
+    std::sort(buffer_.begin(), buffer_.end(),
+              [this](const MappingType &lhs, const MappingType &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+    return;
+  }
+  if (!buffer_.empty()) {
+    SpillBuffer();
+  }
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+
+  // Each merge pins one page per input run plus the output page, so merge at most buffer_pages_ runs at once.
+  while (runs_.size() > buffer_pages_) {
+    std::vector<page_id_t> merged;
+    for (size_t begin = 0; begin < runs_.size(); begin += buffer_pages_) {
+      size_t end = std::min(begin + buffer_pages_, runs_.size());
+      OpenMerge(begin, end);
+      MappingType pair;
+      while (NextMerged(&pair)) {
+        AppendToRun(pair);
+      }
+      merged.push_back(FinishRun());
+    }
+    runs_ = std::move(merged);
+  }
+  OpenMerge(0, runs_.size());
+  runs_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::Next(MappingType *pair) -> bool {
+  BUSTUB_ASSERT(sorted_, "Sort() must be called before Next().");
+  if (!cursors_.empty()) {
+    return NextMerged(pair);
+  }
+  if (buffer_next_ == buffer_.size()) {
+    return false;
+  }
+  *pair = buffer_[buffer_next_++];
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::NewRunPage() -> Page * {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a page for a sorted run.");
+  }
+  Header(page)->next_page_id_ = INVALID_PAGE_ID;
+  Header(page)->size_ = 0;
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::SpillBuffer() {
+  std::sort(buffer_.begin(), buffer_.end(),
+            [this](const MappingType &lhs, const MappingType &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+  for (const auto &pair : buffer_) {
+    AppendToRun(pair);
+  }
+  runs_.push_back(FinishRun());
+  buffer_.clear();
+  spilled_runs_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::AppendToRun(const MappingType &pair) {
+  if (write_page_ == nullptr) {
+    write_page_ = NewRunPage();
+    write_first_page_id_ = write_page_->GetPageId();
+  } else if (Header(write_page_)->size_ == RUN_PAGE_CAPACITY) {
+    Page *next = NewRunPage();
+    Header(write_page_)->next_page_id_ = next->GetPageId();
+    buffer_pool_manager_->UnpinPage(write_page_->GetPageId(), true);
+    write_page_ = next;
+  }
+  auto *header = Header(write_page_);
+  Pairs(write_page_)[header->size_++] = pair;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::FinishRun() -> page_id_t {
+  if (write_page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(write_page_->GetPageId(), true);
+    write_page_ = nullptr;
+  }
+  page_id_t first_page_id = write_first_page_id_;
+  write_first_page_id_ = INVALID_PAGE_ID;
+  return first_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::OpenMerge(size_t begin, size_t end) {
+  cursors_.clear();
+  heap_.clear();
+  for (size_t i = begin; i < end; i++) {
+    if (runs_[i] == INVALID_PAGE_ID) {
+      continue;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(runs_[i]);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a page of a sorted run.");
+    }
+    // The run is owned by its cursor from now on.
+    runs_[i] = INVALID_PAGE_ID;
+    cursors_.push_back(RunCursor{page, 0});
+  }
+  auto greater = [this](size_t lhs, size_t rhs) {
+    const auto &l = cursors_[lhs];
+    const auto &r = cursors_[rhs];
+    return comparator_(Pairs(l.page_)[l.index_].first, Pairs(r.page_)[r.index_].first) > 0;
+  };
+  for (size_t i = 0; i < cursors_.size(); i++) {
+    heap_.push_back(i);
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::NextMerged(MappingType *pair) -> bool {
+  if (heap_.empty()) {
+    return false;
+  }
+  auto greater = [this](size_t lhs, size_t rhs) {
+    const auto &l = cursors_[lhs];
+    const auto &r = cursors_[rhs];
+    return comparator_(Pairs(l.page_)[l.index_].first, Pairs(r.page_)[r.index_].first) > 0;
+  };
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  size_t smallest = heap_.back();
+  auto &cursor = cursors_[smallest];
+  *pair = Pairs(cursor.page_)[cursor.index_];
+  if (Advance(&cursor)) {
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::Advance(RunCursor *cursor) -> bool {
+  if (++cursor->index_ < Header(cursor->page_)->size_) {
+    return true;
+  }
+  page_id_t page_id = cursor->page_->GetPageId();
+  page_id_t next_page_id = Header(cursor->page_)->next_page_id_;
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+  cursor->page_ = nullptr;
+  if (next_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  cursor->page_ = buffer_pool_manager_->FetchPage(next_page_id);
+  if (cursor->page_ == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a page of a sorted run.");
+  }
+  cursor->index_ = 0;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::DeleteRun(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      return;
+    }
+    page_id_t next_page_id = Header(page)->next_page_id_;
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+template class ExternalSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSort<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
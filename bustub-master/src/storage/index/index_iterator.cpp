@@ -1,8 +1,11 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -12,19 +15,150 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                                  const std::vector<page_id_t> &following, LeafLookup leaf_lookup)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(page == nullptr ? nullptr : reinterpret_cast<LeafPage *>(page->GetData())),
+      page_id_(page == nullptr ? INVALID_PAGE_ID : page->GetPageId()),
+      index_(index),
+      following_(following.begin(), following.end()),
+      prefetched_(0),
+      leaf_lookup_(std::move(leaf_lookup)) {
+  if (page_ != nullptr) {
+    Prefetch();
+  }
+  SkipExhaustedLeaves();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      page_id_(other.page_id_),
+      index_(other.index_),
+      following_(std::move(other.following_)),
+      prefetched_(other.prefetched_),
+      leaf_lookup_(std::move(other.leaf_lookup_)) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+  other.page_id_ = INVALID_PAGE_ID;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    page_id_ = other.page_id_;
+    index_ = other.index_;
+    following_ = std::move(other.following_);
+    prefetched_ = other.prefetched_;
+    leaf_lookup_ = std::move(other.leaf_lookup_);
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+  }
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return leaf_->GetItem(index_); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+/*
+ * Only one leaf is latched at a time: the next leaf is pinned before the current one is released and latched after.
+ * Writers latch a left sibling while holding its right neighbour, so holding both here could deadlock. A leaf that
+ * a concurrent merge empties in between is simply skipped over. The leaves ahead are looked up in between as well,
+ * when no latch is held, since the lookup descends from the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    Release();
+    if (next == nullptr) {
+      if (next_page_id != INVALID_PAGE_ID) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch the next leaf page.");
+      }
+      return;
+    }
+    Advance(next, next_page_id);
+    next->RLatch();
+    page_ = next;
+    leaf_ = reinterpret_cast<LeafPage *>(next->GetData());
+    page_id_ = next_page_id;
+    index_ = 0;
+    Prefetch();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Advance(Page *next, page_id_t next_page_id) {
+  auto known = std::find(following_.begin(), following_.end(), next_page_id);
+  if (known != following_.end()) {
+    size_t passed = known - following_.begin() + 1;
+    following_.erase(following_.begin(), known + 1);
+    prefetched_ = prefetched_ > passed ? prefetched_ - passed : 0;
+    return;
+  }
+  following_.clear();
+  prefetched_ = 0;
+  if (leaf_lookup_ == nullptr) {
+    return;
+  }
+  next->RLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(next->GetData());
+  bool has_key = leaf->GetSize() > 0;
+  KeyType key;
+  if (has_key) {
+    key = leaf->KeyAt(0);
+  }
+  next->RUnlatch();
+  if (has_key) {
+    std::vector<page_id_t> following;
+    leaf_lookup_(key, &following);
+    following_.assign(following.begin(), following.end());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Prefetch() {
+  page_id_t next_page_id = leaf_->GetNextPageId();
+  if (next_page_id != INVALID_PAGE_ID && (following_.empty() || following_.front() != next_page_id)) {
+    buffer_pool_manager_->PrefetchPage(next_page_id);
+  }
+  for (; prefetched_ < std::min(PREFETCH_DEPTH, following_.size()); prefetched_++) {
+    buffer_pool_manager_->PrefetchPage(following_[prefetched_]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+    page_id_ = INVALID_PAGE_ID;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -0,0 +1,595 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree.cpp
+//
+// Identification: src/storage/index/lsm_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/lsm_tree.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <limits>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/hash/hash_function.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::LsmTree(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, LsmTreeOptions options)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), options_(options) {
+  auto version = std::make_unique<Version>();
+  version->memtable_ = std::make_shared<MemTable>(comparator_);
+  version->levels_.resize(1);
+  memtable_ = version->memtable_.get();
+  version_ = std::move(version);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::~LsmTree() {
+  {
+    std::lock_guard<std::mutex> guard(version_latch_);
+    stop_ = true;
+  }
+  work_cv_.notify_one();
+  done_cv_.notify_all();
+  if (compaction_thread_.joinable()) {
+    compaction_thread_.join();
+  }
+}
+
+/*****************************************************************************
+ * WRITES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Insert(const KeyType &key, const ValueType &value) { Write(Entry{key, value, false}); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Remove(const KeyType &key) { Write(Entry{key, ValueType{}, true}); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Write(const Entry &entry) {
+  memtable_latch_.RLock();
+  MemTable *memtable = memtable_;
+  memtable->Put(entry, next_sequence_++);
+  bool full = memtable->GetSize() >= options_.memtable_entries_;
+  memtable_latch_.RUnlock();
+  if (full) {
+    Freeze(memtable, true);
+  }
+}
+
+/*
+ * Every writer that finds the memtable full comes here, and the first one to get room freezes it. Until then, the
+ * writers wait for the background thread to write out a frozen memtable, which keeps the memtables from piling up
+ * when writes come in faster than the runs are written.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Freeze(const MemTable *memtable, bool wait_for_room) {
+  std::unique_lock<std::mutex> lock(version_latch_);
+  if (wait_for_room) {
+    done_cv_.wait(lock, [&] {
+      return stop_ || memtable_ != memtable || version_->frozen_.size() < options_.max_frozen_memtables_;
+    });
+  }
+  if (stop_ || memtable_ != memtable) {
+    return;
+  }
+  auto version = std::make_unique<Version>(*version_);
+  // wait for the writers still putting entries into the memtable
+  memtable_latch_.WLock();
+  version->frozen_.push_back(version->memtable_);
+  version->memtable_ = std::make_shared<MemTable>(comparator_);
+  memtable_ = version->memtable_.get();
+  memtable_latch_.WUnlock();
+  InstallVersion(std::move(version));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Flush() {
+  memtable_latch_.RLock();
+  MemTable *memtable = memtable_;
+  bool empty = memtable->GetSize() == 0;
+  memtable_latch_.RUnlock();
+  if (!empty) {
+    Freeze(memtable, false);
+  }
+  std::unique_lock<std::mutex> lock(version_latch_);
+  done_cv_.wait(lock, [&] { return stop_ || (version_->frozen_.empty() && !busy_ && PickCompaction(*version_) < 0); });
+}
+
+/*****************************************************************************
+ * READS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  auto version = GetVersion();
+  const Entry *newest = version->memtable_->Find(key);
+  for (auto it = version->frozen_.rbegin(); newest == nullptr && it != version->frozen_.rend(); ++it) {
+    newest = (*it)->Find(key);
+  }
+  Entry entry;
+  bool found = newest != nullptr;
+  if (found) {
+    entry = *newest;
+  }
+  const auto &level0 = version->levels_[0];
+  for (auto it = level0.rbegin(); !found && it != level0.rend(); ++it) {
+    found = (*it)->Find(key, &entry);
+  }
+  for (size_t level = 1; !found && level < version->levels_.size(); level++) {
+    for (const auto &run : version->levels_[level]) {
+      found = found || run->Find(key, &entry);
+    }
+  }
+  if (!found || entry.deleted_) {
+    return false;
+  }
+  result->push_back(entry.value_);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Scan(const KeyType *low, const std::function<bool(const KeyType &, const ValueType &)> &fn) {
+  auto version = GetVersion();
+  auto cursors = OpenCursors(*version, low);
+  Entry entry;
+  while (MergeNext(&cursors, true, &entry)) {
+    if (!fn(entry.key_, entry.value_)) {
+      return;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetRunCounts() -> std::vector<size_t> {
+  auto version = GetVersion();
+  std::vector<size_t> counts;
+  for (const auto &level : version->levels_) {
+    counts.push_back(level.size());
+  }
+  return counts;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::OpenCursors(const Version &version, const KeyType *low) -> std::vector<Cursor> {
+  std::vector<Cursor> cursors;
+  cursors.emplace_back(version.memtable_.get(), low);
+  for (auto it = version.frozen_.rbegin(); it != version.frozen_.rend(); ++it) {
+    cursors.emplace_back(it->get(), low);
+  }
+  for (auto it = version.levels_[0].rbegin(); it != version.levels_[0].rend(); ++it) {
+    cursors.emplace_back(it->get(), low, comparator_);
+  }
+  for (size_t level = 1; level < version.levels_.size(); level++) {
+    for (const auto &run : version.levels_[level]) {
+      cursors.emplace_back(run.get(), low, comparator_);
+    }
+  }
+  return cursors;
+}
+
+/*
+ * The cursors are few, one per memtable and run, so the smallest key is found by looking at each of them; on ties
+ * the first one, which is the newest, wins.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::MergeNext(std::vector<Cursor> *cursors, bool drop_tombstones, Entry *entry) -> bool {
+  while (true) {
+    const Cursor *smallest = nullptr;
+    for (const auto &cursor : *cursors) {
+      if (cursor.IsValid() && (smallest == nullptr || comparator_(cursor.Get().key_, smallest->Get().key_) < 0)) {
+        smallest = &cursor;
+      }
+    }
+    if (smallest == nullptr) {
+      return false;
+    }
+    *entry = smallest->Get();
+    for (auto &cursor : *cursors) {
+      if (cursor.IsValid() && comparator_(cursor.Get().key_, entry->key_) == 0) {
+        cursor.Next();
+      }
+    }
+    if (!drop_tombstones || !entry->deleted_) {
+      return true;
+    }
+  }
+}
+
+/*****************************************************************************
+ * VERSIONS AND COMPACTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetVersion() -> std::shared_ptr<const Version> {
+  std::lock_guard<std::mutex> guard(version_latch_);
+  return version_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::InstallVersion(std::unique_ptr<Version> version) {
+  version_ = std::move(version);
+  if (!compaction_thread_.joinable()) {
+    compaction_thread_ = std::thread(&LsmTree::CompactionLoop, this);
+  }
+  work_cv_.notify_one();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::PickCompaction(const Version &version) const -> int {
+  if (version.levels_[0].size() >= options_.level0_runs_) {
+    return 0;
+  }
+  size_t limit = options_.level0_runs_ * options_.memtable_entries_;
+  for (size_t level = 1; level < version.levels_.size(); level++) {
+    limit *= options_.size_ratio_;
+    if (!version.levels_[level].empty() && version.levels_[level][0]->GetSize() > limit) {
+      return static_cast<int>(level);
+    }
+  }
+  return -1;
+}
+
+/*
+ * The background thread is the only one to change the runs, so the version it works from still has the same runs
+ * when it installs the result; only the memtables may have changed meanwhile. If the buffer pool has no page to
+ * spare, it tries again a little later.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::CompactionLoop() {
+  std::unique_lock<std::mutex> lock(version_latch_);
+  while (true) {
+    work_cv_.wait(lock, [&] { return stop_ || !version_->frozen_.empty() || PickCompaction(*version_) >= 0; });
+    if (stop_) {
+      return;
+    }
+    std::shared_ptr<const Version> version = version_;
+    busy_ = true;
+    lock.unlock();
+
+    std::function<void(Version *)> apply;
+    try {
+      if (!version->frozen_.empty()) {
+        // Tombstones stay, since they hide the entries of the older runs.
+        std::vector<Cursor> cursors;
+        cursors.emplace_back(version->frozen_.front().get(), nullptr);
+        auto run = NewRun([&](Entry *entry) { return MergeNext(&cursors, false, entry); });
+        apply = [run](Version *next) {
+          next->frozen_.erase(next->frozen_.begin());
+          if (run != nullptr) {
+            next->levels_[0].push_back(run);
+          }
+        };
+      } else {
+        auto level = static_cast<size_t>(PickCompaction(*version));
+        auto run = Compact(*version, level);
+        size_t merged = version->levels_[level].size();
+        apply = [run, level, merged](Version *next) {
+          auto &upper = next->levels_[level];
+          upper.erase(upper.begin(), upper.begin() + merged);
+          if (next->levels_.size() == level + 1) {
+            next->levels_.emplace_back();
+          }
+          next->levels_[level + 1].clear();
+          if (run != nullptr) {
+            next->levels_[level + 1].push_back(run);
+          }
+        };
+      }
+    } catch (Exception &e) {
+      apply = nullptr;
+    }
+
+    lock.lock();
+    if (apply) {
+      auto next = std::make_unique<Version>(*version_);
+      apply(next.get());
+      version_ = std::move(next);
+    } else {
+      work_cv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    busy_ = false;
+    done_cv_.notify_all();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Compact(const Version &version, size_t level) -> std::shared_ptr<Run> {
+  std::vector<Cursor> cursors;
+  const auto &upper = version.levels_[level];
+  for (auto it = upper.rbegin(); it != upper.rend(); ++it) {
+    cursors.emplace_back(it->get(), nullptr, comparator_);
+  }
+  bool last_level = true;
+  for (size_t lower = level + 1; lower < version.levels_.size(); lower++) {
+    for (const auto &run : version.levels_[lower]) {
+      if (lower == level + 1) {
+        cursors.emplace_back(run.get(), nullptr, comparator_);
+      } else {
+        last_level = false;
+      }
+    }
+  }
+  // Below the last level there is nothing left for a tombstone to hide.
+  return NewRun([&](Entry *entry) { return MergeNext(&cursors, last_level, entry); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::NewRun(const std::function<bool(Entry *)> &next) -> std::shared_ptr<Run> {
+  Entry first;
+  if (!next(&first)) {
+    return nullptr;
+  }
+  bool took_first = false;
+  return std::make_shared<Run>(buffer_pool_manager_, comparator_, options_.bloom_filter_bits_per_key_,
+                               [&](Entry *entry) {
+                                 if (!took_first) {
+                                   took_first = true;
+                                   *entry = first;
+                                   return true;
+                                 }
+                                 return next(entry);
+                               });
+}
+
+/*****************************************************************************
+ * MEMTABLE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::MemTable::~MemTable() {
+  Node *node = head_.next_[0];
+  while (node != nullptr) {
+    Node *next = node->next_[0];
+    delete node;
+    node = next;
+  }
+}
+
+/*
+ * The height of a node is drawn from its sequence number, which is unique: each level up is taken with probability
+ * 1/4, by two more bits of a multiplicative hash of it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::MemTable::Put(const Entry &entry, uint64_t sequence) {
+  auto *node = new Node;
+  node->entry_ = entry;
+  node->sequence_ = sequence;
+  node->height_ = 1;
+  uint64_t bits = ((sequence + 1) * 0x9E3779B97F4A7C15ULL) >> 32;
+  while (node->height_ < MAX_HEIGHT && (bits & 3) == 0) {
+    node->height_++;
+    bits >>= 2;
+  }
+
+  Node *preds[MAX_HEIGHT];
+  Node *succs[MAX_HEIGHT];
+  FindPosition(entry.key_, sequence, preds, succs);
+  for (int level = 0; level < node->height_; level++) {
+    while (true) {
+      Node *succ = succs[level];
+      node->next_[level] = succ;
+      if (preds[level]->next_[level].compare_exchange_strong(succ, node)) {
+        break;
+      }
+      FindPosition(entry.key_, sequence, preds, succs);
+    }
+  }
+  size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::MemTable::Find(const KeyType &key) const -> const Entry * {
+  const Node *node = LowerBound(&key);
+  return node != nullptr && comparator_(node->entry_.key_, key) == 0 ? &node->entry_ : nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::MemTable::Before(const Node *node, const KeyType &key, uint64_t sequence) const -> bool {
+  int cmp = comparator_(node->entry_.key_, key);
+  return cmp < 0 || (cmp == 0 && node->sequence_ > sequence);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::MemTable::FindPosition(const KeyType &key, uint64_t sequence, Node **preds, Node **succs) const {
+  auto *pred = const_cast<Node *>(&head_);
+  for (int level = MAX_HEIGHT - 1; level >= 0; level--) {
+    Node *succ = pred->next_[level];
+    while (succ != nullptr && Before(succ, key, sequence)) {
+      pred = succ;
+      succ = succ->next_[level];
+    }
+    preds[level] = pred;
+    succs[level] = succ;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::MemTable::LowerBound(const KeyType *key) const -> const Node * {
+  if (key == nullptr) {
+    return head_.next_[0];
+  }
+  // no write has the largest sequence number, so the position is in front of every entry of the key
+  Node *preds[MAX_HEIGHT];
+  Node *succs[MAX_HEIGHT];
+  FindPosition(*key, std::numeric_limits<uint64_t>::max(), preds, succs);
+  return succs[0];
+}
+
+/*****************************************************************************
+ * RUN
+ *****************************************************************************/
+/*
+ * The filter of a run is built once, from a scan of the pages just written: nothing is ever added to it or removed
+ * from it, so it never gets stale.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::Run::Run(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, size_t bits_per_key,
+                       const std::function<bool(Entry *)> &next)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {
+  Page *page = nullptr;
+  try {
+    Entry entry;
+    while (next(&entry)) {
+      if (page == nullptr || Header(page)->size_ == RUN_PAGE_CAPACITY) {
+        if (page != nullptr) {
+          buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+        }
+        page_id_t page_id;
+        page = buffer_pool_manager_->NewPage(&page_id);
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a page for a sorted run.");
+        }
+        Header(page)->size_ = 0;
+        page_ids_.push_back(page_id);
+        first_keys_.push_back(entry.key_);
+      }
+      Entries(page)[Header(page)->size_++] = entry;
+      size_++;
+    }
+    if (page != nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      page = nullptr;
+    }
+    bloom_filter_ = std::make_unique<BloomFilter>(
+        buffer_pool_manager_, bits_per_key, [this](const std::function<void(uint64_t)> &add) {
+          std::vector<Entry> entries;
+          for (size_t page_index = 0; page_index < page_ids_.size(); page_index++) {
+            ReadPage(page_index, &entries);
+            for (const auto &entry : entries) {
+              add(HashFunction<KeyType>().GetHash(entry.key_));
+            }
+          }
+        });
+  } catch (...) {
+    if (page != nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    for (page_id_t page_id : page_ids_) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    throw;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::Run::~Run() {
+  bloom_filter_.reset();
+  for (page_id_t page_id : page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Run::Find(const KeyType &key, Entry *entry) const -> bool {
+  if (!bloom_filter_->MayContain(HashFunction<KeyType>().GetHash(key))) {
+    return false;
+  }
+  Page *page = FetchRunPage(FindPage(key));
+  const Entry *entries = Entries(page);
+  const Entry *end = entries + Header(page)->size_;
+  const Entry *it = std::lower_bound(entries, end, key, [this](const Entry &lhs, const KeyType &rhs) {
+    return comparator_(lhs.key_, rhs) < 0;
+  });
+  bool found = it != end && comparator_(it->key_, key) == 0;
+  if (found) {
+    *entry = *it;
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Run::ReadPage(size_t page_index, std::vector<Entry> *entries) const {
+  Page *page = FetchRunPage(page_index);
+  entries->assign(Entries(page), Entries(page) + Header(page)->size_);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Run::FindPage(const KeyType &key) const -> size_t {
+  auto it = std::upper_bound(first_keys_.begin(), first_keys_.end(), key,
+                             [this](const KeyType &lhs, const KeyType &rhs) { return comparator_(lhs, rhs) < 0; });
+  return it == first_keys_.begin() ? 0 : static_cast<size_t>(it - first_keys_.begin()) - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Run::FetchRunPage(size_t page_index) const -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_ids_[page_index]);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a page of a sorted run.");
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * CURSOR
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::Cursor::Cursor(const MemTable *memtable, const KeyType *low)
+    : memtable_(memtable), node_(memtable->LowerBound(low)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::Cursor::Cursor(const Run *run, const KeyType *low, const KeyComparator &comparator) : run_(run) {
+  page_index_ = low != nullptr ? run_->FindPage(*low) : 0;
+  run_->ReadPage(page_index_, &entries_);
+  if (low == nullptr) {
+    return;
+  }
+  while (slot_ < entries_.size() && comparator(entries_[slot_].key_, *low) < 0) {
+    slot_++;
+  }
+  // the key may be past the last entry of its page
+  LoadPage();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Cursor::IsValid() const -> bool {
+  return memtable_ != nullptr ? node_ != nullptr : slot_ < entries_.size();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Cursor::Get() const -> const Entry & {
+  return memtable_ != nullptr ? node_->entry_ : entries_[slot_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Cursor::Next() {
+  if (memtable_ != nullptr) {
+    // skip the older entries of the key
+    const KeyType &key = node_->entry_.key_;
+    const typename MemTable::Node *next = node_->next_[0];
+    while (next != nullptr && memtable_->comparator_(next->entry_.key_, key) == 0) {
+      next = next->next_[0];
+    }
+    node_ = next;
+    return;
+  }
+  slot_++;
+  LoadPage();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Cursor::LoadPage() {
+  if (slot_ == entries_.size() && page_index_ + 1 < run_->GetPageCount()) {
+    page_index_++;
+    run_->ReadPage(page_index_, &entries_);
+    slot_ = 0;
+  }
+}
+
+template class LsmTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class LsmTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class LsmTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class LsmTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class LsmTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
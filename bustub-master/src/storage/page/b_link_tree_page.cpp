@@ -0,0 +1,209 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_link_tree_page.cpp
+//
+// Identification: src/storage/page/b_link_tree_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "common/rid.h"
+#include "storage/page/b_link_tree_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+/*
+ * Init method after creating a new page: empty, with no right sibling and no high key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_LINK_TREE_PAGE_TYPE::Init(page_id_t page_id, int level, int max_size) {
+  page_type_ = level == 0 ? IndexPageType::LEAF_PAGE : IndexPageType::INTERNAL_PAGE;
+  lsn_ = INVALID_LSN;
+  size_ = 0;
+  max_size_ = max_size;
+  level_ = level;
+  page_id_ = page_id;
+  right_page_id_ = INVALID_PAGE_ID;
+  has_high_key_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::GetLevel() const -> int { return level_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::GetSize() const -> int { return size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::GetMaxSize() const -> int { return max_size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::GetPageId() const -> page_id_t { return page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::GetRightPageId() const -> page_id_t { return right_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::KeyAt(int index) const -> KeyType { return array_[index].first; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::IsBeyond(const KeyType &key, const KeyComparator &comparator) const -> bool {
+  return has_high_key_ != 0 && comparator(key, high_key_) >= 0;
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Find the first index i so that array[i].first >= key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  int lo = 0;
+  int hi = size_;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (comparator(array_[mid].first, key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/*
+ * For the given key, check to see whether it exists in the leaf page. If it
+ * does, then store its corresponding value in input "value" and return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == size_ || comparator(array_[index].first, key) != 0) {
+    return false;
+  }
+  *value = array_[index].second;
+  return true;
+}
+
+/*
+ * Find the child of an internal page that covers the key, skipping the invalid first key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::ChildFor(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  int lo = 1;
+  int hi = size_;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (comparator(array_[mid].first, key) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return array_[lo - 1].second;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert the pair behind every smaller or equal key; the invalid first key of an internal page takes no part.
+ * @return page size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> int {
+  int lo = IsLeafPage() ? 0 : std::min(1, size_);
+  int hi = size_;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (comparator(array_[mid].first, key) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  std::move_backward(array_ + lo, array_ + size_, array_ + size_ + 1);
+  array_[lo] = MappingType(key, value);
+  return ++size_;
+}
+
+/*
+ * Populate a new root with the old root and its new right sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_LINK_TREE_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                            const ValueType &new_value) {
+  array_[0].second = old_value;
+  array_[1] = MappingType(new_key, new_value);
+  size_ = 2;
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Move the upper half of the pairs into the empty recipient, which takes over the right link and high key. The
+ * first key moved becomes the high key here, and this page links to the recipient: a search for any moved key now
+ * moves right into it, even before the parent knows about it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_LINK_TREE_PAGE_TYPE::MoveHalfTo(BLinkTreePage *recipient) {
+  int keep = (size_ + 1) / 2;
+  std::copy(array_ + keep, array_ + size_, recipient->array_);
+  recipient->size_ = size_ - keep;
+  recipient->right_page_id_ = right_page_id_;
+  recipient->has_high_key_ = has_high_key_;
+  recipient->high_key_ = high_key_;
+  size_ = keep;
+  right_page_id_ = recipient->page_id_;
+  has_high_key_ = 1;
+  high_key_ = recipient->array_[0].first;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove the key from the leaf page, if it is there.
+ * @return whether the key was removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_LINK_TREE_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comparator) -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == size_ || comparator(array_[index].first, key) != 0) {
+    return false;
+  }
+  std::move(array_ + index + 1, array_ + size_, array_ + index);
+  size_--;
+  return true;
+}
+
+template class BLinkTreePage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTreePage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTreePage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTreePage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTreePage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BLinkTreePage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BLinkTreePage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BLinkTreePage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+template class BLinkTreePage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BLinkTreePage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,13 +9,53 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
 #include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/key_search.h"
 
 namespace bustub {
+
+namespace {
+
+/** Bytes of a key suffix kept in the head of its entry. */
+constexpr int HEAD_SIZE = sizeof(uint64_t);
+
+/** @return the length of the key without its trailing zero bytes */
+template <typename KeyType>
+auto SignificantSize(const KeyType &key) -> int {
+  int size = sizeof(KeyType);
+  while (size > 0 && key.data_[size - 1] == 0) {
+    size--;
+  }
+  return size;
+}
+
+/** @return the 8 bytes of the key from offset as a big-endian integer, zero-padded past the end of the key */
+template <typename KeyType>
+auto HeadAt(const KeyType &key, int offset) -> uint64_t {
+  uint64_t head = 0;
+  for (int i = offset; i < offset + HEAD_SIZE; i++) {
+    head = (head << 8) | (i < static_cast<int>(sizeof(KeyType)) ? static_cast<uint8_t>(key.data_[i]) : 0);
+  }
+  return head;
+}
+
+/** Compare two key tails without their trailing zero bytes, like the zero-padded keys they end. */
+auto CompareTails(const char *lhs, int lhs_length, const char *rhs, int rhs_length) -> int {
+  int cmp = memcmp(lhs, rhs, std::min(lhs_length, rhs_length));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return lhs_length - rhs_length;
+}
+
+}  // namespace
+
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
@@ -25,34 +65,219 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size,
+                                          bool compress_prefix) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetMaxSize(max_size);
+  SetLSN();
+  prefix_size_ = 0;
+  fences_ = 0;
+  compress_prefix_ = static_cast<uint8_t>(compress_prefix);
+  memset(low_fence_.data_, 0, sizeof(KeyType));
+  memset(high_fence_.data_, 0, sizeof(KeyType));
+}
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
- * array offset)
+ * array offset). The first key is the low fence.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
   KeyType key{};
+  if (index == 0) {
+    return (fences_ & LOW_FENCE) != 0 ? low_fence_ : key;
+  }
+  memcpy(key.data_, low_fence_.data_, prefix_size_);
+  uint64_t head = Heads()[index];
+  for (int i = 0; i < HEAD_SIZE && prefix_size_ + i < static_cast<int>(sizeof(KeyType)); i++) {
+    key.data_[prefix_size_ + i] = static_cast<char>(head >> (8 * (HEAD_SIZE - 1 - i)));
+  }
+  int length;
+  const char *tail = TailOf(index, &length);
+  if (length > 0) {
+    memcpy(key.data_ + prefix_size_ + HEAD_SIZE, tail, length);
+  }
   return key;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (index == 0) {
+    SetLowFence(key);
+    return;
+  }
+  auto entries = Entries();
+  entries[index].first = key;
+  Rebuild(entries);
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  const ValueType *children = Children();
+  for (int i = 0; i < GetSize(); i++) {
+    if (children[i] == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return Children()[index]; }
+
+/*
+ * Helper methods to set the fences, the separators around this page in its parent
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetLowFence(const KeyType &key) {
+  auto entries = Entries();
+  fences_ |= LOW_FENCE;
+  low_fence_ = key;
+  Rebuild(entries);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighFence(const KeyType &key) {
+  auto entries = Entries();
+  fences_ |= HIGH_FENCE;
+  high_fence_ = key;
+  Rebuild(entries);
+}
+
+/*
+ * Helper methods to locate the entry arrays, which start at the first 8-aligned offset behind the header (the page
+ * data itself is 8-aligned) and are laid out for the current size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Heads() const -> const uint64_t * {
+  auto start = reinterpret_cast<uintptr_t>(entries_);
+  return reinterpret_cast<const uint64_t *>((start + alignof(uint64_t) - 1) & ~(alignof(uint64_t) - 1));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Children() const -> const ValueType * {
+  return reinterpret_cast<const ValueType *>(Heads() + GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::TailEnds() const -> const uint16_t * {
+  return reinterpret_cast<const uint16_t *>(Children() + GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Tails() const -> const char * {
+  return reinterpret_cast<const char *>(TailEnds() + GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::TailOf(int index, int *length) const -> const char * {
+  int begin = index == 0 ? 0 : TailEnds()[index - 1];
+  *length = TailEnds()[index] - begin;
+  return Tails() + begin;
+}
+
+/*
+ * Helper methods to measure the page: the space in use, the most that a page that is not full may use, and the
+ * largest entry, which a page that is not full always has room for
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetUsedSpace() const -> size_t {
+  size_t tails = GetSize() == 0 ? 0 : TailEnds()[GetSize() - 1];
+  return (Tails() - reinterpret_cast<const char *>(this)) + tails;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetSpaceLimit() -> size_t { return PAGE_SIZE - GetMaxEntrySize(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetMaxEntrySize() -> size_t {
+  return sizeof(uint64_t) + sizeof(ValueType) + sizeof(uint16_t) +
+         (sizeof(KeyType) > HEAD_SIZE ? sizeof(KeyType) - HEAD_SIZE : 0);
+}
+
+/*
+ * Helper method to compute the length of the prefix shared by every key between the fences, if the page leaves it
+ * out. A page at the left or right edge of the tree shares none.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetPrefixSize(uint8_t fences, const KeyType &low, const KeyType &high) const
+    -> int {
+  if (compress_prefix_ == 0 || fences != (LOW_FENCE | HIGH_FENCE)) {
+    return 0;
+  }
+  int size = 0;
+  while (size < static_cast<int>(sizeof(KeyType)) && low.data_[size] == high.data_[size]) {
+    size++;
+  }
+  return size;
+}
+
+/*
+ * Helper method to compute the space the page would use for the entries with the given prefix left out
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::EncodedSize(const std::vector<MappingType> &entries, int prefix_size) const
+    -> size_t {
+  size_t size = reinterpret_cast<const char *>(Heads()) - reinterpret_cast<const char *>(this);
+  size += entries.size() * (sizeof(uint64_t) + sizeof(ValueType) + sizeof(uint16_t));
+  for (size_t i = 1; i < entries.size(); i++) {
+    size += std::max(SignificantSize(entries[i].first) - prefix_size - HEAD_SIZE, 0);
+  }
+  return size;
+}
+
+/*
+ * Helper method to decode every entry; the first key is the low fence
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Entries() const -> std::vector<MappingType> {
+  std::vector<MappingType> entries;
+  entries.reserve(GetSize() + 1);
+  for (int i = 0; i < GetSize(); i++) {
+    entries.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return entries;
+}
+
+/*
+ * Helper method to rewrite the page with the given entries under the current fences
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Rebuild(const std::vector<MappingType> &entries) {
+  prefix_size_ = GetPrefixSize(fences_, low_fence_, high_fence_);
+  BUSTUB_ASSERT(EncodedSize(entries, prefix_size_) <= PAGE_SIZE, "Internal page overflow.");
+  SetSize(entries.size());
+  auto *heads = const_cast<uint64_t *>(Heads());
+  auto *children = const_cast<ValueType *>(Children());
+  auto *tail_ends = const_cast<uint16_t *>(TailEnds());
+  auto *tails = const_cast<char *>(Tails());
+  uint16_t end = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    const KeyType &key = entries[i].first;
+    children[i] = entries[i].second;
+    heads[i] = 0;
+    if (i > 0) {
+      BUSTUB_ASSERT(memcmp(key.data_, low_fence_.data_, prefix_size_) == 0, "Key outside of the fences.");
+      heads[i] = HeadAt(key, prefix_size_);
+      int length = SignificantSize(key) - prefix_size_ - HEAD_SIZE;
+      if (length > 0) {
+        memcpy(tails + end, key.data_ + prefix_size_ + HEAD_SIZE, length);
+        end += length;
+      }
+    }
+    tail_ends[i] = end;
+  }
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -64,7 +289,44 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { ret
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
-  return INVALID_PAGE_ID;
+  // Find the last key that is <= the search key; the invalid first key acts as minus infinity.
+  const ValueType *children = Children();
+  int lo = 1;
+  int hi = GetSize();
+  if (!comparator.IsNormalized()) {
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (comparator(KeyAt(mid), key) <= 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return children[lo - 1];
+  }
+
+  // A key without the common prefix lies before or after all others; the rest compare by head, then by tail.
+  int cmp = memcmp(key.data_, low_fence_.data_, prefix_size_);
+  if (cmp != 0) {
+    return cmp < 0 ? children[0] : children[GetSize() - 1];
+  }
+  uint64_t head = HeadAt(key, prefix_size_);
+  hi = lo + KeySearch::UpperBound(Heads() + lo, hi - lo, head);
+  lo += KeySearch::LowerBound(Heads() + lo, hi - lo, head);
+  int offset = prefix_size_ + HEAD_SIZE;
+  int length = std::max(SignificantSize(key) - offset, 0);
+  const char *key_tail = length > 0 ? key.data_ + offset : nullptr;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    int tail_length;
+    const char *tail = TailOf(mid, &tail_length);
+    if (CompareTails(tail, tail_length, key_tail, length) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return children[lo - 1];
 }
 
 /*****************************************************************************
@@ -78,7 +340,9 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCompara
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value) {
+  Rebuild({MappingType(KeyType{}, old_value), MappingType(new_key, new_value)});
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -87,25 +351,37 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) -> int {
-  return 0;
+  auto entries = Entries();
+  entries.insert(entries.begin() + ValueIndex(old_value) + 1, MappingType(new_key, new_value));
+  Rebuild(entries);
+  return GetSize();
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page. The first key moved becomes the fence between
+ * the two.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
-
-/* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
- */
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+                                                BufferPoolManager *buffer_pool_manager) {
+  auto entries = Entries();
+  int keep = (GetSize() + 1) / 2;
+  std::vector<MappingType> moved(entries.begin() + keep, entries.end());
+  entries.resize(keep);
+  recipient->fences_ = LOW_FENCE | (fences_ & HIGH_FENCE);
+  recipient->low_fence_ = moved[0].first;
+  recipient->high_fence_ = high_fence_;
+  recipient->Rebuild(moved);
+  for (const auto &entry : moved) {
+    recipient->Adopt(entry.second, buffer_pool_manager);
+  }
+  fences_ |= HIGH_FENCE;
+  high_fence_ = moved[0].first;
+  Rebuild(entries);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +392,110 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  auto entries = Entries();
+  entries.erase(entries.begin() + index);
+  Rebuild(entries);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  ValueType child = ValueAt(0);
+  SetSize(0);
+  return child;
+}
+
+/*****************************************************************************
+ * FULLNESS
+ *****************************************************************************/
+/*
+ * A page overflows, and has to split, once it has more entries than its max size or uses more space than leaves
+ * room for the largest entry
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsOverflow() const -> bool {
+  return GetSize() > GetMaxSize() || GetUsedSpace() > GetSpaceLimit();
+}
+
+/*
+ * A page underflows, and has to merge or borrow, once it has fewer entries than its min size and uses less than
+ * half of its space
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const -> bool {
+  return GetSize() < GetMinSize() && 2 * GetUsedSpace() < GetSpaceLimit();
+}
+
+/*
+ * Whether any one more entry keeps the page within fill_factor percent of its space, and not over its max size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsert(int fill_factor) const -> bool {
+  return GetSize() < GetMaxSize() && GetUsedSpace() + GetMaxEntrySize() <= GetSpaceLimit() * fill_factor / 100;
+}
+
+/*
+ * Whether removing any one entry keeps the page from underflowing
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanRemove() const -> bool {
+  return GetSize() > GetMinSize() || 2 * GetUsedSpace() >= GetSpaceLimit() + 2 * GetMaxEntrySize();
+}
+
+/*
+ * Whether the key at index can be replaced, e.g. by a longer separator, without the page overflowing
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const -> bool {
+  auto entries = Entries();
+  entries[index].first = key;
+  return EncodedSize(entries, prefix_size_) <= GetSpaceLimit();
+}
+
+/*
+ * Whether MoveAllTo() from the right sibling fits into this page. The merged page spans both fences, so it may share
+ * a shorter prefix.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMerge(const BPlusTreeInternalPage *right, const KeyType &middle_key) const
+    -> bool {
+  if (GetSize() + right->GetSize() > GetMaxSize()) {
+    return false;
+  }
+  auto entries = Entries();
+  auto moved = right->Entries();
+  moved[0].first = middle_key;
+  entries.insert(entries.end(), moved.begin(), moved.end());
+  uint8_t fences = (fences_ & LOW_FENCE) | (right->fences_ & HIGH_FENCE);
+  return EncodedSize(entries, GetPrefixSize(fences, low_fence_, right->high_fence_)) <= GetSpaceLimit();
+}
+
+/*
+ * Whether this page can take the nearest entry of its sibling, which keeps at least two children
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanBorrow(const BPlusTreeInternalPage *sibling, const KeyType &middle_key,
+                                               bool from_right) const -> bool {
+  if (sibling->GetSize() <= 2 || GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  auto entries = Entries();
+  auto borrowed = sibling->Entries();
+  if (from_right) {
+    entries.emplace_back(middle_key, borrowed[0].second);
+    uint8_t fences = (fences_ & LOW_FENCE) | HIGH_FENCE;
+    return EncodedSize(entries, GetPrefixSize(fences, low_fence_, borrowed[1].first)) <= GetSpaceLimit();
+  }
+  entries[0].first = middle_key;
+  entries.insert(entries.begin(), borrowed.back());
+  uint8_t fences = LOW_FENCE | (fences_ & HIGH_FENCE);
+  return EncodedSize(entries, GetPrefixSize(fences, borrowed.back().first, high_fence_)) <= GetSpaceLimit();
+}
+
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -136,7 +508,19 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType { r
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+                                               BufferPoolManager *buffer_pool_manager) {
+  auto entries = recipient->Entries();
+  auto moved = Entries();
+  moved[0].first = middle_key;
+  entries.insert(entries.end(), moved.begin(), moved.end());
+  recipient->fences_ = (recipient->fences_ & LOW_FENCE) | (fences_ & HIGH_FENCE);
+  recipient->high_fence_ = high_fence_;
+  recipient->Rebuild(entries);
+  for (const auto &entry : moved) {
+    recipient->Adopt(entry.second, buffer_pool_manager);
+  }
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -151,14 +535,33 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
+                                                      BufferPoolManager *buffer_pool_manager) {
+  auto entries = Entries();
+  auto received = recipient->Entries();
+  received.emplace_back(middle_key, entries[0].second);
+  KeyType separator = entries[1].first;
+  entries.erase(entries.begin());
+  recipient->fences_ |= HIGH_FENCE;
+  recipient->high_fence_ = separator;
+  recipient->Rebuild(received);
+  recipient->Adopt(received.back().second, buffer_pool_manager);
+  fences_ |= LOW_FENCE;
+  low_fence_ = separator;
+  Rebuild(entries);
+}
 
 /* Append an entry at the end.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::AppendChild(const KeyType &key, const ValueType &child,
+                                                 BufferPoolManager *buffer_pool_manager) {
+  auto entries = Entries();
+  entries.emplace_back(key, child);
+  Rebuild(entries);
+  Adopt(child, buffer_pool_manager);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
@@ -169,14 +572,34 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+                                                       BufferPoolManager *buffer_pool_manager) {
+  auto entries = Entries();
+  MappingType last = entries.back();
+  entries.pop_back();
+  auto received = recipient->Entries();
+  received[0].first = middle_key;
+  received.insert(received.begin(), last);
+  recipient->fences_ |= LOW_FENCE;
+  recipient->low_fence_ = last.first;
+  recipient->Rebuild(received);
+  recipient->Adopt(last.second, buffer_pool_manager);
+  fences_ |= HIGH_FENCE;
+  high_fence_ = last.first;
+  Rebuild(entries);
+}
 
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
+/*
+ * Point the parent page id of the child page at me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager) {
+  auto *page = buffer_pool_manager->FetchPage(child);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a child page to adopt.");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child, true);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -10,6 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "storage/page/hash_table_bucket_page.h"
 #include "common/logger.h"
 #include "common/util/hash_util.h"
@@ -19,63 +27,165 @@
 
 namespace bustub {
 
+/*
+ * Slots are taken from the front and never become unoccupied again, so a scan stops at the first group that starts
+ * with an unoccupied slot.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result, uint8_t tag)
+    -> bool {
+  bool found = false;
+  for (uint32_t group_idx = 0; group_idx < BUCKET_ARRAY_SIZE && IsOccupied(group_idx);
+       group_idx += BUCKET_TAG_GROUP) {
+    for (uint32_t matches = MatchTag(group_idx, tag); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_idx + __builtin_ctz(matches);
+      if (cmp(array_[bucket_idx].first, key) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::PrefetchMetadata() const {
+  const char *start = reinterpret_cast<const char *>(this);
+  for (size_t offset = 0; offset < offsetof(HashTableBucketPage, array_); offset += 64) {
+    __builtin_prefetch(start + offset);
+  }
 }
 
+/*
+ * The pair goes into the first slot that does not hold a pair, reusing the slots of removed pairs.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t tag) -> bool {
+  static_assert(offsetof(HashTableBucketPage, array_) + BUCKET_ARRAY_SIZE * sizeof(MappingType) <= PAGE_SIZE,
+                "The bucket does not fit into a page.");
+  for (uint32_t group_idx = 0; group_idx < BUCKET_ARRAY_SIZE && IsOccupied(group_idx);
+       group_idx += BUCKET_TAG_GROUP) {
+    for (uint32_t matches = MatchTag(group_idx, tag); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_idx + __builtin_ctz(matches);
+      if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+        return false;
+      }
+    }
+  }
+  uint32_t free_idx = FirstFreeSlot();
+  if (free_idx == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  tags_[free_idx] = tag;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t tag) -> bool {
+  for (uint32_t group_idx = 0; group_idx < BUCKET_ARRAY_SIZE && IsOccupied(group_idx);
+       group_idx += BUCKET_TAG_GROUP) {
+    for (uint32_t matches = MatchTag(group_idx, tag); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_idx + __builtin_ctz(matches);
+      if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::MatchTag(uint32_t group_idx, uint8_t tag) const -> uint32_t {
+  static_assert(BUCKET_TAG_GROUP == 16, "A group of tags is one SSE2 register.");
+#ifdef __SSE2__
+  __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags_ + group_idx));
+  auto matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < BUCKET_TAG_GROUP; i++) {
+    matches |= static_cast<uint32_t>(tags_[group_idx + i] == tag) << i;
+  }
+#endif
+  // the group's readable flags are two bytes of readable_; bits past the last slot are never set
+  uint32_t readable = static_cast<unsigned char>(readable_[group_idx / 8]);
+  if (group_idx / 8 + 1 < sizeof(readable_)) {
+    readable |= static_cast<uint32_t>(static_cast<unsigned char>(readable_[group_idx / 8 + 1])) << 8;
+  }
+  return matches & readable;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::FirstFreeSlot() const -> uint32_t {
+  for (uint32_t i = 0; i < sizeof(readable_); i++) {
+    auto flags = static_cast<unsigned char>(readable_[i]);
+    if (flags != 0xFF) {
+      return std::min<uint32_t>(i * 8 + __builtin_ctz(~flags), BUCKET_ARRAY_SIZE);
+    }
+  }
+  return BUCKET_ARRAY_SIZE;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+auto HASH_TABLE_BUCKET_TYPE::TagAt(uint32_t bucket_idx) const -> uint8_t {
+  return tags_[bucket_idx];
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1U << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1U << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1U << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1U << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1U << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  uint32_t count = 0;
+  for (char byte : readable_) {
+    count += __builtin_popcount(static_cast<unsigned char>(byte));
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  return std::all_of(std::begin(readable_), std::end(readable_), [](char byte) { return byte == 0; });
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/page/key_search.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <initializer_list>
+
+#include "storage/page/key_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BUSTUB_KEY_SEARCH_X86
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Below this many prefixes, the SIMD kernels compare the whole range rather than halving it further. */
+constexpr int SCAN_WIDTH = 32;
+
+/** Count the prefixes of [begin, end) that are < target, or <= target if inclusive is set. */
+using CountKernel = int (*)(const uint64_t *begin, const uint64_t *end, uint64_t target, bool inclusive);
+
+auto CountScalar(const uint64_t *begin, const uint64_t *end, uint64_t target, bool inclusive) -> int {
+  int count = 0;
+  for (const uint64_t *p = begin; p < end; p++) {
+    count += static_cast<int>(*p < target || (inclusive && *p == target));
+  }
+  return count;
+}
+
+#ifdef BUSTUB_KEY_SEARCH_X86
+// There are only signed 64-bit comparisons; flipping the sign bits of both sides makes them unsigned.
+constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+__attribute__((target("sse4.2"))) auto CountSse42(const uint64_t *begin, const uint64_t *end, uint64_t target,
+                                                  bool inclusive) -> int {
+  // x < t counts as t > x; x <= t counts as t + 1 > x, unless t is the largest prefix.
+  if (inclusive && target == ~uint64_t{0}) {
+    return static_cast<int>(end - begin);
+  }
+  __m128i flip = _mm_set1_epi64x(static_cast<int64_t>(SIGN_BIT));
+  __m128i bound = _mm_set1_epi64x(static_cast<int64_t>((target + (inclusive ? 1 : 0)) ^ SIGN_BIT));
+  int count = 0;
+  const uint64_t *p = begin;
+  for (; p + 2 <= end; p += 2) {
+    __m128i prefixes = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), flip);
+    count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(bound, prefixes))));
+  }
+  return count + CountScalar(p, end, target, inclusive);
+}
+
+__attribute__((target("avx2"))) auto CountAvx2(const uint64_t *begin, const uint64_t *end, uint64_t target,
+                                               bool inclusive) -> int {
+  if (inclusive && target == ~uint64_t{0}) {
+    return static_cast<int>(end - begin);
+  }
+  __m256i flip = _mm256_set1_epi64x(static_cast<int64_t>(SIGN_BIT));
+  __m256i bound = _mm256_set1_epi64x(static_cast<int64_t>((target + (inclusive ? 1 : 0)) ^ SIGN_BIT));
+  int count = 0;
+  const uint64_t *p = begin;
+  for (; p + 4 <= end; p += 4) {
+    __m256i prefixes = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), flip);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(bound, prefixes))));
+  }
+  return count + CountScalar(p, end, target, inclusive);
+}
+#endif
+
+auto Supported(KeySearchKernel kernel) -> bool {
+#ifdef BUSTUB_KEY_SEARCH_X86
+  // The kernel is picked during static initialization, which may run before the CPU model is.
+  __builtin_cpu_init();
+#endif
+  switch (kernel) {
+    case KeySearchKernel::SCALAR:
+      return true;
+#ifdef BUSTUB_KEY_SEARCH_X86
+    case KeySearchKernel::SSE42:
+      return __builtin_cpu_supports("sse4.2");
+    case KeySearchKernel::AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+auto KernelFor(KeySearchKernel kernel) -> CountKernel {
+  switch (kernel) {
+#ifdef BUSTUB_KEY_SEARCH_X86
+    case KeySearchKernel::SSE42:
+      return CountSse42;
+    case KeySearchKernel::AVX2:
+      return CountAvx2;
+#endif
+    default:
+      return CountScalar;
+  }
+}
+
+auto BestKernel() -> KeySearchKernel {
+  for (auto kernel : {KeySearchKernel::AVX2, KeySearchKernel::SSE42}) {
+    if (Supported(kernel)) {
+      return kernel;
+    }
+  }
+  return KeySearchKernel::SCALAR;
+}
+
+/** Read once by every search, so that SetKernel() may switch kernels while searches run. */
+std::atomic<KeySearchKernel> kernel_in_use{BestKernel()};
+
+/** Index of the first prefix >= target (> target if inclusive is set). */
+auto Search(const uint64_t *prefixes, int size, uint64_t target, bool inclusive) -> int {
+  int lo = 0;
+  int hi = size;
+  const KeySearchKernel kernel = kernel_in_use.load(std::memory_order_relaxed);
+  if (kernel == KeySearchKernel::SCALAR) {
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (prefixes[mid] < target || (inclusive && prefixes[mid] == target)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+  while (hi - lo > SCAN_WIDTH) {
+    int mid = lo + (hi - lo) / 2;
+    if (prefixes[mid] < target || (inclusive && prefixes[mid] == target)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo + KernelFor(kernel)(prefixes + lo, prefixes + hi, target, inclusive);
+}
+
+}  // namespace
+
+auto KeySearch::LowerBound(const uint64_t *prefixes, int size, uint64_t target) -> int {
+  return Search(prefixes, size, target, false);
+}
+
+auto KeySearch::UpperBound(const uint64_t *prefixes, int size, uint64_t target) -> int {
+  return Search(prefixes, size, target, true);
+}
+
+auto KeySearch::GetKernel() -> KeySearchKernel { return kernel_in_use.load(std::memory_order_relaxed); }
+
+auto KeySearch::IsSupported(KeySearchKernel kernel) -> bool { return Supported(kernel); }
+
+auto KeySearch::SetKernel(KeySearchKernel kernel) -> bool {
+  if (!Supported(kernel)) {
+    return false;
+  }
+  kernel_in_use.store(kernel, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace bustub
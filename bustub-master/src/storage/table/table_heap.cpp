@@ -11,22 +11,53 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <thread>  // NOLINT
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
+namespace {
+
+/** Holds a table's writers latch in read mode for the duration of a single write. */
+class WriteGuard {
+ public:
+  explicit WriteGuard(ReaderWriterLatch *latch) : latch_(latch) { latch_->RLock(); }
+  ~WriteGuard() { latch_->RUnlock(); }
+  DISALLOW_COPY_AND_MOVE(WriteGuard);
+
+ private:
+  ReaderWriterLatch *latch_;
+};
+
+}  // namespace
+
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      page_id_t first_page_id)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  // Walk the chain once so that the page directory is complete for an existing table.
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids_.push_back(page_id);
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager) {
   // Initialize the first table page.
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
@@ -34,14 +65,25 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  page_ids_.push_back(first_page_id_);
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  WriteGuard guard(&writers_latch_);
+  if (retired_ || tuple.size_ + 32 > PAGE_SIZE) {  // retired, or larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
+  if (insert_mode_ == InsertMode::Append) {
+    if (!AppendTuple(tuple, rid, txn)) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    RecordInsert(*rid, txn);
+    return true;
+  }
+
   auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -76,6 +118,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
       new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      AppendPageId(next_page_id);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
       cur_page = new_page;
@@ -85,15 +128,126 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
   // We are not, in fact, double unlatching. See the invariant above.
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  RecordInsert(*rid, txn);
   return true;
 }
 
+void TableHeap::RecordInsert(const RID &rid, Transaction *txn) {
+  insert_count_++;
+  CaptureChange(rid);
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
+}
+
+void TableHeap::SetInsertMode(InsertMode mode, uint32_t extent_pages, uint32_t fill_factor) {
+  BUSTUB_ASSERT(extent_pages > 0, "An extent needs at least one page.");
+  BUSTUB_ASSERT(fill_factor > 0 && fill_factor <= 100, "The fill factor is a percentage.");
+  extent_pages_ = extent_pages;
+  fill_factor_ = fill_factor;
+  insert_mode_ = mode;
+}
+
+auto TableHeap::AppendTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  const auto thread_id = std::this_thread::get_id();
+  page_id_t tail;
+  {
+    std::lock_guard<std::mutex> guard(extent_latch_);
+    auto it = tail_pages_.find(thread_id);
+    tail = it == tail_pages_.end() ? INVALID_PAGE_ID : it->second;
+  }
+  const uint32_t reserved = PAGE_SIZE * (100 - fill_factor_) / 100;
+  while (true) {
+    // A fresh page takes any tuple that fits, so that a low fill factor cannot make a tuple uninsertable.
+    bool fresh = false;
+    if (tail == INVALID_PAGE_ID) {
+      tail = TakeExtentPage(txn, thread_id);
+      if (tail == INVALID_PAGE_ID) {
+        return false;
+      }
+      fresh = true;
+    }
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(tail));
+    if (page == nullptr) {
+      return false;
+    }
+    page->WLatch();
+    bool inserted = (fresh || page->HasRoomFor(tuple, reserved)) &&
+                    page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(tail, inserted);
+    if (inserted) {
+      return true;
+    }
+    // The tail is full. Its remaining space is left to free-space-first inserts and to updates.
+    tail = INVALID_PAGE_ID;
+  }
+}
+
+auto TableHeap::TakeExtentPage(Transaction *txn, std::thread::id thread_id) -> page_id_t {
+  std::lock_guard<std::mutex> guard(extent_latch_);
+  tail_pages_.erase(thread_id);
+  if (free_extent_pages_.empty()) {
+    // Link a whole extent in one go, so the pages are allocated next to each other and the chain end is contended
+    // once per extent rather than once per page.
+    for (uint32_t i = 0; i < extent_pages_; i++) {
+      auto page_id = LinkNewPage(txn);
+      if (page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      free_extent_pages_.push_back(page_id);
+    }
+    if (free_extent_pages_.empty()) {
+      return INVALID_PAGE_ID;
+    }
+  }
+  auto page_id = free_extent_pages_.front();
+  free_extent_pages_.pop_front();
+  tail_pages_[thread_id] = page_id;
+  return page_id;
+}
+
+auto TableHeap::LinkNewPage(Transaction *txn) -> page_id_t {
+  while (true) {
+    page_id_t last_page_id;
+    {
+      std::lock_guard<std::mutex> guard(page_ids_latch_);
+      last_page_id = page_ids_.back();
+    }
+    auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+    if (last_page == nullptr) {
+      return INVALID_PAGE_ID;
+    }
+    last_page->WLatch();
+    // A free-space-first insert may have extended the chain since; it records the page before unlatching.
+    if (last_page->GetNextPageId() != INVALID_PAGE_ID) {
+      last_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(last_page_id, false);
+      continue;
+    }
+    page_id_t new_page_id;
+    auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id));
+    if (new_page == nullptr) {
+      last_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(last_page_id, false);
+      return INVALID_PAGE_ID;
+    }
+    new_page->WLatch();
+    new_page->Init(new_page_id, PAGE_SIZE, last_page_id, log_manager_, txn);
+    last_page->SetNextPageId(new_page_id);
+    AppendPageId(new_page_id);
+    new_page->WUnlatch();
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    return new_page_id;
+  }
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
+  WriteGuard guard(&writers_latch_);
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = retired_ ? nullptr : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -101,17 +255,22 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  bool is_marked = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  // Update the transaction's write set; only a delete that was marked has anything to roll back or apply.
+  if (is_marked) {
+    delete_count_++;
+    CaptureChange(rid);
+    txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  }
   return true;
 }
 
 auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool {
+  WriteGuard guard(&writers_latch_);
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = retired_ ? nullptr : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -123,6 +282,9 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (is_updated) {
+    CaptureChange(rid);
+  }
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -131,6 +293,7 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
+  WriteGuard guard(&writers_latch_);
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
@@ -140,9 +303,11 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  CaptureChange(rid);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
+  WriteGuard guard(&writers_latch_);
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
@@ -150,7 +315,9 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   page->WLatch();
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
+  delete_count_--;
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  CaptureChange(rid);
 }
 
 auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
@@ -169,6 +336,51 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool
   return res;
 }
 
+auto TableHeap::GetPageIds() -> std::vector<page_id_t> {
+  std::lock_guard<std::mutex> guard(page_ids_latch_);
+  return page_ids_;
+}
+
+void TableHeap::AppendPageId(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(page_ids_latch_);
+  page_ids_.push_back(page_id);
+}
+
+void TableHeap::StartChangeCapture() {
+  std::lock_guard<std::mutex> guard(capture_latch_);
+  captured_rids_.clear();
+  capturing_ = true;
+}
+
+auto TableHeap::DrainCapturedChanges() -> std::vector<RID> {
+  std::lock_guard<std::mutex> guard(capture_latch_);
+  std::vector<RID> changes;
+  changes.swap(captured_rids_);
+  return changes;
+}
+
+void TableHeap::StopChangeCapture() {
+  std::lock_guard<std::mutex> guard(capture_latch_);
+  capturing_ = false;
+  captured_rids_.clear();
+}
+
+void TableHeap::CaptureChange(const RID &rid) {
+  if (!capturing_) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(capture_latch_);
+  if (capturing_) {
+    captured_rids_.push_back(rid);
+  }
+}
+
+void TableHeap::BlockWriters() { writers_latch_.WLock(); }
+
+void TableHeap::UnblockWriters() { writers_latch_.WUnlock(); }
+
+void TableHeap::Retire() { retired_ = true; }
+
 auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
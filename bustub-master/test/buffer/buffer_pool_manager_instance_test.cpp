@@ -11,9 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -141,4 +143,68 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Write twice as many pages as fit, so that the first half gets evicted.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(false, bpm->FlushPage(0));
+
+  // Scenario: A prefetched page shows up in the buffer pool by itself, unpinned.
+  bpm->PrefetchPage(0);
+  bool loaded = false;
+  for (int i = 0; i < 1000 && !loaded; ++i) {
+    loaded = bpm->FlushPage(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(true, loaded);
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(false, bpm->UnpinPage(0, false));
+
+  // Scenario: Fetching pages while they are prefetched, possibly still being read in, returns their contents.
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < static_cast<int>(buffer_pool_size) * 2; ++i) {
+      for (int ahead = 1; ahead <= 3; ++ahead) {
+        bpm->PrefetchPage((i + ahead) % (buffer_pool_size * 2));
+      }
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+  }
+
+  // Scenario: With every frame pinned, a prefetch finds no frame and is dropped.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->FetchPage(i));
+  }
+  bpm->PrefetchPage(buffer_pool_size);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(false, bpm->FlushPage(buffer_pool_size));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partition_test.cpp
+//
+// Identification: test/catalog/partition_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "execution/executor_context.h"
+#include "execution/executors/partition_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using KeyType = GenericKey<8>;
+
+class PartitionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManager>("partition_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(32, disk_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), nullptr, nullptr);
+  }
+
+  void TearDown() override {
+    remove("partition_test.db");
+    remove("partition_test.log");
+  }
+
+  auto MakeTuple(int32_t ts) -> Tuple {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(ts), ValueFactory::GetIntegerValue(ts * 2)};
+    return Tuple(values, &schema_);
+  }
+
+  /** Insert a row through the partition router. @return the child table it went to */
+  auto Insert(PartitionedTableInfo *meta, int32_t ts) -> TableInfo * {
+    auto tuple = MakeTuple(ts);
+    auto *child = meta->Route(tuple);
+    RID rid;
+    if (child != nullptr) {
+      EXPECT_TRUE(child->table_->InsertTuple(tuple, &rid, &txn_));
+    }
+    return child;
+  }
+
+  auto CountRows(TableInfo *table) -> size_t {
+    size_t rows = 0;
+    for (auto tuple = table->table_->Begin(&txn_); tuple != table->table_->End(); ++tuple) {
+      rows++;
+    }
+    return rows;
+  }
+
+  std::vector<Column> columns_{{"ts", TypeId::INTEGER}, {"v", TypeId::INTEGER}};
+  Schema schema_{columns_};
+  std::vector<Column> key_columns_{{"ts", TypeId::INTEGER}};
+  Schema key_schema_{key_columns_};
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+  std::unique_ptr<Catalog> catalog_;
+  Transaction txn_{0};
+};
+
+TEST_F(PartitionTest, RangePartitionTest) {
+  std::vector<Value> bounds{ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(100),
+                            ValueFactory::GetIntegerValue(200), ValueFactory::GetIntegerValue(300)};
+  auto *meta = catalog_->CreateRangePartitionedTable(&txn_, "events", schema_, 0, bounds);
+  ASSERT_NE(nullptr, meta);
+  ASSERT_EQ(3, meta->partitions_.size());
+  EXPECT_EQ(nullptr, catalog_->CreateRangePartitionedTable(&txn_, "events", schema_, 0, bounds));
+  EXPECT_EQ(nullptr, catalog_->CreateHashPartitionedTable(&txn_, "events", schema_, 0, 4));
+
+  for (int32_t ts = 0; ts < 300; ts++) {
+    EXPECT_EQ(meta->partitions_[ts / 100].table_, Insert(meta, ts));
+  }
+  EXPECT_EQ(nullptr, Insert(meta, -1));
+  EXPECT_EQ(nullptr, Insert(meta, 300));
+
+  // Pruning keeps only the partitions overlapping the requested key range.
+  auto k50 = ValueFactory::GetIntegerValue(50);
+  auto k100 = ValueFactory::GetIntegerValue(100);
+  auto k150 = ValueFactory::GetIntegerValue(150);
+  EXPECT_EQ(3, catalog_->GetPartitions("events").size());
+  EXPECT_EQ(std::vector<TableInfo *>{meta->partitions_[1].table_}, catalog_->GetPartitions("events", &k150, &k150));
+  EXPECT_EQ(std::vector<TableInfo *>{meta->partitions_[1].table_}, catalog_->GetPartitions("events", &k100, &k100));
+  EXPECT_EQ(2, catalog_->GetPartitions("events", &k50, &k100).size());
+  EXPECT_EQ(2, catalog_->GetPartitions("events", &k150).size());
+  EXPECT_EQ(1, catalog_->GetPartitions("events", nullptr, &k50).size());
+
+  // Indexes are created on every partition, including partitions added later.
+  auto indexes = catalog_->CreatePartitionedIndex<KeyType, RID, GenericComparator<8>>(
+      &txn_, "events_ts", "events", key_schema_, {0}, 8, HashFunction<KeyType>{});
+  EXPECT_EQ(3, indexes.size());
+  EXPECT_EQ(nullptr, catalog_->AddRangePartition(&txn_, "events", k150));
+  auto *added = catalog_->AddRangePartition(&txn_, "events", ValueFactory::GetIntegerValue(400));
+  ASSERT_NE(nullptr, added);
+  EXPECT_EQ(added, Insert(meta, 350));
+  EXPECT_NE(Catalog::NULL_INDEX_INFO, catalog_->GetIndex("events_ts", added->name_));
+  EXPECT_EQ(4, catalog_->GetPartitionIndexes("events_ts", "events").size());
+  EXPECT_EQ(1, catalog_->GetPartitionIndexes("events_ts", "events", &k150, &k150).size());
+
+  // Dropping the oldest partition unlinks it with its index; the others keep their rows.
+  auto *oldest = meta->partitions_[0].table_;
+  auto oldest_name = oldest->name_;
+  page_id_t oldest_page_id = oldest->table_->GetFirstPageId();
+  ASSERT_TRUE(catalog_->DropPartition("events", 0));
+  EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog_->GetTable(oldest_name));
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog_->GetIndex("events_ts", oldest_name));
+  EXPECT_EQ(nullptr, Insert(meta, 50));
+  EXPECT_EQ(3, catalog_->GetPartitionIndexes("events_ts", "events").size());
+  size_t rows = 0;
+  for (auto *child : catalog_->GetPartitions("events")) {
+    rows += CountRows(child);
+  }
+  EXPECT_EQ(201, rows);
+
+  // Its pages are freed later; one that a reader still pins waits for the next attempt.
+  ASSERT_NE(nullptr, bpm_->FetchPage(oldest_page_id));
+  EXPECT_EQ(1, catalog_->ReclaimDroppedPages());
+  EXPECT_TRUE(bpm_->UnpinPage(oldest_page_id, false));
+  EXPECT_EQ(0, catalog_->ReclaimDroppedPages());
+  EXPECT_FALSE(catalog_->DropPartition("events", 3));
+  EXPECT_FALSE(catalog_->DropPartition("missing", 0));
+}
+
+TEST_F(PartitionTest, HashPartitionTest) {
+  auto *meta = catalog_->CreateHashPartitionedTable(&txn_, "users", schema_, 0, 4);
+  ASSERT_NE(nullptr, meta);
+  for (int32_t id = 0; id < 1000; id++) {
+    auto *child = Insert(meta, id);
+    ASSERT_NE(nullptr, child);
+    // A point lookup prunes to the partition the row went to.
+    auto key = ValueFactory::GetIntegerValue(id);
+    EXPECT_EQ(std::vector<TableInfo *>{child}, catalog_->GetPartitions("users", &key, &key));
+  }
+
+  size_t rows = 0;
+  for (auto *child : catalog_->GetPartitions("users")) {
+    auto partition_rows = CountRows(child);
+    EXPECT_GT(partition_rows, 150);
+    rows += partition_rows;
+  }
+  EXPECT_EQ(1000, rows);
+
+  // Ranges cannot be pruned by hash, and hash partitions cannot be dropped.
+  auto k10 = ValueFactory::GetIntegerValue(10);
+  auto k20 = ValueFactory::GetIntegerValue(20);
+  EXPECT_EQ(4, catalog_->GetPartitions("users", &k10, &k20).size());
+  EXPECT_FALSE(catalog_->DropPartition("users", 0));
+  EXPECT_EQ(nullptr, catalog_->AddRangePartition(&txn_, "users", k20));
+}
+
+TEST_F(PartitionTest, PartitionScanTest) {
+  std::vector<Value> bounds{ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(100),
+                            ValueFactory::GetIntegerValue(200), ValueFactory::GetIntegerValue(300)};
+  auto *meta = catalog_->CreateRangePartitionedTable(&txn_, "events", schema_, 0, bounds);
+  ASSERT_NE(nullptr, meta);
+  for (int32_t ts = 0; ts < 300; ts++) {
+    Insert(meta, ts);
+  }
+
+  ExecutorContext exec_ctx(&txn_, catalog_.get(), bpm_.get(), nullptr, nullptr);
+  ColumnValueExpression ts{0, 0, TypeId::INTEGER};
+  ColumnValueExpression v{0, 1, TypeId::INTEGER};
+  Schema output_schema{std::vector<Column>{{"ts", TypeId::INTEGER, &ts}, {"v", TypeId::INTEGER, &v}}};
+  auto scan = [&](const PartitionScanPlanNode &plan, size_t partitions) {
+    PartitionScanExecutor executor(&exec_ctx, &plan);
+    executor.Init();
+    EXPECT_EQ(partitions, executor.GetPartitionCount());
+    std::vector<int32_t> result;
+    Tuple tuple;
+    RID rid;
+    while (executor.Next(&tuple, &rid)) {
+      auto key = tuple.GetValue(&output_schema, 0).GetAs<int32_t>();
+      EXPECT_EQ(key * 2, tuple.GetValue(&output_schema, 1).GetAs<int32_t>());
+      result.push_back(key);
+    }
+    return result;
+  };
+
+  // A range predicate reads only the partitions overlapping the range.
+  auto k150 = ValueFactory::GetIntegerValue(150);
+  ConstantValueExpression const150{k150};
+  ComparisonExpression from150{&ts, &const150, ComparisonType::GreaterThanOrEqual};
+  auto rows = scan(PartitionScanPlanNode(&output_schema, &from150, "events", k150), 2);
+  ASSERT_EQ(150, rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    EXPECT_EQ(150 + static_cast<int32_t>(i), rows[i]);
+  }
+
+  // A point predicate reads one partition; no range reads them all.
+  auto k42 = ValueFactory::GetIntegerValue(42);
+  ConstantValueExpression const42{k42};
+  ComparisonExpression is42{&ts, &const42, ComparisonType::Equal};
+  EXPECT_EQ(std::vector<int32_t>{42}, scan(PartitionScanPlanNode(&output_schema, &is42, "events", k42, k42), 1));
+  EXPECT_EQ(300, scan(PartitionScanPlanNode(&output_schema, nullptr, "events"), 3).size());
+
+  // Dropped partitions are not scanned, and their heap and index pages can all be freed afterwards.
+  catalog_->CreatePartitionedIndex<KeyType, RID, GenericComparator<8>>(&txn_, "events_ts", "events", key_schema_, {0},
+                                                                       8, HashFunction<KeyType>{});
+  ASSERT_TRUE(catalog_->DropPartition("events", 0));
+  EXPECT_EQ(200, scan(PartitionScanPlanNode(&output_schema, nullptr, "events"), 2).size());
+  EXPECT_EQ(0, catalog_->ReclaimDroppedPages());
+}
+
+}  // namespace bustub
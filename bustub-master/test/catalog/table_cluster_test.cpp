@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_cluster_test.cpp
+//
+// Identification: test/catalog/table_cluster_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "map_index.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using KeyType = GenericKey<8>;
+
+class TableClusterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManager>("table_cluster_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(64, disk_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), nullptr, nullptr);
+    std::vector<Column> columns{{"k", TypeId::INTEGER}, {"v", TypeId::INTEGER}};
+    schema_ = std::make_unique<Schema>(columns);
+    table_info_ = catalog_->CreateTable(&txn_, "t", *schema_);
+
+    // Keys arrive in a scrambled order.
+    for (int32_t i = 0; i < NUM_ROWS; i++) {
+      RID rid;
+      ASSERT_TRUE(table_info_->table_->InsertTuple(MakeTuple((i * 7919) % NUM_ROWS, i), &rid, &txn_));
+    }
+
+    std::vector<Column> key_columns{{"k", TypeId::INTEGER}};
+    Schema key_schema{key_columns};
+    index_info_ = catalog_->CreateIndex<KeyType, RID, GenericComparator<8>>(
+        &txn_, "t_k", "t", *schema_, key_schema, {0}, 8, HashFunction<KeyType>{});
+    // Swap in an index that works without the hash table, and fill it from the heap.
+    index_info_->index_ = std::make_unique<MapIndex>(
+        std::make_unique<IndexMetadata>("t_k", "t", schema_.get(), std::vector<uint32_t>{0}));
+    for (auto tuple = table_info_->table_->Begin(&txn_); tuple != table_info_->table_->End(); ++tuple) {
+      index_info_->index_->InsertEntry(KeyOf(*tuple), tuple->GetRid(), &txn_);
+    }
+  }
+
+  void TearDown() override {
+    remove("table_cluster_test.db");
+    remove("table_cluster_test.log");
+  }
+
+  auto MakeTuple(int32_t k, int32_t v) -> Tuple {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(k), ValueFactory::GetIntegerValue(v)};
+    return Tuple(values, schema_.get());
+  }
+
+  auto KeyOf(Tuple tuple) -> Tuple {
+    return tuple.KeyFromTuple(*schema_, index_info_->key_schema_, index_info_->index_->GetKeyAttrs());
+  }
+
+  auto GetIndex() -> MapIndex * { return static_cast<MapIndex *>(index_info_->index_.get()); }
+
+  /** Check that every index entry points at a live row of the current heap with the same key. */
+  void CheckIndex(size_t expected_rows) {
+    EXPECT_EQ(expected_rows, GetIndex()->GetEntries().size());
+    for (const auto &[key, rid] : GetIndex()->GetEntries()) {
+      Tuple tuple;
+      ASSERT_TRUE(table_info_->table_->GetTuple(rid, &tuple, &txn_));
+      EXPECT_EQ(key, tuple.GetValue(schema_.get(), 0).GetAs<int32_t>());
+    }
+  }
+
+  static constexpr int32_t NUM_ROWS = 2000;
+
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+  std::unique_ptr<Catalog> catalog_;
+  std::unique_ptr<Schema> schema_;
+  Transaction txn_{0};
+  TableInfo *table_info_;
+  IndexInfo *index_info_;
+};
+
+TEST_F(TableClusterTest, ClusterTest) {
+  EXPECT_FALSE(catalog_->ClusterTable(&txn_, "t", "missing"));
+  EXPECT_FALSE(catalog_->ClusterTable(&txn_, "missing", "t_k"));
+
+  auto *old_heap = table_info_->table_.get();
+  ASSERT_TRUE(catalog_->ClusterTable(&txn_, "t", "t_k"));
+  EXPECT_NE(old_heap, table_info_->table_.get());
+
+  int32_t expected = 0;
+  for (auto tuple = table_info_->table_->Begin(&txn_); tuple != table_info_->table_->End(); ++tuple) {
+    EXPECT_EQ(expected++, tuple->GetValue(schema_.get(), 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(NUM_ROWS, expected);
+  CheckIndex(NUM_ROWS);
+
+  // The old heap stays readable but refuses writes.
+  Transaction writer(1);
+  RID rid;
+  EXPECT_FALSE(old_heap->InsertTuple(MakeTuple(-1, 0), &rid, &writer));
+  EXPECT_EQ(TransactionState::ABORTED, writer.GetState());
+}
+
+TEST_F(TableClusterTest, ConcurrentIndexScanTest) {
+  // Readers look keys up in the index and read the rows, the way index scans do, while the table is rewritten: every
+  // RID they get must resolve to its row in the heap they read it from.
+  std::atomic<bool> done{false};
+  std::atomic<int> lookups{0};
+  std::atomic<int> mismatches{0};
+  std::thread reader([&] {
+    Transaction reader_txn(1);
+    for (int32_t k = 0; !done || lookups < NUM_ROWS; k = (k + 1) % NUM_ROWS) {
+      std::vector<RID> rids;
+      table_info_->heap_latch_.RLock();
+      GetIndex()->ScanKey(KeyOf(MakeTuple(k, 0)), &rids, &reader_txn);
+      TableHeap *heap = table_info_->table_.get();
+      table_info_->heap_latch_.RUnlock();
+      Tuple tuple;
+      if (rids.size() != 1 || !heap->GetTuple(rids[0], &tuple, &reader_txn) ||
+          tuple.GetValue(schema_.get(), 0).GetAs<int32_t>() != k) {
+        mismatches++;
+      }
+      lookups++;
+    }
+  });
+  for (int round = 0; round < 3; round++) {
+    ASSERT_TRUE(catalog_->ClusterTable(&txn_, "t", "t_k"));
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(0, mismatches);
+  CheckIndex(NUM_ROWS);
+}
+
+TEST_F(TableClusterTest, CatchUpTest) {
+  auto *old_heap = table_info_->table_.get();
+  TableClusterer clusterer(table_info_, index_info_, catalog_->GetTableIndexes("t"), &txn_);
+  clusterer.CopyInOrder();
+
+  // Writes that land after the copy, maintaining the index the way executors do.
+  RID rid;
+  ASSERT_TRUE(old_heap->InsertTuple(MakeTuple(NUM_ROWS, 0), &rid, &txn_));
+  GetIndex()->InsertEntry(KeyOf(MakeTuple(NUM_ROWS, 0)), rid, &txn_);
+
+  std::vector<RID> rids;
+  GetIndex()->ScanKey(KeyOf(MakeTuple(0, 0)), &rids, &txn_);
+  ASSERT_EQ(1, rids.size());
+  ASSERT_TRUE(old_heap->MarkDelete(rids[0], &txn_));
+  old_heap->ApplyDelete(rids[0], &txn_);
+  GetIndex()->DeleteEntry(KeyOf(MakeTuple(0, 0)), rids[0], &txn_);
+
+  rids.clear();
+  GetIndex()->ScanKey(KeyOf(MakeTuple(1, 0)), &rids, &txn_);
+  ASSERT_EQ(1, rids.size());
+  ASSERT_TRUE(old_heap->UpdateTuple(MakeTuple(1, 42), rids[0], &txn_));
+
+  // ApplyDelete of the deleted row is captured too, hence four changes.
+  EXPECT_EQ(4, clusterer.CatchUp());
+  EXPECT_EQ(0, clusterer.CatchUp());
+
+  // One more write between the last online round and the final phase. It reuses the slot freed above, which the
+  // new heap must treat as a new row rather than as the deleted one.
+  ASSERT_TRUE(old_heap->InsertTuple(MakeTuple(NUM_ROWS + 1, 0), &rid, &txn_));
+  GetIndex()->InsertEntry(KeyOf(MakeTuple(NUM_ROWS + 1, 0)), rid, &txn_);
+
+  auto retired = clusterer.Finish();
+  EXPECT_EQ(old_heap, retired.get());
+
+  // Copied rows come out in key order, rows written during the rewrite follow.
+  std::vector<int32_t> keys;
+  for (auto tuple = table_info_->table_->Begin(&txn_); tuple != table_info_->table_->End(); ++tuple) {
+    keys.push_back(tuple->GetValue(schema_.get(), 0).GetAs<int32_t>());
+    if (keys.back() == 1) {
+      EXPECT_EQ(42, tuple->GetValue(schema_.get(), 1).GetAs<int32_t>());
+    }
+  }
+  ASSERT_EQ(NUM_ROWS + 1, keys.size());
+  for (int32_t i = 0; i < NUM_ROWS - 1; i++) {
+    EXPECT_EQ(i + 1, keys[i]);
+  }
+  EXPECT_EQ(NUM_ROWS, keys[NUM_ROWS - 1]);
+  EXPECT_EQ(NUM_ROWS + 1, keys[NUM_ROWS]);
+  CheckIndex(NUM_ROWS + 1);
+}
+
+}  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_stats_test.cpp
+//
+// Identification: test/catalog/table_stats_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "common/util/hyperloglog.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(TableStatsTest, HyperLogLogTest) {
+  HyperLogLog small;
+  for (uint64_t i = 0; i < 100; i++) {
+    small.AddHash(i);
+    small.AddHash(i);
+  }
+  EXPECT_NEAR(100, small.Estimate(), 3);
+
+  // Two halves summarized separately and merged estimate the union.
+  HyperLogLog left;
+  HyperLogLog right;
+  for (uint64_t i = 0; i < 100000; i++) {
+    (i % 2 == 0 ? left : right).AddHash(i);
+  }
+  left.Merge(right);
+  EXPECT_NEAR(100000, left.Estimate(), 100000 * 0.05);
+}
+
+TEST(TableStatsTest, AnalyzeTest) {
+  auto disk_manager = std::make_unique<DiskManager>("table_stats_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  // id is unique, grp has 10 distinct values, opt is NULL on every fourth row.
+  std::vector<Column> columns{{"id", TypeId::INTEGER}, {"grp", TypeId::INTEGER}, {"opt", TypeId::BIGINT}};
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(&txn, "stats", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  EXPECT_EQ(nullptr, table_info->stats_);
+
+  const int32_t num_rows = 10000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10),
+                              i % 4 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                         : ValueFactory::GetBigIntValue(i)};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  }
+
+  AnalyzeOptions options;
+  options.num_workers_ = 4;
+  options.histogram_buckets_ = 10;
+  auto stats = catalog->AnalyzeTable(&txn, "stats", options);
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(stats, std::atomic_load(&table_info->stats_));
+  EXPECT_EQ(num_rows, stats->GetRowCount());
+  EXPECT_EQ(stats->GetPageCount(), stats->GetSampledPageCount());
+
+  const auto &id_stats = stats->GetColumnStats(0);
+  EXPECT_NEAR(num_rows, id_stats.GetDistinctCount(), num_rows * 0.05);
+  EXPECT_DOUBLE_EQ(0, id_stats.GetNullFraction());
+  ASSERT_EQ(11, id_stats.GetHistogramBounds().size());
+  EXPECT_EQ(0, id_stats.GetHistogramBounds().front().GetAs<int32_t>());
+  EXPECT_EQ(num_rows - 1, id_stats.GetHistogramBounds().back().GetAs<int32_t>());
+  EXPECT_NEAR(0.25, id_stats.EstimateLessThanSelectivity(ValueFactory::GetIntegerValue(num_rows / 4)), 0.02);
+  EXPECT_DOUBLE_EQ(0, id_stats.EstimateLessThanSelectivity(ValueFactory::GetIntegerValue(-5)));
+  EXPECT_DOUBLE_EQ(1, id_stats.EstimateLessThanSelectivity(ValueFactory::GetIntegerValue(num_rows * 2)));
+
+  const auto &grp_stats = stats->GetColumnStats(1);
+  EXPECT_EQ(10, grp_stats.GetDistinctCount());
+  EXPECT_NEAR(0.1, grp_stats.EstimateEqualSelectivity(ValueFactory::GetIntegerValue(3)), 0.01);
+  EXPECT_DOUBLE_EQ(0, grp_stats.EstimateEqualSelectivity(ValueFactory::GetIntegerValue(42)));
+
+  const auto &opt_stats = stats->GetColumnStats(2);
+  EXPECT_DOUBLE_EQ(0.25, opt_stats.GetNullFraction());
+
+  // Sampling a subset of the pages extrapolates the row count and the NDV of unique columns.
+  options.sample_pages_ = stats->GetPageCount() / 2;
+  auto sampled = catalog->AnalyzeTable(&txn, "stats", options);
+  EXPECT_EQ(options.sample_pages_, sampled->GetSampledPageCount());
+  EXPECT_NEAR(num_rows, sampled->GetRowCount(), num_rows * 0.1);
+  EXPECT_NEAR(num_rows, sampled->GetColumnStats(0).GetDistinctCount(), num_rows * 0.15);
+  EXPECT_EQ(10, sampled->GetColumnStats(1).GetDistinctCount());
+
+  // Row counts follow inserts and deletes without a new ANALYZE, until the table has changed enough.
+  std::vector<Value> values{ValueFactory::GetIntegerValue(num_rows), ValueFactory::GetIntegerValue(0),
+                            ValueFactory::GetBigIntValue(0)};
+  RID rid;
+  ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  ASSERT_TRUE(table_info->table_->MarkDelete(rid, &txn));
+  ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  EXPECT_EQ(sampled->GetRowCount() + 1, sampled->GetEstimatedRowCount(table_info->table_.get()));
+  EXPECT_FALSE(sampled->IsStale(table_info->table_.get(), 0.2));
+  EXPECT_EQ(sampled, catalog->GetTableStats(&txn, "stats", 0.2));
+  auto refreshed = catalog->GetTableStats(&txn, "stats", 0);
+  EXPECT_NE(sampled, refreshed);
+  EXPECT_LE(refreshed->GetSampledPageCount(), AnalyzeOptions{}.sample_pages_);
+
+  // A second delete of the same row marks nothing, so it leaves nothing to roll back.
+  uint64_t deletes = table_info->table_->GetDeleteCount();
+  size_t writes = txn.GetWriteSet()->size();
+  ASSERT_TRUE(table_info->table_->MarkDelete(rid, &txn));
+  ASSERT_TRUE(table_info->table_->MarkDelete(rid, &txn));
+  EXPECT_EQ(deletes + 1, table_info->table_->GetDeleteCount());
+  EXPECT_EQ(writes + 1, txn.GetWriteSet()->size());
+  table_info->table_->RollbackDelete(rid, &txn);
+  EXPECT_EQ(deletes, table_info->table_->GetDeleteCount());
+
+  EXPECT_EQ(nullptr, catalog->AnalyzeTable(&txn, "missing"));
+
+  remove("table_stats_test.db");
+  remove("table_stats_test.log");
+}
+
+TEST(TableStatsTest, SkewedWorkersTest) {
+  auto disk_manager = std::make_unique<DiskManager>("table_stats_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  // The first pages hold many narrow rows with keys >= 0, the last ones a few wide rows with key -1, so the two
+  // workers below see very different row counts. Their samples must count in proportion to those rows.
+  std::vector<Column> columns{{"key", TypeId::INTEGER}, {"pad", TypeId::VARCHAR, 1000}};
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(&txn, "skewed", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  const int32_t wide_rows = 200;
+  const int32_t narrow_rows = 2000;
+  for (int32_t i = 0; i < wide_rows + narrow_rows; i++) {
+    bool wide = i >= narrow_rows;
+    std::vector<Value> values{ValueFactory::GetIntegerValue(wide ? -1 : i),
+                              ValueFactory::GetVarcharValue(std::string(wide ? 1000 : 1, 'x'))};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  }
+
+  AnalyzeOptions options;
+  options.num_workers_ = 2;
+  options.histogram_sample_size_ = 100;
+  auto stats = catalog->AnalyzeTable(&txn, "skewed", options);
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(wide_rows + narrow_rows, stats->GetRowCount());
+  const double expected = static_cast<double>(wide_rows) / (wide_rows + narrow_rows);
+  EXPECT_NEAR(expected, stats->GetColumnStats(0).EstimateLessThanSelectivity(ValueFactory::GetIntegerValue(0)),
+              0.05);
+
+  remove("table_stats_test.db");
+  remove("table_stats_test.log");
+}
+
+}  // namespace bustub
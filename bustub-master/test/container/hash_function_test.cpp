@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_function_test.cpp
+//
+// Identification: test/container/hash_function_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+namespace {
+
+template <size_t KeySize>
+auto MakeKey(int64_t key) -> GenericKey<KeySize> {
+  GenericKey<KeySize> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+/** @return the largest number of keys that share the low 16 bits of their hash */
+template <typename KeyType>
+auto MaxBucketSize(const std::vector<KeyType> &keys) -> size_t {
+  HashFunction<KeyType> hash_fn;
+  std::vector<size_t> buckets(1 << 16);
+  for (const auto &key : keys) {
+    buckets[hash_fn.GetHash(key) & 0xffff]++;
+  }
+  return *std::max_element(buckets.begin(), buckets.end());
+}
+
+}  // namespace
+
+TEST(HashFunctionTest, IntegerTest) {
+  HashFunction<int64_t> hash_fn;
+  std::vector<int64_t> keys;
+  std::unordered_set<uint64_t> hashes;
+  for (int64_t key = -50000; key < 50000; key++) {
+    keys.push_back(key);
+    hashes.insert(hash_fn.GetHash(key));
+  }
+  // the mix is a bijection, and spreads consecutive keys over the low bits that pick directory entries
+  EXPECT_EQ(keys.size(), hashes.size());
+  EXPECT_LT(MaxBucketSize(keys), 16);
+
+  std::vector<uint64_t> batch(keys.size());
+  hash_fn.GetHashes(keys.data(), keys.size(), batch.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(hash_fn.GetHash(keys[i]), batch[i]);
+  }
+
+  HashFunction<int> int_hash_fn;
+  EXPECT_EQ(hash_fn.GetHash(-7), int_hash_fn.GetHash(-7));
+}
+
+TEST(HashFunctionTest, GenericKeyTest) {
+  HashFunction<GenericKey<64>> hash_fn;
+  std::vector<GenericKey<64>> keys;
+  std::unordered_set<uint64_t> hashes;
+  for (int64_t key = -50000; key < 50000; key++) {
+    keys.push_back(MakeKey<64>(key));
+    hashes.insert(hash_fn.GetHash(keys.back()));
+  }
+  EXPECT_EQ(keys.size(), hashes.size());
+  EXPECT_LT(MaxBucketSize(keys), 16);
+
+  std::vector<uint64_t> batch(keys.size());
+  hash_fn.GetHashes(keys.data(), keys.size(), batch.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(hash_fn.GetHash(keys[i]), batch[i]);
+  }
+
+  // The zero words at the end are skipped, but keys that differ only in where their words sit do not collide, and
+  // every byte counts, also in the last word of a key and in keys shorter than a word.
+  GenericKey<64> zero;
+  memset(zero.data_, 0, sizeof(zero.data_));
+  GenericKey<64> first = zero;
+  first.data_[0] = 1;
+  GenericKey<64> second = zero;
+  second.data_[8] = 1;
+  GenericKey<64> last = zero;
+  last.data_[63] = 1;
+  std::unordered_set<uint64_t> distinct{hash_fn.GetHash(zero), hash_fn.GetHash(first), hash_fn.GetHash(second),
+                                        hash_fn.GetHash(last)};
+  EXPECT_EQ(4, distinct.size());
+
+  HashFunction<GenericKey<4>> short_hash_fn;
+  std::unordered_set<uint64_t> short_hashes;
+  for (int byte = 0; byte < 4; byte++) {
+    GenericKey<4> key;
+    memset(key.data_, 0, sizeof(key.data_));
+    key.data_[byte] = 1;
+    short_hashes.insert(short_hash_fn.GetHash(key));
+  }
+  EXPECT_EQ(4, short_hashes.size());
+}
+
+}  // namespace bustub
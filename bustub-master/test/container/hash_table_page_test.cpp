@@ -15,15 +15,18 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
+#include "container/hash/hash_function.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/index/generic_key.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "test_util.h"  // NOLINT
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -57,7 +60,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -114,4 +117,47 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+TEST(HashTablePageTest, BucketPageTagTest) {
+  std::vector<char> data(PAGE_SIZE, 0);
+  auto *bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(data.data());
+
+  // Tags only narrow the search: keys share tags, and a key is only found with the tag it was inserted with.
+  const int n = 300;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(bucket_page->Insert(i, i, IntComparator(), i % 7));
+  }
+  EXPECT_FALSE(bucket_page->Insert(0, 0, IntComparator(), 0));
+  EXPECT_TRUE(bucket_page->Insert(0, 1, IntComparator(), 0));
+  for (int i = 0; i < n; i++) {
+    std::vector<int> result;
+    ASSERT_TRUE(bucket_page->GetValue(i, IntComparator(), &result, i % 7));
+    EXPECT_EQ(i == 0 ? 2 : 1, result.size());
+    EXPECT_EQ(i % 7, bucket_page->TagAt(i));
+    EXPECT_FALSE(bucket_page->GetValue(i, IntComparator(), &result, i % 7 + 1));
+  }
+
+  // removed slots are reused, along with their tags
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(bucket_page->Remove(i, i, IntComparator(), i % 7));
+  }
+  EXPECT_FALSE(bucket_page->Remove(1, 1, IntComparator(), 2));
+  EXPECT_EQ(n / 2 + 1, bucket_page->NumReadable());
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(bucket_page->Insert(i, i, IntComparator(), 100));
+    EXPECT_EQ(100, bucket_page->TagAt(i));
+  }
+  for (int i = 0; i < n; i++) {
+    std::vector<int> result;
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &result, i % 2 == 0 ? 100 : i % 7));
+  }
+
+  // fill the bucket up, past the last whole group of tags
+  for (int i = n; !bucket_page->IsFull(); i++) {
+    ASSERT_TRUE(bucket_page->Insert(i, i, IntComparator(), 5));
+  }
+  std::vector<int> result;
+  EXPECT_FALSE(bucket_page->Insert(-1, -1, IntComparator(), 5));
+  EXPECT_TRUE(bucket_page->GetValue(n + 1, IntComparator(), &result, 5));
+}
+
 }  // namespace bustub
@@ -10,6 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -18,16 +25,17 @@
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "test_util.h"  // NOLINT
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
-  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
 
   // insert a few values
   for (int i = 0; i < 5; i++) {
@@ -114,7 +122,274 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   disk_manager->ShutDown();
   remove("test.db");
   delete disk_manager;
-  delete bpm;
+}
+
+TEST(HashTableTest, GrowShrinkTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // enough pairs to split the first bucket many times over
+  const int n = 20000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  ht.VerifyDirectoryTree();
+  EXPECT_LT(0, ht.GetGlobalDepth());
+  for (int i = 0; i < n; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // emptied buckets merge again, until a single bucket is left
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+  ht.VerifyDirectoryTree();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(HashTableTest, DestructorTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(3, &disk_manager);
+  // Each table pins its directory page while it lives; a leaked pin would leave too few frames for the next table.
+  for (int round = 0; round < 5; round++) {
+    ExtendibleHashTable<int, int, IntComparator> ht("blah", &bpm, IntComparator(), HashFunction<int>());
+    EXPECT_TRUE(ht.Insert(nullptr, round, round));
+  }
+  page_id_t page_id;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NE(nullptr, bpm.NewPage(&page_id));
+  }
+
+  disk_manager.ShutDown();
+  remove("test.db");
+}
+
+TEST(HashTableTest, PinnedMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+  const int n = 5000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_LT(0, ht.GetGlobalDepth());
+
+  // Pin every page, as lookups without the table latch may: the merges cannot delete the buckets they drop, and
+  // go on without them.
+  page_id_t next_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&next_page_id));
+  bpm->UnpinPage(next_page_id, false);
+  bpm->DeletePage(next_page_id);
+  for (page_id_t page_id = 0; page_id < next_page_id; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyDirectoryTree();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  for (page_id_t page_id = 0; page_id < next_page_id; page_id++) {
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // the table grows and shrinks as before, deleting the dropped buckets on the way
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyDirectoryTree();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(HashTableTest, DeepDirectoryTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm.get(), comparator,
+                                                                     HashFunction<GenericKey<64>>());
+  auto make_key = [](int64_t i) {
+    GenericKey<64> key;
+    key.SetFromInteger(i);
+    return key;
+  };
+
+  // wide keys leave room for few pairs per bucket, so that the directory outgrows its head page
+  const int64_t n = 100000;
+  for (int64_t i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, make_key(i), RID(i)));
+  }
+  ht.VerifyDirectoryTree();
+  EXPECT_LT(DIRECTORY_LEVEL_DEPTH, ht.GetGlobalDepth());
+  for (int64_t i = 0; i < n; i++) {
+    std::vector<RID> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, make_key(i), &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0].Get());
+  }
+
+  // the directory shrinks back into its head page as the buckets merge
+  std::vector<int64_t> keys(n);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (int64_t j = 0; j < n; j++) {
+    ASSERT_TRUE(ht.Remove(nullptr, make_key(keys[j]), RID(keys[j])));
+    if (j == n / 2) {
+      ht.VerifyDirectoryTree();
+      for (int64_t k = j + 1; k < n; k += 97) {
+        std::vector<RID> res;
+        ASSERT_TRUE(ht.GetValue(nullptr, make_key(keys[k]), &res));
+      }
+    }
+  }
+  ht.VerifyDirectoryTree();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // Readers look up the keys present from the start while writers insert and remove the others, splitting and
+  // merging buckets under them.
+  const int n = 40000;
+  const int num_writers = 4;
+  const int num_readers = 4;
+  for (int key = 0; key < n; key += 4) {
+    ht.Insert(nullptr, key, key);
+  }
+  std::atomic<int> writers_left{num_writers};
+  std::atomic<int64_t> misses{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 2; round++) {
+        for (int key = t; key < n; key += num_writers) {
+          if (key % 4 != 0) {
+            EXPECT_TRUE(ht.Insert(nullptr, key, key));
+          }
+        }
+        for (int key = t; key < n; key += num_writers) {
+          if (key % 4 != 0 && (round == 0 || key % 2 == 0)) {
+            EXPECT_TRUE(ht.Remove(nullptr, key, key));
+          }
+        }
+      }
+      writers_left--;
+    });
+  }
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<int> res;
+      for (int key = 4 * t; writers_left > 0; key = (key + 4 * num_readers) % n) {
+        res.clear();
+        if (!ht.GetValue(nullptr, key, &res) || res.size() != 1 || res[0] != key) {
+          misses++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, misses);
+  ht.VerifyDirectoryTree();
+  for (int key = 0; key < n; key++) {
+    std::vector<int> res;
+    EXPECT_EQ(key % 4 == 0 || key % 2 == 1, ht.GetValue(nullptr, key, &res)) << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(HashTableTest, DeepConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm.get(), comparator,
+                                                                     HashFunction<GenericKey<64>>());
+  auto make_key = [](int64_t i) {
+    GenericKey<64> key;
+    key.SetFromInteger(i);
+    return key;
+  };
+
+  // Readers look up keys through the in-memory copy of the directory while a writer grows the directory past its
+  // head page and shrinks it back, splitting and merging buckets under them.
+  const int64_t n = 60000;
+  const int num_readers = 3;
+  for (int64_t key = 0; key < n; key += 8) {
+    ht.Insert(nullptr, make_key(key), RID(key));
+  }
+  std::atomic<bool> done{false};
+  std::atomic<int64_t> misses{0};
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] {
+    for (int64_t key = 0; key < n; key++) {
+      if (key % 8 != 0) {
+        EXPECT_TRUE(ht.Insert(nullptr, make_key(key), RID(key)));
+      }
+    }
+    EXPECT_LT(DIRECTORY_LEVEL_DEPTH, ht.GetGlobalDepth());
+    for (int64_t key = 0; key < n; key++) {
+      if (key % 8 != 0) {
+        EXPECT_TRUE(ht.Remove(nullptr, make_key(key), RID(key)));
+      }
+    }
+    done = true;
+  });
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<RID> res;
+      for (int64_t key = 8 * t; !done; key = (key + 8 * num_readers) % n) {
+        res.clear();
+        if (!ht.GetValue(nullptr, make_key(key), &res) || res.size() != 1 || res[0].Get() != key) {
+          misses++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, misses);
+  ht.VerifyDirectoryTree();
+  for (int64_t key = 0; key < n; key++) {
+    std::vector<RID> res;
+    EXPECT_EQ(key % 8 == 0, ht.GetValue(nullptr, make_key(key), &res)) << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
 }
 
 }  // namespace bustub
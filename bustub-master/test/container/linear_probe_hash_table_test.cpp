@@ -0,0 +1,231 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 1000, HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // non-unique keys, but no duplicate pairs
+  for (int i = 0; i < 5; i++) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+    if (i != 0) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+    }
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    std::sort(res.begin(), res.end());
+    std::vector<int> expected = i == 0 ? std::vector<int>{0} : std::vector<int>{i, 2 * i};
+    EXPECT_EQ(expected, res);
+  }
+
+  // removed pairs are gone, and can come back
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    EXPECT_EQ(i != 0, ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_TRUE(ht.Insert(nullptr, 0, 0));
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 0, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(LinearProbeHashTableTest, DestructorTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(4, &disk_manager);
+  // Each table pins its header page while it lives; a leaked pin would leave too few frames for the next table.
+  for (int round = 0; round < 5; round++) {
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", &bpm, IntComparator(), 1, HashFunction<int>());
+    EXPECT_TRUE(ht.Insert(nullptr, round, round));
+  }
+  page_id_t page_id;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_NE(nullptr, bpm.NewPage(&page_id));
+  }
+
+  disk_manager.ShutDown();
+  remove("test.db");
+}
+
+TEST(LinearProbeHashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 1, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // the table resizes many times over, and is checked halfway through the first resize
+  const int n = 20000;
+  bool checked_resize = false;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    if (!checked_resize && ht.IsResizing()) {
+      checked_resize = true;
+      for (int j = 0; j <= i; j++) {
+        std::vector<int> res;
+        ASSERT_TRUE(ht.GetValue(nullptr, j, &res));
+        ASSERT_EQ(1, res.size());
+      }
+    }
+  }
+  EXPECT_TRUE(checked_resize);
+  EXPECT_LT(initial_size, ht.GetSize());
+  EXPECT_LE(2 * static_cast<size_t>(n), ht.GetSize());
+  for (int i = 0; i < n; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // churn leaves tombstones behind, which resizes clear without growing the table for good
+  size_t size = ht.GetSize();
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(ht.Remove(nullptr, i, i));
+      ASSERT_TRUE(ht.Insert(nullptr, i, i + 1));
+    }
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(ht.Remove(nullptr, i, i + 1));
+      ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    }
+  }
+  EXPECT_GE(2 * size, ht.GetSize());
+  for (int i = 0; i < n; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(LinearProbeHashTableTest, HeaderChainTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+  LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm.get(), comparator, 1,
+                                                                      HashFunction<GenericKey<64>>());
+
+  // the table outgrows the blocks one header page holds, and keeps growing into a chain of header pages
+  using KeyType = GenericKey<64>;
+  using ValueType = RID;
+  const size_t one_header_size = HEADER_ARRAY_SIZE * BLOCK_ARRAY_SIZE;
+  const int64_t n = one_header_size / 2 + 1000;
+  GenericKey<64> index_key;
+  for (int64_t i = 0; i < n; i++) {
+    index_key.SetFromInteger(i);
+    ASSERT_TRUE(ht.Insert(nullptr, index_key, RID(i)));
+  }
+  EXPECT_LT(one_header_size, ht.GetSize());
+  for (int64_t i = 0; i < n; i++) {
+    std::vector<RID> res;
+    index_key.SetFromInteger(i);
+    ASSERT_TRUE(ht.GetValue(nullptr, index_key, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(RID(i), res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+TEST(LinearProbeHashTableTest, ConcurrentResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 1, HashFunction<int>());
+
+  // Readers look up the keys present from the start while writers insert and remove others, resizing the table and
+  // moving the pairs under the readers all the time.
+  const int n = 40000;
+  const int num_writers = 4;
+  const int num_readers = 4;
+  for (int i = 0; i < n; i += 8) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  std::atomic<int> writers_left{num_writers};
+  std::atomic<int> misses{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < n; i += num_writers) {
+        if (i % 8 != 0) {
+          EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        }
+      }
+      for (int i = t; i < n; i += num_writers) {
+        if (i % 8 == 4) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+      writers_left--;
+    });
+  }
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<int> res;
+      for (int i = t * 8; writers_left > 0; i = (i + 8 * num_readers) % n) {
+        res.clear();
+        if (!ht.GetValue(nullptr, i, &res) || res.size() != 1 || res[0] != i) {
+          misses++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, misses);
+  for (int i = 0; i < n; i++) {
+    std::vector<int> res;
+    ASSERT_EQ(i % 8 != 4, ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -22,20 +25,25 @@
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/bitmap_heap_scan_executor.h"
+#include "execution/executors/index_only_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/bitmap_heap_scan_plan.h"
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_only_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
 #include "executor_test_util.h"  // NOLINT
 #include "gtest/gtest.h"
+#include "map_index.h"  // NOLINT
 #include "storage/table/tuple.h"
 #include "test_util.h"  // NOLINT
 #include "type/value_factory.h"
@@ -653,4 +661,160 @@ TEST_F(ExecutorTest, DISABLED_SimpleDistinctTest) {
   ASSERT_TRUE(std::equal(results.cbegin(), results.cend(), expected.cbegin()));
 }
 
+// SELECT colA, colB FROM test_1 WHERE colB IN (3, 7) AND colA < 500
+TEST_F(ExecutorTest, BitmapHeapScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  std::vector<Column> key_columns{{"colB", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index_b", "test_1", schema, key_schema, {1}, 8, HashFunctionType{});
+  index_info->index_ = std::make_unique<MapIndex>(
+      std::make_unique<IndexMetadata>("index_b", "test_1", &schema, std::vector<uint32_t>{1}));
+  for (auto tuple = table_info->table_->Begin(GetTxn()); tuple != table_info->table_->End(); ++tuple) {
+    index_info->index_->InsertEntry(tuple->KeyFromTuple(schema, key_schema, {1}), tuple->GetRid(), GetTxn());
+  }
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  // Key 3 is probed twice; its rows must still come out once.
+  std::vector<Tuple> keys;
+  for (int32_t b : {3, 7, 3}) {
+    keys.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(b)}, &key_schema);
+  }
+
+  // Both fetch strategies return the same rows; only the bitmap scan returns them in heap order.
+  std::vector<std::vector<RID>> results;
+  for (size_t threshold : {SIZE_MAX, size_t{0}}) {
+    BitmapHeapScanPlanNode plan{out_schema, predicate, index_info->index_oid_, keys, threshold};
+    BitmapHeapScanExecutor executor{GetExecutorContext(), &plan};
+    executor.Init();
+    EXPECT_EQ(threshold == 0, executor.IsBitmapScan());
+    Tuple tuple;
+    RID rid;
+    auto &rids = results.emplace_back();
+    while (executor.Next(&tuple, &rid)) {
+      auto a = tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+      auto b = tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+      ASSERT_LT(a, 500);
+      ASSERT_TRUE(b == 3 || b == 7);
+      rids.push_back(rid);
+    }
+  }
+  ASSERT_FALSE(results[1].empty());
+  EXPECT_TRUE(std::is_sorted(results[1].begin(), results[1].end(),
+                             [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); }));
+  std::unordered_set<RID> index_order(results[0].begin(), results[0].end());
+  EXPECT_EQ(results[0].size(), index_order.size());
+  EXPECT_EQ(index_order, std::unordered_set<RID>(results[1].begin(), results[1].end()));
+
+  // The factory builds the executor as well.
+  BitmapHeapScanPlanNode plan{out_schema, predicate, index_info->index_oid_, keys};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(results[1].size(), result_set.size());
+}
+
+// SELECT colA FROM test_1 WHERE colB IN (3, 7) AND colA < 500, answered from a covering index on colB including colA
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  TableInfo *table_info = catalog->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  std::vector<Column> key_columns{{"colB", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index_b_a", "test_1", schema, key_schema, {1}, 8, HashFunctionType{}, IndexType::BPlusTree, {}, {0});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  const Schema *entry_schema = &index_info->key_schema_;
+  ASSERT_EQ(2, entry_schema->GetColumnCount());
+  EXPECT_EQ(1, index_info->index_->GetIndexColumnCount());
+  EXPECT_EQ(1, index_info->index_->GetIncludeColumnCount());
+
+  // Only B+ tree indexes can include columns.
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO,
+            (catalog->CreateIndex<KeyType, ValueType, ComparatorType>(GetTxn(), "index_b_a_hash", "test_1", schema,
+                                                                     key_schema, {1}, 8, HashFunctionType{},
+                                                                     IndexType::ExtendibleHash, {}, {0})));
+
+  // What the table says: colA by colB, and the RID of every row.
+  std::map<int32_t, std::vector<int32_t>> rows_by_b;
+  std::map<int32_t, RID> rid_by_a;
+  for (auto tuple = table_info->table_->Begin(GetTxn()); tuple != table_info->table_->End(); ++tuple) {
+    auto a = tuple->GetValue(&schema, 0).GetAs<int32_t>();
+    rows_by_b[tuple->GetValue(&schema, 1).GetAs<int32_t>()].push_back(a);
+    rid_by_a[a] = tuple->GetRid();
+  }
+
+  // Probe keys are laid out like the entries; their included column is ignored.
+  std::vector<Tuple> keys;
+  for (int32_t b : {3, 7}) {
+    keys.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(b), ValueFactory::GetIntegerValue(b)},
+                      entry_schema);
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(keys.back(), &rids, GetTxn());
+    EXPECT_EQ(rows_by_b[b].size(), rids.size());
+  }
+
+  auto *col_a = MakeColumnValueExpression(*entry_schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(*entry_schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+
+  // The probes return the rows of each key in colA order, each with the RID of its row.
+  IndexOnlyScanPlanNode plan{out_schema, predicate, index_info->index_oid_, keys};
+  IndexOnlyScanExecutor executor{GetExecutorContext(), &plan};
+  executor.Init();
+  std::vector<int32_t> expected;
+  for (int32_t b : {3, 7}) {
+    std::copy_if(rows_by_b[b].begin(), rows_by_b[b].end(), std::back_inserter(expected),
+                 [](int32_t a) { return a < 500; });
+  }
+  ASSERT_FALSE(expected.empty());
+  Tuple tuple;
+  RID rid;
+  for (auto a : expected) {
+    ASSERT_TRUE(executor.Next(&tuple, &rid));
+    EXPECT_EQ(a, tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    EXPECT_EQ(rid_by_a[a], rid);
+  }
+  EXPECT_FALSE(executor.Next(&tuple, &rid));
+
+  // Without keys every entry is read, ordered by colB and then colA; the factory builds the executor as well.
+  IndexOnlyScanPlanNode full_plan{out_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&full_plan, &result_set, GetTxn(), GetExecutorContext());
+  expected.clear();
+  for (const auto &[b, as] : rows_by_b) {
+    std::copy_if(as.begin(), as.end(), std::back_inserter(expected), [](int32_t a) { return a < 500; });
+  }
+  ASSERT_EQ(expected.size(), result_set.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i], result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+  }
+
+  // An entry that goes away between Init() and the row lock is skipped.
+  std::vector<int32_t> probed;
+  for (int32_t b : {3, 7}) {
+    std::copy_if(rows_by_b[b].begin(), rows_by_b[b].end(), std::back_inserter(probed),
+                 [](int32_t a) { return a < 500; });
+  }
+  enable_logging = true;
+  IndexOnlyScanExecutor locking_executor{GetExecutorContext(), &plan};
+  locking_executor.Init();
+  Tuple removed{std::vector<Value>{ValueFactory::GetIntegerValue(3), ValueFactory::GetIntegerValue(probed[0])},
+                entry_schema};
+  index_info->index_->DeleteEntry(removed, rid_by_a[probed[0]], GetTxn());
+  for (size_t i = 1; i < probed.size(); i++) {
+    ASSERT_TRUE(locking_executor.Next(&tuple, &rid));
+    EXPECT_EQ(probed[i], tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    EXPECT_TRUE(GetTxn()->IsSharedLocked(rid));
+  }
+  EXPECT_FALSE(locking_executor.Next(&tuple, &rid));
+  enable_logging = false;
+}
+
 }  // namespace bustub
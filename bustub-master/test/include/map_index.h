@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// map_index.h
+//
+// Identification: test/include/map_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/** An in-memory index on one INTEGER column, standing in for an index type in tests. */
+class MapIndex : public Index {
+ public:
+  explicit MapIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override {
+    entries_.emplace(KeyOf(key), rid);
+  }
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override {
+    auto range = entries_.equal_range(KeyOf(key));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == rid) {
+        entries_.erase(it);
+        return;
+      }
+    }
+  }
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override {
+    auto range = entries_.equal_range(KeyOf(key));
+    for (auto it = range.first; it != range.second; ++it) {
+      result->push_back(it->second);
+    }
+  }
+
+  auto GetEntries() const -> const std::multimap<int32_t, RID> & { return entries_; }
+
+ private:
+  auto KeyOf(const Tuple &key) const -> int32_t { return key.GetValue(GetKeySchema(), 0).GetAs<int32_t>(); }
+
+  std::multimap<int32_t, RID> entries_;
+};
+
+}  // namespace bustub
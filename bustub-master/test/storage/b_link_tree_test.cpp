@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_link_tree_test.cpp
+//
+// Identification: test/storage/b_link_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_link_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using KeyType = GenericKey<8>;
+using Tree = BLinkTree<KeyType, RID, GenericComparator<8>>;
+
+namespace {
+
+auto MakeKey(int64_t key) -> KeyType {
+  KeyType index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+}  // namespace
+
+TEST(BLinkTreeTest, InsertRemoveTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(50, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  // tiny pages, so that the tree grows many levels
+  Tree tree("foo_pk", &bpm, comparator, 3, 3, header_page_id);
+
+  const int64_t n = 2000;
+  std::vector<int64_t> keys(n);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  std::vector<RID> rids;
+  EXPECT_FALSE(tree.GetValue(MakeKey(0), &rids));
+  for (auto key : keys) {
+    EXPECT_TRUE(tree.Insert(MakeKey(key), RID(key)));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(keys[0]), RID(0)));
+  for (int64_t key = 0; key < n; key++) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeKey(key), &rids));
+    EXPECT_EQ(key, rids[0].Get());
+  }
+  EXPECT_FALSE(tree.GetValue(MakeKey(n), &rids));
+
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      tree.Remove(MakeKey(key));
+    }
+  }
+  for (int64_t key = 0; key < n; key++) {
+    rids.clear();
+    EXPECT_EQ(key % 2 == 1, tree.GetValue(MakeKey(key), &rids));
+  }
+  // removed keys can come back
+  for (int64_t key = 0; key < n; key += 2) {
+    EXPECT_TRUE(tree.Insert(MakeKey(key), RID(key)));
+  }
+  for (int64_t key = 0; key < n; key++) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeKey(key), &rids));
+    EXPECT_EQ(key, rids[0].Get());
+  }
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BLinkTreeTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(100, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  Tree tree("foo_pk", &bpm, comparator, 4, 4, header_page_id);
+
+  // Readers look up the keys present from the start while writers split pages under them all the time.
+  const int64_t n = 8000;
+  const int num_writers = 4;
+  const int num_readers = 4;
+  for (int64_t key = 0; key < n; key += 8) {
+    tree.Insert(MakeKey(key), RID(key));
+  }
+  std::atomic<int> writers_left{num_writers};
+  std::atomic<int64_t> misses{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<int64_t> keys;
+      for (int64_t key = t; key < n; key += num_writers) {
+        if (key % 8 != 0) {
+          keys.push_back(key);
+        }
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(t));
+      for (auto key : keys) {
+        EXPECT_TRUE(tree.Insert(MakeKey(key), RID(key)));
+      }
+      writers_left--;
+    });
+  }
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<RID> rids;
+      while (writers_left > 0) {
+        int64_t key = 8 * (rng() % (n / 8));
+        rids.clear();
+        if (!tree.GetValue(MakeKey(key), &rids) || rids[0].Get() != key) {
+          misses++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, misses);
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < n; key++) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeKey(key), &rids));
+    EXPECT_EQ(key, rids[0].Get());
+  }
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BLinkTreeTest, CatalogCreateIndexTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(32, &disk_manager);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Transaction txn(0);
+  std::vector<Column> columns{{"k", TypeId::BIGINT}, {"v", TypeId::INTEGER}};
+  Schema schema(columns);
+  auto *table_info = catalog.CreateTable(&txn, "t", schema);
+  const int64_t n = 1000;
+  for (int64_t i = 0; i < n; i++) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue((i * 7919) % n),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(i))};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  }
+
+  std::vector<Column> key_columns{{"k", TypeId::BIGINT}};
+  Schema key_schema(key_columns);
+  auto *index_info = catalog.CreateIndex<KeyType, RID, GenericComparator<8>>(
+      &txn, "t_k", "t", schema, key_schema, {0}, 8, HashFunction<KeyType>{}, IndexType::BLinkTree);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  std::vector<RID> rids;
+  for (int64_t k = 0; k < n; k++) {
+    rids.clear();
+    Tuple key({ValueFactory::GetBigIntValue(k)}, &key_schema);
+    index_info->index_->ScanKey(key, &rids, &txn);
+    ASSERT_EQ(1, rids.size());
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &tuple, &txn));
+    EXPECT_EQ(k, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+  }
+  Tuple key({ValueFactory::GetBigIntValue(0)}, &key_schema);
+  index_info->index_->DeleteEntry(key, rids[0], &txn);
+  rids.clear();
+  index_info->index_->ScanKey(key, &rids, &txn);
+  EXPECT_TRUE(rids.empty());
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,276 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/lock_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using KeyType = GenericKey<8>;
+using Tree = BPlusTree<KeyType, RID, GenericComparator<8>>;
+using Sorter = ExternalSort<KeyType, RID, GenericComparator<8>>;
+
+namespace {
+
+void AddKey(Sorter *sorter, int64_t key) {
+  KeyType index_key;
+  index_key.SetFromInteger(key);
+  sorter->Add(index_key, RID(key));
+}
+
+/** Check that the tree holds exactly the keys [0, n), each with its own RID, in order. */
+void CheckKeys(Tree *tree, int64_t n) {
+  int64_t expected = 0;
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.Get());
+    expected++;
+  }
+  EXPECT_EQ(n, expected);
+  KeyType index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < n; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree->GetValue(index_key, &rids));
+    EXPECT_EQ(key, rids[0].Get());
+  }
+}
+
+/** Create a table of n rows (k, i) with distinct keys k in [0, n), in scrambled order. */
+auto CreateTable(Catalog *catalog, Transaction *txn, const Schema &schema, int64_t n) -> TableInfo * {
+  auto *table_info = catalog->CreateTable(txn, "t", schema);
+  for (int64_t i = 0; i < n; i++) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue((i * 7919) % n),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(i))};
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, txn));
+  }
+  return table_info;
+}
+
+}  // namespace
+
+TEST(BPlusTreeBulkLoadTest, SpilledSortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(16, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+
+  // A two-page sort buffer forces sorted runs onto disk and more than one merge pass.
+  const int64_t n = 20000;
+  std::vector<int64_t> keys(n);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  Tree tree("foo_pk", &bpm, comparator, 8, 8, header_page_id);
+  {
+    Sorter sorter(&bpm, comparator, 2);
+    for (auto key : keys) {
+      AddKey(&sorter, key);
+    }
+    // Duplicates keep one entry.
+    AddKey(&sorter, 0);
+    AddKey(&sorter, n - 1);
+    sorter.Sort();
+    EXPECT_GT(sorter.GetRunCount(), 2);
+    ASSERT_TRUE(tree.BulkLoad(&sorter, 75));
+  }
+  CheckKeys(&tree, n);
+
+  // Only an empty tree can be bulk loaded.
+  {
+    Sorter sorter(&bpm, comparator, 2);
+    AddKey(&sorter, n);
+    sorter.Sort();
+    EXPECT_FALSE(tree.BulkLoad(&sorter));
+  }
+
+  // The tree keeps working as usual: split, merge and shrink back to empty.
+  KeyType index_key;
+  for (int64_t key = n; key < n + 1000; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(key)));
+  }
+  CheckKeys(&tree, n + 1000);
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  for (int64_t key = n; key < n + 1000; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, ShapeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(64, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+
+  // Every input size up to a few levels, so that the last page of each level is short in every possible way.
+  for (int fill_factor : {50, 100}) {
+    for (int64_t n = 0; n < 150; n++) {
+      Tree tree("foo_pk", &bpm, comparator, 3, 3, header_page_id);
+      {
+        Sorter sorter(&bpm, comparator, 2);
+        for (int64_t key = n - 1; key >= 0; key--) {
+          AddKey(&sorter, key);
+        }
+        sorter.Sort();
+        ASSERT_TRUE(tree.BulkLoad(&sorter, fill_factor));
+      }
+      CheckKeys(&tree, n);
+      // Removing everything goes through every underflow case, which needs a well-formed tree.
+      KeyType index_key;
+      for (int64_t key = 0; key < n; key++) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      EXPECT_TRUE(tree.IsEmpty());
+    }
+  }
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, CatalogCreateIndexTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(32, &disk_manager);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Transaction txn(0);
+  std::vector<Column> columns{{"k", TypeId::BIGINT}, {"v", TypeId::INTEGER}};
+  Schema schema(columns);
+  auto *table_info = catalog.CreateTable(&txn, "t", schema);
+  const int64_t n = 3000;
+  for (int64_t i = 0; i < n; i++) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue((i * 7919) % n),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(i))};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  }
+
+  std::vector<Column> key_columns{{"k", TypeId::BIGINT}};
+  Schema key_schema(key_columns);
+  BulkLoadOptions options;
+  options.sort_buffer_pages_ = 2;
+  auto *index_info = catalog.CreateIndex<KeyType, RID, GenericComparator<8>>(
+      &txn, "t_k", "t", schema, key_schema, {0}, 8, HashFunction<KeyType>{}, IndexType::BPlusTree, options);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  std::vector<RID> rids;
+  for (int64_t k = 0; k < n; k++) {
+    rids.clear();
+    Tuple key({ValueFactory::GetBigIntValue(k)}, &key_schema);
+    index_info->index_->ScanKey(key, &rids, &txn);
+    ASSERT_EQ(1, rids.size());
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &tuple, &txn));
+    EXPECT_EQ(k, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+  }
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, ParallelCreateIndexTest) {
+  // Every kind of index built by four workers, the B+ tree from runs that each worker spills on its own.
+  std::vector<Column> columns{{"k", TypeId::BIGINT}, {"v", TypeId::INTEGER}};
+  Schema schema(columns);
+  std::vector<Column> key_columns{{"k", TypeId::BIGINT}};
+  Schema key_schema(key_columns);
+  BulkLoadOptions options;
+  options.sort_buffer_pages_ = 8;
+  options.num_workers_ = 4;
+  for (auto index_type : {IndexType::BPlusTree, IndexType::BLinkTree, IndexType::ExtendibleHash}) {
+    DiskManager disk_manager("test.db");
+    BufferPoolManagerInstance bpm(64, &disk_manager);
+    Catalog catalog(&bpm, nullptr, nullptr);
+    Transaction txn(0);
+    const int64_t n = 20000;
+    auto *table_info = CreateTable(&catalog, &txn, schema, n);
+    ASSERT_LE(4 * Catalog::MIN_BUILD_PAGES_PER_WORKER, table_info->table_->GetPageIds().size());
+    auto *index_info = catalog.CreateIndex<KeyType, RID, GenericComparator<8>>(
+        &txn, "t_k", "t", schema, key_schema, {0}, 8, HashFunction<KeyType>{}, index_type, options);
+    ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+    std::vector<RID> rids;
+    for (int64_t k = 0; k < n; k++) {
+      rids.clear();
+      Tuple key({ValueFactory::GetBigIntValue(k)}, &key_schema);
+      index_info->index_->ScanKey(key, &rids, &txn);
+      ASSERT_EQ(1, rids.size());
+      Tuple tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &tuple, &txn));
+      EXPECT_EQ(k, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+    }
+
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeBulkLoadTest, ParallelCreateIndexLockTest) {
+  // The workers read the rows on behalf of the transaction that builds the index, which ends up holding their locks.
+  std::vector<Column> columns{{"k", TypeId::BIGINT}, {"v", TypeId::INTEGER}};
+  Schema schema(columns);
+  std::vector<Column> key_columns{{"k", TypeId::BIGINT}};
+  Schema key_schema(key_columns);
+  BulkLoadOptions options;
+  options.num_workers_ = 4;
+  for (auto index_type : {IndexType::BPlusTree, IndexType::BLinkTree, IndexType::ExtendibleHash}) {
+    DiskManager disk_manager("test.db");
+    BufferPoolManagerInstance bpm(64, &disk_manager);
+    LockManager lock_manager;
+    Catalog catalog(&bpm, &lock_manager, nullptr);
+    Transaction txn(0);
+    const int64_t n = 20000;
+    auto *table_info = CreateTable(&catalog, &txn, schema, n);
+    ASSERT_LE(4 * Catalog::MIN_BUILD_PAGES_PER_WORKER, table_info->table_->GetPageIds().size());
+    enable_logging = true;
+    auto *index_info = catalog.CreateIndex<KeyType, RID, GenericComparator<8>>(
+        &txn, "t_k", "t", schema, key_schema, {0}, 8, HashFunction<KeyType>{}, index_type, options);
+    enable_logging = false;
+    ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+    EXPECT_EQ(TransactionState::GROWING, txn.GetState());
+    EXPECT_EQ(n, txn.GetSharedLockSet()->size());
+    for (auto iterator = table_info->table_->Begin(&txn); iterator != table_info->table_->End(); ++iterator) {
+      EXPECT_TRUE(txn.IsSharedLocked(iterator->GetRid()));
+    }
+
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+}  // namespace bustub
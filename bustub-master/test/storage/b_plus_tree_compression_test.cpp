@@ -0,0 +1,254 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compression_test.cpp
+//
+// Identification: test/storage/b_plus_tree_compression_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Make the key of a single VARCHAR column; the strings share a long prefix, like many real keys. */
+template <size_t KeySize>
+auto MakeKey(Schema *schema, int64_t i, const char *suffix = "x") -> GenericKey<KeySize> {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "customer-%06ld-%s", static_cast<long>(i), suffix);  // NOLINT
+  GenericKey<KeySize> key;
+  key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(buffer)}, schema), schema);
+  return key;
+}
+
+/** Check that the tree holds exactly the keys [0, n), each with its own RID, in order. */
+template <size_t KeySize>
+void CheckKeys(BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *tree, Schema *schema, int64_t n) {
+  int64_t expected = 0;
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.Get());
+    expected++;
+  }
+  EXPECT_EQ(n, expected);
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < n; i++) {
+    rids.clear();
+    ASSERT_TRUE(tree->GetValue(MakeKey<KeySize>(schema, i), &rids));
+    EXPECT_EQ(i, rids[0].Get());
+    // Keys between two stored ones find neither, and a scan from them starts at the next one.
+    EXPECT_FALSE(tree->GetValue(MakeKey<KeySize>(schema, i, "w"), &rids));
+    auto iterator = tree->Begin(MakeKey<KeySize>(schema, i, "w"));
+    ASSERT_FALSE(iterator == tree->End());
+    EXPECT_EQ(i, (*iterator).second.Get());
+  }
+}
+
+/** Walk the tree level by level. @return the number of children per page on each internal level, root first */
+auto GetFanOuts(BufferPoolManager *bpm, page_id_t header_page_id, const std::string &name) -> std::vector<double> {
+  auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(header_page_id)->GetData());
+  page_id_t root_id;
+  EXPECT_TRUE(header_page->GetRootId(name, &root_id));
+  bpm->UnpinPage(header_page_id, false);
+
+  std::vector<double> fan_outs;
+  std::vector<page_id_t> level{root_id};
+  while (true) {
+    std::vector<page_id_t> children;
+    bool leaves = false;
+    for (auto page_id : level) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+      leaves = node->IsLeafPage();
+      if (!leaves) {
+        auto *internal = reinterpret_cast<BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>> *>(
+            node);
+        for (int i = 0; i < internal->GetSize(); i++) {
+          children.push_back(internal->ValueAt(i));
+        }
+      }
+      bpm->UnpinPage(page_id, false);
+    }
+    if (leaves) {
+      return fan_outs;
+    }
+    fan_outs.push_back(static_cast<double>(children.size()) / level.size());
+    level = std::move(children);
+  }
+}
+
+}  // namespace
+
+TEST(BPlusTreeCompressionTest, FanOutTest) {
+  auto key_schema = ParseCreateStatement("a varchar(30)");
+  GenericComparator<64> comparator(key_schema.get());
+  ASSERT_TRUE(comparator.IsNormalized());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(100, &disk_manager);
+  // The tree keeps its root in the header page, which is the first page allocated; pages have their default sizes.
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  bpm.UnpinPage(header_page_id, true);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", &bpm, comparator);
+
+  const int64_t n = 20000;
+  std::vector<int64_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+  for (auto i : order) {
+    EXPECT_TRUE(tree.Insert(MakeKey<64>(key_schema.get(), i), RID(i)));
+  }
+  CheckKeys(&tree, key_schema.get(), n);
+
+  // Uncompressed, an internal page holds (PAGE_SIZE - 24) / (64 + 4) = 59 children of 64-byte keys.
+  auto fan_outs = GetFanOuts(&bpm, header_page_id, "foo_pk");
+  std::cout << "height " << fan_outs.size() + 1 << ", children per internal page by level:";
+  for (auto fan_out : fan_outs) {
+    std::cout << " " << fan_out;
+  }
+  std::cout << std::endl;
+  ASSERT_FALSE(fan_outs.empty());
+  EXPECT_GT(fan_outs.back(), 59);
+
+  for (auto i : order) {
+    tree.Remove(MakeKey<64>(key_schema.get(), i));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeCompressionTest, SmallPageTest) {
+  // Tiny pages split and merge all the time, moving the fences and their common prefixes around.
+  auto key_schema = ParseCreateStatement("a varchar(30)");
+  GenericComparator<64> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(50, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", &bpm, comparator, 3, 4, header_page_id);
+
+  const int64_t n = 2000;
+  std::vector<int64_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+  for (auto i : order) {
+    EXPECT_TRUE(tree.Insert(MakeKey<64>(key_schema.get(), i), RID(i)));
+  }
+  CheckKeys(&tree, key_schema.get(), n);
+  // Remove the upper half, then put it back.
+  for (auto i : order) {
+    if (i >= n / 2) {
+      tree.Remove(MakeKey<64>(key_schema.get(), i));
+    }
+  }
+  CheckKeys(&tree, key_schema.get(), n / 2);
+  for (auto i : order) {
+    if (i >= n / 2) {
+      EXPECT_TRUE(tree.Insert(MakeKey<64>(key_schema.get(), i), RID(i)));
+    }
+  }
+  CheckKeys(&tree, key_schema.get(), n);
+  for (auto i : order) {
+    tree.Remove(MakeKey<64>(key_schema.get(), i));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeCompressionTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a varchar(30)");
+  GenericComparator<64> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(100, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", &bpm, comparator, 8, 8, header_page_id);
+
+  const int64_t n = 4000;
+  const int num_threads = 4;
+  auto run = [&](bool insert) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        for (int64_t i = t; i < n; i += num_threads) {
+          if (insert) {
+            tree.Insert(MakeKey<64>(key_schema.get(), i), RID(i));
+          } else if (i % 2 == 1) {
+            tree.Remove(MakeKey<64>(key_schema.get(), i));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  };
+  run(true);
+  CheckKeys(&tree, key_schema.get(), n);
+  run(false);
+  int64_t expected = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.Get());
+    expected += 2;
+  }
+  EXPECT_EQ(n, expected);
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeCompressionTest, UnnormalizedTest) {
+  // The longest string does not fit normalized into 64 bytes, so keys are compared by value and only their trailing
+  // zero bytes are dropped.
+  auto key_schema = ParseCreateStatement("a varchar(40)");
+  GenericComparator<64> comparator(key_schema.get());
+  ASSERT_FALSE(comparator.IsNormalized());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(50, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", &bpm, comparator, 3, 4, header_page_id);
+
+  const int64_t n = 1000;
+  std::vector<int64_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+  for (auto i : order) {
+    EXPECT_TRUE(tree.Insert(MakeKey<64>(key_schema.get(), i), RID(i)));
+  }
+  CheckKeys(&tree, key_schema.get(), n);
+  for (auto i : order) {
+    tree.Remove(MakeKey<64>(key_schema.get(), i));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -100,7 +100,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -152,7 +152,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -203,7 +203,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -245,7 +245,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -288,7 +288,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -333,4 +333,69 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+// helper function for the mixed workload: every thread owns the keys k with (k / 2) % total_threads == thread_itr.
+// It inserts the odd key k + 1, looks it up, and removes the even key k when (k / 2) % 3 == 0.
+void MixedHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, int64_t num_keys, int total_threads,
+                 uint64_t thread_itr) {
+  GenericKey<8> index_key;
+  RID rid;
+  std::vector<RID> rids;
+  Transaction *transaction = new Transaction(0);
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    if (static_cast<uint64_t>(key / 2) % total_threads != thread_itr) {
+      continue;
+    }
+    rid.Set(0, key + 1);
+    index_key.SetFromInteger(key + 1);
+    EXPECT_TRUE(tree->Insert(index_key, rid, transaction));
+    rids.clear();
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+    if ((key / 2) % 3 == 0) {
+      index_key.SetFromInteger(key);
+      tree->Remove(index_key, transaction);
+    }
+  }
+  delete transaction;
+}
+
+TEST(BPlusTreeConcurrentTest, MixedTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 2000;
+
+  for (int num_threads : {1, 4}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    // small pages, so that splits and merges happen all the time
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 16, 16);
+
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; key += 2) {
+      keys.push_back(key);
+    }
+    InsertHelper(&tree, keys);
+    LaunchParallelTest(num_threads, MixedHelper, &tree, num_keys, num_threads);
+
+    int64_t expected = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      while (expected % 2 == 0 && (expected / 2) % 3 == 0) {
+        expected++;
+      }
+      ASSERT_EQ(expected, (*iterator).first.ToString());
+      EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+      expected++;
+    }
+    EXPECT_EQ(num_keys, expected);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
 }  // namespace bustub
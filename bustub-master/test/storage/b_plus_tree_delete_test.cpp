@@ -20,7 +20,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -73,8 +73,10 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   std::vector<int64_t> remove_keys = {1, 5};
   for (auto key : remove_keys) {
     index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
+    EXPECT_TRUE(tree.Remove(index_key, transaction));
   }
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(tree.Remove(index_key, transaction));
 
   start_key = 2;
   current_key = start_key;
@@ -98,7 +100,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
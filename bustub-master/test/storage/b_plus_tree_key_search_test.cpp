@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_key_search_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/key_search.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+const std::vector<std::pair<KeySearchKernel, std::string>> KERNELS{
+    {KeySearchKernel::SCALAR, "scalar"}, {KeySearchKernel::SSE42, "sse4.2"}, {KeySearchKernel::AVX2, "avx2"}};
+
+}  // namespace
+
+TEST(BPlusTreeKeySearchTest, KernelTest) {
+  std::mt19937_64 rng(15445);
+  KeySearchKernel original = KeySearch::GetKernel();
+  for (const auto &[kernel, kernel_name] : KERNELS) {
+    if (!KeySearch::SetKernel(kernel)) {
+      continue;
+    }
+    for (int size = 0; size < 200; size++) {
+      // Few distinct prefixes make for long runs of ties; include the extremes of the unsigned range.
+      std::vector<uint64_t> prefixes(size);
+      for (auto &prefix : prefixes) {
+        uint64_t pick = rng() % 8;
+        prefix = pick == 0 ? 0 : pick == 7 ? ~uint64_t{0} : pick << 61;
+      }
+      std::sort(prefixes.begin(), prefixes.end());
+      for (uint64_t pick = 0; pick < 8; pick++) {
+        for (uint64_t target : {pick << 61, (pick << 61) + 1, ~uint64_t{0} - pick}) {
+          EXPECT_EQ(std::lower_bound(prefixes.begin(), prefixes.end(), target) - prefixes.begin(),
+                    KeySearch::LowerBound(prefixes.data(), size, target))
+              << kernel_name << " size " << size << " target " << target;
+          EXPECT_EQ(std::upper_bound(prefixes.begin(), prefixes.end(), target) - prefixes.begin(),
+                    KeySearch::UpperBound(prefixes.data(), size, target))
+              << kernel_name << " size " << size << " target " << target;
+        }
+      }
+    }
+  }
+  KeySearch::SetKernel(original);
+}
+
+TEST(BPlusTreeKeySearchTest, PrefixTieTest) {
+  // 16-byte keys whose first column repeats, so most searches end in a full comparison among equal prefixes.
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+  ASSERT_TRUE(comparator.IsNormalized());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(50, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", &bpm, comparator, 16, 8, header_page_id);
+
+  auto make_key = [&](int64_t i) {
+    GenericKey<16> key;
+    std::vector<Value> values{ValueFactory::GetBigIntValue(i / 7), ValueFactory::GetBigIntValue(-i)};
+    key.SetFromKey(Tuple(values, key_schema.get()), key_schema.get());
+    return key;
+  };
+  std::vector<int64_t> order(2000);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+  for (auto i : order) {
+    EXPECT_TRUE(tree.Insert(make_key(i), RID(i)));
+  }
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 2000; i++) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(make_key(i), &rids));
+    EXPECT_EQ(i, rids[0].Get());
+  }
+  EXPECT_FALSE(tree.GetValue(make_key(2000), &rids));
+  // Within a run of equal first columns the second one descends: 699, 698, ..., 693, then 706.
+  int64_t count = 0;
+  for (auto iterator = tree.Begin(make_key(699)); iterator != tree.End() && count < 8; ++iterator) {
+    EXPECT_EQ(count < 7 ? 699 - count : 706, (*iterator).second.Get());
+    count++;
+  }
+  EXPECT_EQ(8, count);
+  for (auto i : order) {
+    tree.Remove(make_key(i));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
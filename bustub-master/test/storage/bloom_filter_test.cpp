@@ -0,0 +1,245 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/storage/bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <future>  // NOLINT
+#include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "storage/index/bloom_filter.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto Hash(int64_t key) -> uint64_t { return HashFunction<int64_t>().GetHash(key); }
+
+/**
+ * Insert, remove and re-insert rows of an indexed table with a Bloom filter, checking the lookups of present and
+ * missing keys along the way, with ScanKey and ScanKeys.
+ */
+void CheckFilteredIndex(IndexType index_type) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(64, &disk_manager);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Transaction txn(0);
+  std::vector<Column> columns{{"k", TypeId::BIGINT}};
+  Schema schema(columns);
+  catalog.CreateTable(&txn, "t", schema);
+
+  const int64_t n = 2000;
+  auto key = [&](int64_t k) { return Tuple(std::vector<Value>{ValueFactory::GetBigIntValue(k)}, &schema); };
+  std::set<int64_t> present;
+  for (int64_t k = 0; k < n; k += 2) {
+    present.insert(k);
+  }
+  BulkLoadOptions options;
+  options.bloom_filter_bits_per_key_ = 10;
+  // the index is built over an empty table and filled through InsertEntry()
+  auto *index_info = catalog.CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "t_k", "t", schema, schema, {0}, 8, HashFunction<GenericKey<8>>{}, index_type, options);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+  for (auto k : present) {
+    index->InsertEntry(key(k), RID(k), &txn);
+  }
+
+  auto check = [&] {
+    std::vector<Tuple> keys;
+    for (int64_t k = 0; k < n; k++) {
+      keys.push_back(key(k));
+    }
+    std::vector<std::vector<RID>> results;
+    index->ScanKeys(keys, &results, &txn);
+    ASSERT_EQ(keys.size(), results.size());
+    for (int64_t k = 0; k < n; k++) {
+      std::vector<RID> result;
+      index->ScanKey(keys[k], &result, &txn);
+      std::vector<RID> expected;
+      if (present.count(k) != 0) {
+        expected.emplace_back(k);
+      }
+      ASSERT_EQ(expected, result) << "key " << k;
+      ASSERT_EQ(expected, results[k]) << "key " << k;
+    }
+  };
+  check();
+
+  // removing most keys makes the filter stale, and adding them back grows it past its first size
+  for (int64_t k = 0; k < n; k += 2) {
+    if (k % 10 != 0) {
+      index->DeleteEntry(key(k), RID(k), &txn);
+      present.erase(k);
+    }
+  }
+  check();
+  for (int64_t k = 1; k < n; k += 2) {
+    index->InsertEntry(key(k), RID(k), &txn);
+    present.insert(k);
+  }
+  check();
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace
+
+TEST(BloomFilterTest, FalsePositiveTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(16, &disk_manager);
+  const int64_t n = 20000;
+  BloomFilter filter(&bpm, 10, [&](const std::function<void(uint64_t)> &add) {
+    for (int64_t key = 0; key < n; key++) {
+      add(Hash(key));
+    }
+  });
+  EXPECT_EQ(1, filter.GetBuildCount());
+  EXPECT_EQ((n * 10 + PAGE_SIZE * 8 - 1) / (PAGE_SIZE * 8), filter.GetPageCount());
+
+  for (int64_t key = 0; key < n; key++) {
+    ASSERT_TRUE(filter.MayContain(Hash(key))) << "key " << key;
+  }
+  int64_t false_positives = 0;
+  for (int64_t key = n; key < 11 * n; key++) {
+    false_positives += filter.MayContain(Hash(key)) ? 1 : 0;
+  }
+  // about 1% for 10 bits per key, depending on how the rounding up to whole pages left the filter
+  EXPECT_LT(false_positives, 10 * n * 3 / 100);
+  EXPECT_EQ(1, filter.GetBuildCount());
+
+  remove("test.db");
+}
+
+TEST(BloomFilterTest, RebuildTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(16, &disk_manager);
+  std::set<int64_t> keys;
+  BloomFilter filter(&bpm, 10, [&](const std::function<void(uint64_t)> &add) {
+    for (auto key : keys) {
+      add(Hash(key));
+    }
+  });
+  EXPECT_EQ(1, filter.GetPageCount());
+
+  // growing far past the size of an empty filter makes it stale, and the background thread rebuilds it
+  const int64_t n = 10000;
+  for (int64_t key = 0; key < n; key++) {
+    keys.insert(key);
+    filter.Add(Hash(key));
+  }
+  filter.WaitForRebuild();
+  size_t builds = filter.GetBuildCount();
+  EXPECT_LE(2, builds);
+  EXPECT_TRUE(filter.MayContain(Hash(0)));
+  size_t pages = filter.GetPageCount();
+  EXPECT_LT(1, pages);
+
+  // so does removing more than half of the keys, after which the removed keys are gone from the filter
+  int64_t removed = 0;
+  for (int64_t key = 0; key < n; key += 4, removed++) {
+    keys.erase(key);
+    filter.NoteRemove();
+  }
+  filter.WaitForRebuild();
+  EXPECT_EQ(builds, filter.GetBuildCount());
+  int64_t last_removed = 1;
+  for (; 2 * removed <= n; last_removed += 2, removed++) {
+    keys.erase(last_removed);
+    filter.NoteRemove();
+  }
+  filter.WaitForRebuild();
+  EXPECT_EQ(builds + 1, filter.GetBuildCount());
+  EXPECT_GE(pages, filter.GetPageCount());
+  int64_t false_positives = 0;
+  for (int64_t key = 1; key < last_removed; key += 2) {
+    false_positives += filter.MayContain(Hash(key)) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, last_removed / 2 * 3 / 100);
+
+  remove("test.db");
+}
+
+TEST(BloomFilterTest, BackgroundRebuildTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(16, &disk_manager);
+  std::mutex keys_latch;
+  std::set<int64_t> keys;
+  const int64_t n = 1000;
+  for (int64_t key = 0; key < n; key++) {
+    keys.insert(key);
+  }
+  // every scan but the first one waits for the test to let it go
+  std::atomic<int> scans{0};
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  BloomFilter filter(&bpm, 10, [&](const std::function<void(uint64_t)> &add) {
+    if (scans++ > 0) {
+      released.wait();
+    }
+    std::lock_guard<std::mutex> guard(keys_latch);
+    for (auto key : keys) {
+      add(Hash(key));
+    }
+  });
+  EXPECT_FALSE(filter.MayContain(Hash(n)) && filter.MayContain(Hash(n + 1)) && filter.MayContain(Hash(n + 2)));
+
+  // the removal that makes the filter stale returns while the rebuild is stuck in its scan, and lookups bypass the
+  // filter meanwhile
+  int64_t removed = 0;
+  for (int64_t key = 0; 2 * removed <= n; key += 2, removed++) {
+    {
+      std::lock_guard<std::mutex> guard(keys_latch);
+      keys.erase(key);
+    }
+    filter.NoteRemove();
+  }
+  EXPECT_TRUE(filter.MayContain(Hash(n)));
+  EXPECT_TRUE(filter.MayContain(Hash(n + 1)));
+  EXPECT_TRUE(filter.MayContain(Hash(n + 2)));
+  EXPECT_EQ(1, filter.GetBuildCount());
+
+  // a key added after the scan went past it makes it into the fresh filter
+  while (scans < 2) {
+    std::this_thread::yield();
+  }
+  filter.Add(Hash(2 * n));
+  release.set_value();
+  filter.WaitForRebuild();
+  EXPECT_EQ(2, filter.GetBuildCount());
+  EXPECT_TRUE(filter.MayContain(Hash(2 * n)));
+  int64_t false_positives = 0;
+  for (int64_t key = 0; key < n; key++) {
+    if (keys.count(key) != 0) {
+      ASSERT_TRUE(filter.MayContain(Hash(key))) << "key " << key;
+    } else {
+      false_positives += filter.MayContain(Hash(key)) ? 1 : 0;
+    }
+  }
+  EXPECT_LT(false_positives, removed * 3 / 100);
+
+  remove("test.db");
+}
+
+TEST(BloomFilterTest, BPlusTreeIndexTest) { CheckFilteredIndex(IndexType::BPlusTree); }
+
+TEST(BloomFilterTest, ExtendibleHashIndexTest) { CheckFilteredIndex(IndexType::ExtendibleHash); }
+
+}  // namespace bustub
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Compare two tuples column by column through Value, the way the fallback comparator does. */
+auto CompareValues(const Tuple &lhs, const Tuple &rhs, const Schema *schema) -> int {
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    Value l = lhs.GetValue(schema, i);
+    Value r = rhs.GetValue(schema, i);
+    if (l.CompareLessThan(r) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (l.CompareGreaterThan(r) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** Check that normalized keys order every pair of tuples like their values, and decode back to them. */
+template <size_t KeySize>
+void CheckOrder(const std::vector<Tuple> &tuples, Schema *schema) {
+  GenericComparator<KeySize> comparator(schema);
+  ASSERT_TRUE(comparator.IsNormalized());
+  std::vector<GenericKey<KeySize>> keys(tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++) {
+    keys[i].SetFromKey(tuples[i], schema);
+    for (uint32_t c = 0; c < schema->GetColumnCount(); c++) {
+      EXPECT_EQ(CmpBool::CmpTrue, keys[i].ToValue(schema, c).CompareEquals(tuples[i].GetValue(schema, c)));
+    }
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    for (size_t j = 0; j < tuples.size(); j++) {
+      ASSERT_EQ(CompareValues(tuples[i], tuples[j], schema), comparator(keys[i], keys[j]))
+          << tuples[i].ToString(schema) << " vs " << tuples[j].ToString(schema);
+    }
+  }
+}
+
+/** The comparison on raw keys as it was before normalization: deserialize each column and compare Values. */
+template <size_t KeySize>
+auto ValueCompare(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs, const Schema *schema) -> int {
+  auto deserialize = [schema](const GenericKey<KeySize> &key, uint32_t i) {
+    const auto &col = schema->GetColumn(i);
+    const char *data = key.data_ + col.GetOffset();
+    if (!col.IsInlined()) {
+      data = key.data_ + *reinterpret_cast<const int32_t *>(data);
+    }
+    return Value::DeserializeFrom(data, col.GetType());
+  };
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    Value l = deserialize(lhs, i);
+    Value r = deserialize(rhs, i);
+    if (l.CompareLessThan(r) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (l.CompareGreaterThan(r) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+TEST(GenericKeyTest, IntegerOrderTest) {
+  auto schema = ParseCreateStatement("a tinyint,b smallint,c integer,d bigint");
+  std::mt19937_64 rng(15445);
+  std::vector<int64_t> edges{-2, -1, 0, 1, 2, 127, -127, 32767, -32767};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    auto pick = [&](int64_t bound) {
+      return i < static_cast<int>(edges.size()) ? std::max(-bound, std::min(bound, edges[i]))
+                                                 : static_cast<int64_t>(rng() % (2 * bound + 1)) - bound;
+    };
+    std::vector<Value> values{ValueFactory::GetTinyIntValue(static_cast<int8_t>(pick(2))),
+                              ValueFactory::GetSmallIntValue(static_cast<int16_t>(pick(32767))),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(pick(2147483647))),
+                              ValueFactory::GetBigIntValue(static_cast<int64_t>(rng()) / 2)};
+    tuples.emplace_back(values, schema.get());
+  }
+  CheckOrder<16>(tuples, schema.get());
+}
+
+TEST(GenericKeyTest, DecimalOrderTest) {
+  auto schema = ParseCreateStatement("a double");
+  std::vector<Tuple> tuples;
+  for (double d : {-1e300, -2.5, -1.0, -0.5, 0.0, 1e-300, 0.5, 1.0, 3.25, 1e300}) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetDecimalValue(d)}, schema.get());
+  }
+  CheckOrder<8>(tuples, schema.get());
+}
+
+TEST(GenericKeyTest, VarcharOrderTest) {
+  auto schema = ParseCreateStatement("a varchar(8),b integer");
+  std::vector<Tuple> tuples;
+  std::vector<std::string> strings{"", "a", "ab", "abc", "b", "ba", "zzzzzzzz", std::string("a\0b", 3),
+                                   std::string("\0", 1)};
+  for (const auto &str : strings) {
+    for (int32_t b : {-1, 0, 7}) {
+      tuples.emplace_back(std::vector<Value>{ValueFactory::GetVarcharValue(str), ValueFactory::GetIntegerValue(b)},
+                          schema.get());
+    }
+  }
+  CheckOrder<32>(tuples, schema.get());
+}
+
+TEST(GenericKeyTest, FallbackTest) {
+  // Too long to fit normalized in 32 bytes, and a string without a declared length.
+  auto wide = ParseCreateStatement("a varchar(16)");
+  EXPECT_FALSE(GenericKey<32>::IsNormalizable(wide.get()));
+  EXPECT_TRUE(GenericKey<64>::IsNormalizable(wide.get()));
+  Schema unbounded(std::vector<Column>{Column("a", TypeId::VARCHAR, uint32_t{0})});
+  EXPECT_FALSE(GenericKey<64>::IsNormalizable(&unbounded));
+
+  GenericComparator<32> comparator(wide.get());
+  EXPECT_FALSE(comparator.IsNormalized());
+  GenericKey<32> lhs;
+  GenericKey<32> rhs;
+  lhs.SetFromKey(Tuple({ValueFactory::GetVarcharValue("apple")}, wide.get()), wide.get());
+  rhs.SetFromKey(Tuple({ValueFactory::GetVarcharValue("banana")}, wide.get()), wide.get());
+  EXPECT_EQ(-1, comparator(lhs, rhs));
+  EXPECT_EQ(1, comparator(rhs, lhs));
+  EXPECT_EQ(0, comparator(lhs, lhs));
+}
+
+}  // namespace bustub
@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_batch_lookup_test.cpp
+//
+// Identification: test/storage/index_batch_lookup_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using KeyType = GenericKey<8>;
+
+namespace {
+
+/**
+ * Fill a table with rows (k, i) whose keys k are the even numbers below 2 * num_rows, in scrambled order, and index
+ * the keys with an index of the given type.
+ */
+auto CreateIndexedTable(Catalog *catalog, Transaction *txn, int64_t num_rows, IndexType index_type) -> IndexInfo * {
+  std::vector<Column> columns{{"k", TypeId::BIGINT}, {"v", TypeId::INTEGER}};
+  Schema schema(columns);
+  auto *table_info = catalog->CreateTable(txn, "t", schema);
+  for (int64_t i = 0; i < num_rows; i++) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue(2 * ((i * 7919) % num_rows)),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(i))};
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, txn));
+  }
+  std::vector<Column> key_columns{{"k", TypeId::BIGINT}};
+  Schema key_schema(key_columns);
+  return catalog->CreateIndex<KeyType, RID, GenericComparator<8>>(txn, "t_k", "t", schema, key_schema, {0}, 8,
+                                                                   HashFunction<KeyType>{}, index_type);
+}
+
+/** @return a batch of random keys below 2 * num_rows, half of them missing from the table, some of them repeated */
+auto RandomKeys(const Schema &key_schema, int64_t num_rows, size_t batch_size, std::mt19937 *rng)
+    -> std::vector<Tuple> {
+  std::vector<Tuple> keys;
+  for (size_t i = 0; i < batch_size; i++) {
+    keys.emplace_back(std::vector<Value>{ValueFactory::GetBigIntValue((*rng)() % (2 * num_rows))}, &key_schema);
+  }
+  return keys;
+}
+
+void CheckBatchLookups(IndexType index_type) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(256, &disk_manager);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Transaction txn(0);
+  const int64_t num_rows = 5000;
+  auto *index_info = CreateIndexedTable(&catalog, &txn, num_rows, index_type);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *table_info = catalog.GetTable("t");
+
+  std::vector<std::vector<RID>> results;
+  index_info->index_->ScanKeys({}, &results, &txn);
+  EXPECT_TRUE(results.empty());
+
+  std::mt19937 rng(15445);
+  for (size_t batch_size : {1, 7, 100, 3000}) {
+    auto keys = RandomKeys(index_info->key_schema_, num_rows, batch_size, &rng);
+    index_info->index_->ScanKeys(keys, &results, &txn);
+    ASSERT_EQ(keys.size(), results.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      int64_t key = keys[i].GetValue(&index_info->key_schema_, 0).GetAs<int64_t>();
+      std::vector<RID> expected;
+      index_info->index_->ScanKey(keys[i], &expected, &txn);
+      ASSERT_EQ(expected, results[i]) << "key " << key;
+      ASSERT_EQ(key % 2 == 0 ? 1U : 0U, results[i].size()) << "key " << key;
+      if (!results[i].empty()) {
+        Tuple tuple;
+        ASSERT_TRUE(table_info->table_->GetTuple(results[i][0], &tuple, &txn));
+        EXPECT_EQ(key, tuple.GetValue(&table_info->schema_, 0).GetAs<int64_t>());
+      }
+    }
+  }
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace
+
+TEST(IndexBatchLookupTest, BPlusTreeTest) { CheckBatchLookups(IndexType::BPlusTree); }
+
+TEST(IndexBatchLookupTest, DeepBPlusTreeTest) {
+  // tiny pages, so that a batch shares descents through many levels and many groups of children
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(64, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  BPlusTree<KeyType, RID, GenericComparator<8>> tree("foo_pk", &bpm, comparator, 4, 4, header_page_id);
+
+  std::vector<KeyType> keys(4000);
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(keys, &results);
+  EXPECT_EQ(std::vector<std::vector<RID>>(keys.size()), results);
+
+  std::vector<int64_t> inserted(keys.size() / 2);
+  std::iota(inserted.begin(), inserted.end(), 0);
+  std::shuffle(inserted.begin(), inserted.end(), std::mt19937(15445));
+  for (auto key : inserted) {
+    KeyType index_key;
+    index_key.SetFromInteger(2 * key);
+    tree.Insert(index_key, RID(2 * key));
+  }
+  std::mt19937 rng(0);
+  std::vector<int64_t> values(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    values[i] = rng() % keys.size();
+    keys[i].SetFromInteger(values[i]);
+  }
+  tree.GetValues(keys, &results);
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RID> expected;
+    if (values[i] % 2 == 0) {
+      expected.emplace_back(values[i]);
+    }
+    ASSERT_EQ(expected, results[i]) << "key " << values[i];
+  }
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(IndexBatchLookupTest, SmallBufferPoolTest) {
+  // the children of every page on the way cannot all stay pinned at once, so a batch takes several descents
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(16, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  BPlusTree<KeyType, RID, GenericComparator<8>> tree("foo_pk", &bpm, comparator, 4, 16, header_page_id);
+
+  const int64_t n = 2000;
+  std::vector<KeyType> keys(n);
+  for (int64_t key = 0; key < n; key++) {
+    keys[key].SetFromInteger(key);
+    if (key % 2 == 0) {
+      ASSERT_TRUE(tree.Insert(keys[key], RID(key)));
+    }
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(keys, &results);
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RID> expected;
+    tree.GetValue(keys[i], &expected);
+    ASSERT_EQ(expected, results[i]);
+  }
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(IndexBatchLookupTest, ExtendibleHashTest) { CheckBatchLookups(IndexType::ExtendibleHash); }
+
+TEST(IndexBatchLookupTest, DefaultTest) {
+  // the B-link tree has no batch lookup of its own and looks the keys up one at a time
+  CheckBatchLookups(IndexType::BLinkTree);
+}
+
+}  // namespace bustub
@@ -0,0 +1,253 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree_test.cpp
+//
+// Identification: test/storage/lsm_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/lsm_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using KeyType = GenericKey<8>;
+using Tree = LsmTree<KeyType, RID, GenericComparator<8>>;
+
+namespace {
+
+auto MakeKey(int64_t key) -> KeyType {
+  KeyType index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+/** Check the tree against the expected pairs: every lookup, a full scan, and scans from some bounds. */
+void CheckTree(Tree *tree, const std::map<int64_t, int64_t> &expected, int64_t max_key) {
+  for (int64_t key = -2; key < max_key + 2; key++) {
+    std::vector<RID> result;
+    auto it = expected.find(key);
+    ASSERT_EQ(it != expected.end(), tree->GetValue(MakeKey(key), &result)) << "key " << key;
+    if (it != expected.end()) {
+      ASSERT_EQ(std::vector<RID>{RID(it->second)}, result) << "key " << key;
+    }
+  }
+
+  std::mt19937 rng(0);
+  for (int scan = 0; scan < 20; scan++) {
+    int64_t start = scan == 0 ? std::numeric_limits<int64_t>::min() : static_cast<int64_t>(rng() % (max_key + 1));
+    KeyType low = MakeKey(start);
+    auto it = expected.lower_bound(start);
+    size_t limit = scan % 2 == 0 ? expected.size() : 10;
+    size_t seen = 0;
+    tree->Scan(&low, [&](const KeyType &key, const RID &rid) {
+      EXPECT_NE(expected.end(), it);
+      if (it == expected.end()) {
+        return false;
+      }
+      EXPECT_EQ(it->first, key.ToString());
+      EXPECT_EQ(RID(it->second), rid);
+      ++it;
+      return ++seen < limit;
+    });
+    EXPECT_EQ(std::min(limit, static_cast<size_t>(std::distance(expected.lower_bound(start), expected.end()))), seen);
+  }
+}
+
+}  // namespace
+
+TEST(LsmTreeTest, InsertRemoveTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(64, &disk_manager);
+  // small memtables and levels, so that a few thousand writes go through several levels of merges
+  LsmTreeOptions options;
+  options.memtable_entries_ = 200;
+  options.level0_runs_ = 3;
+  options.size_ratio_ = 2;
+  Schema key_schema(std::vector<Column>{{"k", TypeId::BIGINT}});
+  Tree tree(&bpm, GenericComparator<8>(&key_schema), options);
+  std::map<int64_t, int64_t> expected;
+  CheckTree(&tree, expected, 10);
+
+  const int64_t n = 6000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < n; key++) {
+    keys.push_back(key);
+  }
+  std::mt19937 rng(15445);
+  for (int round = 0; round < 3; round++) {
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (auto key : keys) {
+      // a write of each key per round: values are replaced, keys removed and inserted again
+      if ((key + round) % 3 == 0) {
+        tree.Remove(MakeKey(key));
+        expected.erase(key);
+      } else {
+        tree.Insert(MakeKey(key), RID(key + round));
+        expected[key] = key + round;
+      }
+    }
+    // the entries are found in the memtables and runs alike, whether or not the background thread has caught up
+    CheckTree(&tree, expected, n);
+  }
+
+  tree.Flush();
+  auto run_counts = tree.GetRunCounts();
+  ASSERT_GE(run_counts.size(), 3);
+  EXPECT_LT(run_counts[0], options.level0_runs_);
+  for (size_t level = 1; level < run_counts.size(); level++) {
+    EXPECT_LE(run_counts[level], 1);
+  }
+  CheckTree(&tree, expected, n);
+
+  // removing every key leaves tombstones only, which the scans skip
+  for (auto key : keys) {
+    tree.Remove(MakeKey(key));
+  }
+  expected.clear();
+  tree.Flush();
+  CheckTree(&tree, expected, n);
+
+  remove("test.db");
+}
+
+TEST(LsmTreeTest, ConcurrentTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(64, &disk_manager);
+  LsmTreeOptions options;
+  options.memtable_entries_ = 500;
+  Schema key_schema(std::vector<Column>{{"k", TypeId::BIGINT}});
+  Tree tree(&bpm, GenericComparator<8>(&key_schema), options);
+  // Writers insert and remove the odd keys while the even keys are there all along, freezing memtables and making
+  // merges under the readers, which look up and scan the even keys.
+  const int64_t n = 20000;
+  const int num_writers = 2;
+  const int num_readers = 2;
+  for (int64_t key = 0; key < n; key += 2) {
+    tree.Insert(MakeKey(key), RID(key));
+  }
+  std::atomic<int> writers_left{num_writers};
+  std::atomic<int64_t> errors{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<int64_t> keys;
+      for (int64_t key = 2 * t + 1; key < n; key += 2 * num_writers) {
+        keys.push_back(key);
+      }
+      for (int round = 0; round < 3; round++) {
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(t + round));
+        for (auto key : keys) {
+          tree.Insert(MakeKey(key), RID(key));
+        }
+        for (auto key : keys) {
+          tree.Remove(MakeKey(key));
+        }
+      }
+      writers_left--;
+    });
+  }
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<RID> result;
+      while (writers_left > 0) {
+        for (int i = 0; i < 1000; i++) {
+          int64_t key = 2 * (rng() % (n / 2));
+          result.clear();
+          if (!tree.GetValue(MakeKey(key), &result) || !(result[0] == RID(key))) {
+            errors++;
+          }
+        }
+        int64_t expected = 0;
+        tree.Scan(nullptr, [&](const KeyType &key, const RID &rid) {
+          int64_t value = key.ToString();
+          if (value % 2 == 0) {
+            errors += value == expected ? 0 : 1;
+            expected = value + 2;
+          }
+          return true;
+        });
+        errors += expected == n ? 0 : 1;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, errors);
+
+  tree.Flush();
+  std::map<int64_t, int64_t> expected;
+  for (int64_t key = 0; key < n; key += 2) {
+    expected[key] = key;
+  }
+  CheckTree(&tree, expected, n);
+
+  remove("test.db");
+}
+
+TEST(LsmTreeTest, IndexTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance bpm(64, &disk_manager);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Transaction txn(0);
+  std::vector<Column> columns{{"k", TypeId::BIGINT}, {"v", TypeId::INTEGER}};
+  Schema schema(columns);
+  auto *table_info = catalog.CreateTable(&txn, "t", schema);
+  const int64_t n = 10000;
+  for (int64_t i = 0; i < n; i++) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue((i * 7919) % n - n / 2),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(i))};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+  }
+  std::vector<Column> key_columns{{"k", TypeId::BIGINT}};
+  Schema key_schema(key_columns);
+  auto *index_info = catalog.CreateIndex<KeyType, RID, GenericComparator<8>>(
+      &txn, "t_k", "t", schema, key_schema, {0}, 8, HashFunction<KeyType>{}, IndexType::LsmTree);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+
+  // the index was filled from the heap, and scans it in key order, negative keys first
+  std::vector<std::pair<Tuple, RID>> entries;
+  index->ScanEntries(nullptr, &entries, &txn);
+  ASSERT_EQ(n, entries.size());
+  for (int64_t i = 0; i < n; i++) {
+    int64_t key = entries[i].first.GetValue(&index_info->key_schema_, 0).GetAs<int64_t>();
+    ASSERT_EQ(i - n / 2, key);
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(entries[i].second, &tuple, &txn));
+    EXPECT_EQ(key, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+  }
+
+  Tuple key(std::vector<Value>{ValueFactory::GetBigIntValue(17)}, &key_schema);
+  std::vector<RID> result;
+  index->ScanKey(key, &result, &txn);
+  ASSERT_EQ(1, result.size());
+  index->DeleteEntry(key, result[0], &txn);
+  result.clear();
+  index->ScanKey(key, &result, &txn);
+  EXPECT_TRUE(result.empty());
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -14,6 +14,9 @@
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -21,6 +24,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +75,79 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, AppendInsertModeTest) {
+  Column col1{"thread", TypeId::INTEGER};
+  Column col2{"seq", TypeId::INTEGER};
+  Column col3{"payload", TypeId::VARCHAR, 64};
+  std::vector<Column> cols{col1, col2, col3};
+  Schema schema{cols};
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  Transaction setup_txn(0);
+  auto *table = new TableHeap(buffer_pool_manager, nullptr, nullptr, &setup_txn);
+  const uint32_t fill_factor = 80;
+  table->SetInsertMode(InsertMode::Append, 4, fill_factor);
+
+  const int num_threads = 8;
+  const int rows_per_thread = 500;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([table, &schema, t] {
+      Transaction txn(t + 1);
+      for (int i = 0; i < rows_per_thread; i++) {
+        std::vector<Value> values{ValueFactory::GetIntegerValue(t), ValueFactory::GetIntegerValue(i),
+                                  ValueFactory::GetVarcharValue(std::string(32, 'a' + t))};
+        RID rid;
+        ASSERT_TRUE(table->InsertTuple(Tuple(values, &schema), &rid, &txn));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every row is there, each page holds the rows of a single thread, and every thread's rows are in insertion order.
+  std::unordered_map<page_id_t, std::unordered_set<int32_t>> page_threads;
+  std::unordered_map<page_id_t, uint32_t> page_rows;
+  std::vector<int32_t> last_seq(num_threads, -1);
+  int rows = 0;
+  uint32_t row_length = 0;
+  for (auto itr = table->Begin(&setup_txn); itr != table->End(); ++itr) {
+    auto thread = itr->GetValue(&schema, 0).GetAs<int32_t>();
+    auto seq = itr->GetValue(&schema, 1).GetAs<int32_t>();
+    page_threads[itr->GetRid().GetPageId()].insert(thread);
+    page_rows[itr->GetRid().GetPageId()]++;
+    row_length = itr->GetLength();
+    EXPECT_GT(seq, last_seq[thread]);
+    last_seq[thread] = seq;
+    rows++;
+  }
+  EXPECT_EQ(num_threads * rows_per_thread, rows);
+  for (const auto &[page_id, threads_on_page] : page_threads) {
+    EXPECT_EQ(1, threads_on_page.size());
+  }
+
+  // The fill factor leaves room on every page.
+  for (const auto &[page_id, rows_on_page] : page_rows) {
+    EXPECT_LE(rows_on_page * row_length, PAGE_SIZE * fill_factor / 100);
+  }
+
+  // Switching back to free-space-first reuses the space at the front of the chain.
+  table->SetInsertMode(InsertMode::FreeSpaceFirst);
+  std::vector<Value> values{ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(rows_per_thread),
+                            ValueFactory::GetVarcharValue("x")};
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(Tuple(values, &schema), &rid, &setup_txn));
+  EXPECT_EQ(table->GetFirstPageId(), rid.GetPageId());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
 }  // namespace bustub